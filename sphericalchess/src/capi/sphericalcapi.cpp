@@ -0,0 +1,318 @@
+#include "sphericalcapi.h"
+
+#include "../engine/bitboard.hpp"
+#include "../engine/evaluation.hpp"
+#include "../engine/notation.hpp"
+#include "../engine/search.hpp"
+#include "../engine/transpositiontable.hpp"
+#include "../engine/zobrist.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+
+using Engine::BitboardPosition;
+
+// the caller's positions are used in place, so the layouts must match exactly
+
+static_assert(sizeof(sc_position) == sizeof(BitboardPosition), "sc_position must match BitboardPosition.");
+static_assert(std::is_standard_layout<BitboardPosition>::value, "BitboardPosition must have a C layout.");
+static_assert(offsetof(sc_position, pieces)     == offsetof(BitboardPosition, pieces),    "sc_position must match BitboardPosition.");
+static_assert(offsetof(sc_position, unmoved)    == offsetof(BitboardPosition, unmoved),   "sc_position must match BitboardPosition.");
+static_assert(offsetof(sc_position, en_passant) == offsetof(BitboardPosition, enPassant), "sc_position must match BitboardPosition.");
+static_assert(offsetof(sc_position, turn)       == offsetof(BitboardPosition, turn),      "sc_position must match BitboardPosition.");
+static_assert(Engine::kMaxPositionTextSize <= SC_MAX_POSITION_TEXT_SIZE, "SC_MAX_POSITION_TEXT_SIZE is too small.");
+
+struct sc_search
+{
+    Engine::TranspositionTable table;
+    Engine::Search             search;
+
+    explicit sc_search(std::size_t megabytes) : table(megabytes), search(table)
+    {
+    }
+};
+
+namespace
+{
+    const BitboardPosition& Get(const sc_position* position)
+    {
+        return *reinterpret_cast<const BitboardPosition*>(position);
+    }
+
+    BitboardPosition& Get(sc_position* position)
+    {
+        return *reinterpret_cast<BitboardPosition*>(position);
+    }
+
+    //! @brief Writes the legal moves of @p position found in @p masks.
+    //! @returns Number of legal moves, only the first @p capacity are written.
+    std::size_t WriteMoves(const BitboardPosition& position, const u64 masks[Engine::kNumSquares], u16* moves, std::size_t capacity)
+    {
+        std::size_t count = 0;
+
+        for(int origin = 0; origin < Engine::kNumSquares; ++origin)
+        {
+            for(u64 bits = masks[origin]; bits != 0; bits &= bits - 1)
+            {
+                if(count < capacity)
+                {
+                    moves[count] = position.ToMove(origin, Engine::LowestBit(bits)).GetData();
+                }
+
+                ++count;
+            }
+        }
+
+        return count;
+    }
+}
+
+extern "C"
+{
+
+uint32_t sc_version(void)
+{
+    return SC_VERSION;
+}
+
+void sc_start_position(sc_position* position)
+{
+    if(position)
+    {
+        Get(position) = BitboardPosition();
+        Get(position).SetStart();
+    }
+}
+
+int sc_parse_position(const char* text, size_t size, sc_position* position)
+{
+    if(!text || !position)
+    {
+        return SC_ERROR_INVALID;
+    }
+
+    return Engine::ParsePosition(text, size, Get(position)) ? SC_OK : SC_ERROR_INVALID;
+}
+
+size_t sc_format_position(const sc_position* position, char* text)
+{
+    if(!position || !text)
+    {
+        return 0;
+    }
+
+    return Engine::FormatPosition(Get(position), text);
+}
+
+int sc_legal_moves(const sc_position* position, uint16_t* moves, size_t capacity)
+{
+    if(!position || (!moves && capacity > 0))
+    {
+        return SC_ERROR_INVALID;
+    }
+
+    u64 masks[Engine::kNumSquares];
+
+    Get(position).GenerateLegal(masks);
+
+    return int(WriteMoves(Get(position), masks, moves, capacity));
+}
+
+int sc_legal_moves_batch(const sc_position* positions, size_t count, uint16_t* moves, size_t stride, uint32_t* counts)
+{
+    if((!positions || !moves || !counts) && count > 0)
+    {
+        return SC_ERROR_INVALID;
+    }
+
+    int result = SC_OK;
+
+    u64 masks[Engine::kNumSquares];
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        Get(positions + i).GenerateLegal(masks);
+
+        counts[i] = u32(WriteMoves(Get(positions + i), masks, moves + i * stride, stride));
+
+        if(counts[i] > stride)
+        {
+            result = SC_ERROR_BUFFER_SIZE;
+        }
+    }
+
+    return result;
+}
+
+int sc_apply_moves(const sc_position* positions, const uint16_t* moves, size_t count, sc_position* output)
+{
+    if((!positions || !moves || !output) && count > 0)
+    {
+        return SC_ERROR_INVALID;
+    }
+
+    u64 masks[Engine::kNumSquares];
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        BitboardPosition position = Get(positions + i);
+
+        const int origin      = moves[i] & 63;
+        const int destination = (moves[i] >> 6) & 63;
+
+        position.GenerateLegal(masks);
+
+        if((masks[origin] & (u64(1) << destination)) == 0 || position.ToMove(origin, destination).GetData() != moves[i])
+        {
+            return SC_ERROR_INVALID;
+        }
+
+        position.Apply(origin, destination);
+
+        Get(output + i) = position;
+    }
+
+    return SC_OK;
+}
+
+int sc_states(const sc_position* positions, size_t count, uint8_t* states)
+{
+    if((!positions || !states) && count > 0)
+    {
+        return SC_ERROR_INVALID;
+    }
+
+    u64 masks[Engine::kNumSquares];
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        const BitboardPosition& position = Get(positions + i);
+
+        const bool check = position.IsInCheck(position.turn);
+        const bool moves = position.GenerateLegal(masks) > 0;
+
+        states[i] = u8(moves ? (check ? 1 : 0) : (check ? 2 : 3));
+    }
+
+    return SC_OK;
+}
+
+int sc_hash_batch(const sc_position* positions, size_t count, uint64_t* hashes)
+{
+    if((!positions || !hashes) && count > 0)
+    {
+        return SC_ERROR_INVALID;
+    }
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        hashes[i] = Engine::Zobrist::Hash(Get(positions + i));
+    }
+
+    return SC_OK;
+}
+
+int sc_evaluate_batch(const sc_position* positions, size_t count, int32_t* scores)
+{
+    if((!positions || !scores) && count > 0)
+    {
+        return SC_ERROR_INVALID;
+    }
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        scores[i] = s32(Engine::Evaluate(Get(positions + i)));
+    }
+
+    return SC_OK;
+}
+
+sc_search* sc_search_create(size_t megabytes)
+{
+    try
+    {
+        return new sc_search(std::max<std::size_t>(megabytes, 1));
+    }
+    catch(const std::exception&)
+    {
+        return nullptr;
+    }
+}
+
+void sc_search_destroy(sc_search* search)
+{
+    delete search;
+}
+
+int sc_search_run(sc_search* search, const sc_position* position, const sc_search_limits* limits, sc_search_result* result)
+{
+    if(!search || !position || !limits || !result)
+    {
+        return SC_ERROR_INVALID;
+    }
+
+    try
+    {
+        Engine::SearchLimits searchLimits;
+
+        searchLimits.depth        = limits->depth > 0 ? std::min(int(limits->depth), Engine::kMaxPly - 1) : Engine::kMaxPly - 1;
+        searchLimits.milliseconds = std::max(int(limits->milliseconds), 0);
+        searchLimits.nodes        = limits->nodes;
+        searchLimits.threads      = std::max(int(limits->threads), 1);
+
+        Board board;
+        Get(position).ToBoard(board);
+
+        const Engine::SearchInfo info = search->search.Run(board, searchLimits);
+
+        *result = sc_search_result();
+
+        result->depth        = info.depth;
+        result->nodes        = info.nodes;
+        result->milliseconds = u32(info.milliseconds);
+
+        if(info.lines.empty())
+        {
+            result->score = Get(position).IsInCheck(Get(position).turn) ? -Engine::kScoreMate : 0;
+        }
+        else
+        {
+            const Engine::SearchLine& line = info.lines.front();
+
+            result->score     = line.score;
+            result->pv_length = u32(std::min<std::size_t>(line.moves.size(), SC_MAX_PV));
+
+            for(u32 i = 0; i < result->pv_length; ++i)
+            {
+                result->pv[i] = line.moves[i].GetData();
+            }
+        }
+
+        return SC_OK;
+    }
+    catch(const std::exception&)
+    {
+        return SC_ERROR_INTERNAL;
+    }
+}
+
+void sc_search_stop(sc_search* search)
+{
+    if(search)
+    {
+        search->search.Stop();
+    }
+}
+
+void sc_search_clear(sc_search* search)
+{
+    if(search)
+    {
+        search->table.Clear();
+    }
+}
+
+}
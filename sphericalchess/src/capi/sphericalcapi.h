@@ -0,0 +1,132 @@
+#pragma once
+
+//! @file
+//! C interface to the rules and engine, built as a shared library for other languages and processes.
+//!
+//! Positions and moves are plain buffers the caller owns, read and written in place by every call, so
+//! nothing is allocated or copied per call besides the searches' own state. Functions taking an array of
+//! positions work through all of them in one call, which is how the cost of crossing into the library is
+//! spread out. Every function is safe to call from any thread, except that one sc_search runs one search
+//! at a time. Structures only ever grow at their reserved members, existing members keep their offsets.
+//! Positions aren't checked, they must come from sc_start_position(), sc_parse_position() or sc_apply_moves().
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+    #if defined(SC_BUILDING_LIBRARY)
+        #define SC_API __declspec(dllexport)
+    #else
+        #define SC_API __declspec(dllimport)
+    #endif
+#else
+    #define SC_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SC_VERSION 1
+
+#define SC_MAX_MOVES              1024  //!< More than the legal moves of any position, 16 pieces with 63 destinations each.
+#define SC_MAX_POSITION_TEXT_SIZE 96    //!< Including the null terminator.
+#define SC_MAX_PV                 64
+
+//! @brief Results of the functions returning int, zero or positive on success.
+enum
+{
+    SC_OK                  =  0,
+    SC_ERROR_INVALID       = -1,    //!< An argument is null, out of range, or a move isn't legal.
+    SC_ERROR_BUFFER_SIZE   = -2,    //!< A buffer was too small, it holds as much as fit.
+    SC_ERROR_INTERNAL      = -3,    //!< The library failed, such as running out of memory.
+};
+
+//! @brief A position, with the same layout as the engine's own so it is used in place.
+//!
+//! Moves are 16 bits, the origin square in bits 0-5, the destination in bits 6-11, bit 12 for an upgrade to
+//! a queen, bit 13 for a castle and bit 14 for a castle with the rook on the last column. Squares are
+//! y * 8 + x, with white's back row at y = 0.
+typedef struct sc_position
+{
+    uint64_t pieces[2][6];  //!< Bit per square, by team (white, black) then type (pawn, bishop, knight, rook, queen, king).
+    uint64_t unmoved;       //!< Kings and rooks that have never moved and can still castle.
+    int8_t   en_passant;    //!< Square of a pawn that just moved two rows and can be captured en passant, or -1.
+    uint8_t  turn;          //!< Team to move, 0 for white.
+    uint8_t  reserved[6];
+} sc_position;
+
+typedef struct sc_search_limits
+{
+    int32_t  depth;         //!< Zero for no limit.
+    int32_t  milliseconds;  //!< Zero for no limit.
+    uint64_t nodes;         //!< Zero for no limit.
+    int32_t  threads;       //!< Zero for one.
+    int32_t  reserved;
+} sc_search_limits;
+
+typedef struct sc_search_result
+{
+    int32_t  score;         //!< Centipawns for the team to move, mates are beyond +-30000.
+    int32_t  depth;         //!< Last completed depth.
+    uint64_t nodes;
+    uint32_t milliseconds;
+    uint32_t pv_length;     //!< Zero when there is no legal move.
+    uint16_t pv[SC_MAX_PV]; //!< Best line, the first move is the best move.
+} sc_search_result;
+
+typedef struct sc_search sc_search;
+
+//! @returns SC_VERSION of the library, which can differ from the header's when the library is replaced.
+SC_API uint32_t sc_version(void);
+
+SC_API void sc_start_position(sc_position* position);
+
+//! @brief Reads a position written by sc_format_position(), @p text doesn't need a null terminator.
+//! @returns SC_OK, or SC_ERROR_INVALID when the text isn't a valid position.
+SC_API int sc_parse_position(const char* text, size_t size, sc_position* position);
+
+//! @param [out] text At least SC_MAX_POSITION_TEXT_SIZE bytes, null terminated.
+//! @returns Length of the text.
+SC_API size_t sc_format_position(const sc_position* position, char* text);
+
+//! @brief Finds the legal moves of one position.
+//! @returns Number of legal moves, of which the first @p capacity are written, or a negative error.
+SC_API int sc_legal_moves(const sc_position* position, uint16_t* moves, size_t capacity);
+
+//! @brief Finds the legal moves of @p count positions, the moves of position i start at moves + i * stride.
+//! @param [out] counts Number of legal moves of each position, even when more than @p stride.
+//! @returns SC_OK, or SC_ERROR_BUFFER_SIZE when a position had more than @p stride moves.
+SC_API int sc_legal_moves_batch(const sc_position* positions, size_t count, uint16_t* moves, size_t stride, uint32_t* counts);
+
+//! @brief Makes move i in position i for @p count positions, @p output can be the same as @p positions.
+//! @returns SC_OK, or SC_ERROR_INVALID when a move isn't legal, the positions up to it are written.
+SC_API int sc_apply_moves(const sc_position* positions, const uint16_t* moves, size_t count, sc_position* output);
+
+//! @brief Checks @p count positions.
+//! @param [out] states 0 for playing, 1 for check, 2 for checkmate and 3 for stalemate, for the team to move.
+SC_API int sc_states(const sc_position* positions, size_t count, uint8_t* states);
+
+//! @brief Zobrist hashes of @p count positions, the same keys the engine's tables use.
+SC_API int sc_hash_batch(const sc_position* positions, size_t count, uint64_t* hashes);
+
+//! @brief Static evaluations of @p count positions in centipawns, for the team to move.
+SC_API int sc_evaluate_batch(const sc_position* positions, size_t count, int32_t* scores);
+
+//! @brief Creates a search with a transposition table of @p megabytes, kept from search to search.
+//! @returns Null on failure.
+SC_API sc_search* sc_search_create(size_t megabytes);
+SC_API void       sc_search_destroy(sc_search* search);
+
+//! @brief Searches @p position until one of the @p limits is reached or sc_search_stop() is called.
+SC_API int sc_search_run(sc_search* search, const sc_position* position, const sc_search_limits* limits, sc_search_result* result);
+
+//! @brief Stops the search running on another thread, can be called at any time.
+SC_API void sc_search_stop(sc_search* search);
+
+//! @brief Forgets every position searched so far.
+SC_API void sc_search_clear(sc_search* search);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,223 @@
+#include "batchenvironment.hpp"
+
+#include <algorithm>
+
+namespace Engine
+{
+
+BatchEnvironment::BatchEnvironment(int size, int threads, int maxPlies)
+    : size(size)
+    , numThreads(std::max(std::min(threads, size), 1))
+    , maxPlies(maxPlies)
+{
+    for(auto& team : pieces)
+    {
+        for(auto& type : team)
+        {
+            type.resize(size);
+        }
+    }
+
+    unmoved.resize(size);
+    enPassant.resize(size);
+    turn.resize(size);
+    plies.resize(size);
+
+    start.SetStart();
+
+    ResetAll();
+
+    for(int i = 1; i < numThreads; ++i)
+    {
+        workers.emplace_back(&BatchEnvironment::Work, this, i);
+    }
+}
+
+BatchEnvironment::~BatchEnvironment()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+
+    wake.notify_all();
+
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void BatchEnvironment::Work(int index)
+{
+    u64 called = 0;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true)
+    {
+        wake.wait(lock, [&] { return calls != called || stopped; });
+
+        if(stopped)
+        {
+            return;
+        }
+
+        called = calls;
+
+        lock.unlock();
+
+        job(jobFunction, size * index / numThreads, size * (index + 1) / numThreads);
+
+        lock.lock();
+
+        if(--working == 0)
+        {
+            done.notify_one();
+        }
+    }
+}
+
+template<typename F>
+void BatchEnvironment::ParallelFor(const F& function) const
+{
+    if(workers.empty())
+    {
+        function(0, size);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        job         = [](const void* context, int begin, int end) { (*static_cast<const F*>(context))(begin, end); };
+        jobFunction = &function;
+        working     = int(workers.size());
+        ++calls;
+    }
+
+    wake.notify_all();
+
+    function(0, size / numThreads);
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    done.wait(lock, [&] { return working == 0; });
+}
+
+void BatchEnvironment::Reset(int index)
+{
+    SetPosition(index, start);
+    plies[index] = 0;
+}
+
+void BatchEnvironment::ResetAll()
+{
+    for(int i = 0; i < size; ++i)
+    {
+        Reset(i);
+    }
+}
+
+void BatchEnvironment::Load(int index, const Board& board)
+{
+    BitboardPosition position;
+    position.FromBoard(board);
+
+    SetPosition(index, position);
+    plies[index] = u16(board.GetWhiteActions().size() + board.GetBlackActions().size());
+}
+
+BitboardPosition BatchEnvironment::GetPosition(int index) const
+{
+    BitboardPosition position;
+
+    for(int team = 0; team < 2; ++team)
+    {
+        for(int type = 0; type < kNumTypes; ++type)
+        {
+            position.pieces[team][type] = pieces[team][type][index];
+        }
+    }
+
+    position.unmoved   = unmoved[index];
+    position.enPassant = enPassant[index];
+    position.turn      = turn[index];
+
+    return position;
+}
+
+void BatchEnvironment::SetPosition(int index, const BitboardPosition& position)
+{
+    for(int team = 0; team < 2; ++team)
+    {
+        for(int type = 0; type < kNumTypes; ++type)
+        {
+            pieces[team][type][index] = position.pieces[team][type];
+        }
+    }
+
+    unmoved[index]   = position.unmoved;
+    enPassant[index] = position.enPassant;
+    turn[index]      = position.turn;
+}
+
+void BatchEnvironment::GenerateMasks(u64* masks, u16* counts, Board::Result* results) const
+{
+    ParallelFor([&](int begin, int end)
+    {
+        for(int i = begin; i < end; ++i)
+        {
+            u64* boardMasks = masks + std::size_t(i) * kNumSquares;
+
+            if(plies[i] >= maxPlies)
+            {
+                std::fill(boardMasks, boardMasks + kNumSquares, u64(0));
+
+                counts[i]  = 0;
+                results[i] = Board::Result::Draw;
+                continue;
+            }
+
+            const BitboardPosition position = GetPosition(i);
+
+            counts[i]  = u16(position.GenerateLegal(boardMasks));
+            results[i] = Board::Result::Undecided;
+
+            if(counts[i] == 0)
+            {
+                if(position.IsInCheck(position.turn))
+                {
+                    results[i] = position.turn == u8(Piece::Team::White) ? Board::Result::BlackWins : Board::Result::WhiteWins;
+                }
+                else
+                {
+                    results[i] = Board::Result::Draw;
+                }
+            }
+        }
+    });
+}
+
+void BatchEnvironment::Step(const u16* actions)
+{
+    ParallelFor([&](int begin, int end)
+    {
+        for(int i = begin; i < end; ++i)
+        {
+            if(actions[i] == kNoAction)
+            {
+                continue;
+            }
+
+            BitboardPosition position = GetPosition(i);
+
+            position.Apply(actions[i] / kNumSquares, actions[i] % kNumSquares);
+
+            SetPosition(i, position);
+            ++plies[i];
+        }
+    });
+}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "bitboard.hpp"
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+
+//! @brief Many games stepped together, for workloads that play thousands of games at once.
+//!
+//! Boards are stored as structure of arrays, one array per BitboardPosition field holding that field
+//! for every board, and are only gathered into a BitboardPosition while one is being worked on.
+//! Moves are action indices, origin * kNumSquares + destination, matching the bits of the legal move masks.
+//! Nothing is allocated after construction, resetting a board copies the start position, and the threads
+//! are started once and wait between calls.
+//! Repetitions aren't tracked, games that reach the ply limit are a draw instead.
+class BatchEnvironment
+{
+public:
+
+    static constexpr int kNumActions = kNumSquares * kNumSquares;
+    static constexpr u16 kNoAction   = 0xFFFF;   //!< Leaves a board as it is in Step().
+
+    //! @param [in] threads Boards are split evenly over this many threads in each call.
+    BatchEnvironment(int size, int threads = 1, int maxPlies = 400);
+    ~BatchEnvironment();
+
+    BatchEnvironment(const BatchEnvironment&) = delete;
+
+    int GetSize() const { return size; }
+
+    void Reset(int index);
+    void ResetAll();
+
+    void Load(int index, const Board& board);
+
+    BitboardPosition GetPosition(int index) const;
+    void SetPosition(int index, const BitboardPosition& position);
+
+    int GetPly(int index) const { return plies[index]; }
+
+    //! @brief Finds the legal moves of every board.
+    //! @param [out] masks   kNumSquares per board, the destinations of each origin square.
+    //! @param [out] counts  Number of legal moves per board, zero once its game has ended.
+    //! @param [out] results Board::Result per board, undecided unless the game has ended.
+    void GenerateMasks(u64* masks, u16* counts, Board::Result* results) const;
+
+    //! @brief Makes one move on every board, which must be legal or kNoAction.
+    void Step(const u16* actions);
+
+    static u16 MakeAction(int origin, int destination) { return u16(origin * kNumSquares + destination); }
+
+private:
+
+    int size;
+    int numThreads;
+    int maxPlies;
+
+    std::vector<u64> pieces[2][kNumTypes];
+    std::vector<u64> unmoved;
+    std::vector<s8>  enPassant;
+    std::vector<u8>  turn;
+    std::vector<u16> plies;
+
+    BitboardPosition start;
+
+    // the threads besides the caller's, which a const call still wakes to work on its boards
+
+    mutable std::mutex              mutex;
+    mutable std::condition_variable wake;   //!< Of the workers, when there is a call to work on or to stop.
+    mutable std::condition_variable done;   //!< Of the caller, when the workers have finished their boards.
+
+    mutable void (*job)(const void*, int, int) = nullptr;  //!< Calls the function of the current call, jobFunction.
+    mutable const void* jobFunction            = nullptr;
+
+    mutable u64 calls   = 0;    //!< Calls so far, each worker works on every one once. Guarded by mutex.
+    mutable int working = 0;    //!< Workers yet to finish the current call.
+    bool        stopped = false;
+
+    std::vector<std::thread> workers;
+
+    //! @brief Calls @p function(begin, end) with the boards split evenly over the threads.
+    template<typename F>
+    void ParallelFor(const F& function) const;
+
+    //! @brief Works on the boards of thread @p index for every call until stopped.
+    void Work(int index);
+};
+
+}
@@ -0,0 +1,638 @@
+#include "bitboard.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <utility>
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr int kMaxRay = 32;
+
+    constexpr int kPawn   = int(Piece::Type::Pawn);
+    constexpr int kBishop = int(Piece::Type::Bishop);
+    constexpr int kKnight = int(Piece::Type::Knight);
+    constexpr int kRook   = int(Piece::Type::Rook);
+    constexpr int kQueen  = int(Piece::Type::Queen);
+    constexpr int kKing   = int(Piece::Type::King);
+
+    constexpr int kKingColumn = Board::kDimension / 2;
+
+    //! Slider directions, in pairs of opposite directions that are searched together.
+    enum Direction
+    {
+        Direction_right,
+        Direction_left,
+        Direction_up,
+        Direction_down,
+        Direction_upRight,
+        Direction_downLeft,
+        Direction_upLeft,
+        Direction_downRight,
+
+        Direction_count
+    };
+
+    u64 Bit(int square) { return u64(1) << square; }
+
+    int Column(int square) { return square % Board::kDimension; }
+    int Row   (int square) { return square / Board::kDimension; }
+
+    int StartingRow(int team) { return team == 0 ? 1 : Board::kDimension - 2; }
+    int UpgradeRow (int team) { return team == 0 ? Board::kDimension - 1 : 0; }
+    int EnPassantRow(int team) { return team == 0 ? Board::kDimension / 2 : Board::kDimension / 2 - 1; }
+    int Forward    (int team) { return team == 0 ? 1 : -1; }
+
+    // The same wrapping as Piece uses, a position past a pole comes back down the opposite column.
+
+    Vec2i WrapPosition(Vec2i position)
+    {
+        constexpr int kHalf  = Board::kDimension / 2;
+        constexpr int kTwice = Board::kDimension * 2;
+
+        if(position.y < 0)
+        {
+            position.y = -position.y - 1;
+            position.x += kHalf;
+        }
+
+        position.y %= kTwice;
+
+        if(position.y >= Board::kDimension)
+        {
+            position.y = (kTwice - 1) - position.y;
+            position.x += kHalf;
+        }
+
+        position.x %= Board::kDimension;
+
+        if(position.x < 0)
+        {
+            position.x += Board::kDimension;
+        }
+
+        return position;
+    }
+
+    Vec2i NextStraight(Vec2i previous, Vec2i& delta)
+    {
+        Vec2i next = previous + delta;
+
+        if(!Util::InRange(next.y, 0, Board::kDimension))
+        {
+            delta.y = -delta.y;
+        }
+
+        return WrapPosition(next);
+    }
+
+    Vec2i NextDiagonal(Vec2i previous, Vec2i& delta)
+    {
+        Vec2i next = previous + delta;
+
+        if(!Util::InRange(next.y, 0, Board::kDimension))
+        {
+            next  = previous + Vec2i(0, delta.y);
+            delta = -delta;
+        }
+
+        return WrapPosition(next);
+    }
+
+    struct Tables
+    {
+        u8  ray[kNumSquares][Direction_count][kMaxRay];    //!< Squares in order until the ray is back at its start.
+        u8  rayLength[kNumSquares][Direction_count];
+
+        u64 rookReach[kNumSquares];         //!< Every square on the rook rays of a square, with no pieces in the way.
+        u64 bishopReach[kNumSquares];
+        u64 rookReachedBy[kNumSquares];     //!< Squares whose rook rays reach a square.
+        u64 bishopReachedBy[kNumSquares];
+
+        u64 knight[kNumSquares];
+        u64 king[kNumSquares];
+        u64 pawnCapture[2][kNumSquares];    //!< Per team of the pawn.
+
+        u64 knightAttackers[kNumSquares];
+        u64 kingAttackers[kNumSquares];
+        u64 pawnAttackers[2][kNumSquares];  //!< Squares of the team's pawns that can capture on a square.
+
+        u64 column[Board::kDimension];
+
+        Tables()
+        {
+            const Vec2i directions[Direction_count] =
+            {
+                {  1,  0 }, { -1,  0 }, {  0,  1 }, {  0, -1 },
+                {  1,  1 }, { -1, -1 }, { -1,  1 }, {  1, -1 },
+            };
+
+            const Vec2i knightDeltas[] =
+            {
+                {  1,  2 }, {  2,  1 }, {  1, -2 }, {  2, -1 },
+                { -1, -2 }, { -2, -1 }, { -1,  2 }, { -2,  1 },
+            };
+
+            const Vec2i kingDeltas[] =
+            {
+                { -1,  1 }, {  0,  1 }, {  1,  1 },
+                { -1,  0 },             {  1,  0 },
+                { -1, -1 }, {  0, -1 }, {  1, -1 },
+            };
+
+            for(int square = 0; square < kNumSquares; ++square)
+            {
+                const Vec2i position = SquarePosition(square);
+
+                rookReach[square]   = 0;
+                bishopReach[square] = 0;
+
+                for(int direction = 0; direction < Direction_count; ++direction)
+                {
+                    const bool diagonal = direction >= Direction_upRight;
+
+                    Vec2i delta = directions[direction];
+                    Vec2i next  = position;
+                    int length  = 0;
+
+                    while((next = diagonal ? NextDiagonal(next, delta) : NextStraight(next, delta)) != position)
+                    {
+                        assert(length < kMaxRay);
+
+                        ray[square][direction][length++] = u8(SquareIndex(next));
+                        (diagonal ? bishopReach : rookReach)[square] |= Bit(SquareIndex(next));
+                    }
+
+                    rayLength[square][direction] = u8(length);
+                }
+
+                knight[square] = 0;
+                king[square]   = 0;
+
+                for(auto& delta : knightDeltas) knight[square] |= Bit(SquareIndex(WrapPosition(position + delta)));
+                for(auto& delta : kingDeltas)   king[square]   |= Bit(SquareIndex(WrapPosition(position + delta)));
+
+                for(int team = 0; team < 2; ++team)
+                {
+                    pawnCapture[team][square] = 0;
+
+                    if(position.y != UpgradeRow(team))
+                    {
+                        for(int dx : { 1, -1 })
+                        {
+                            pawnCapture[team][square] |= Bit(SquareIndex(WrapPosition(position + Vec2i(dx, Forward(team)))));
+                        }
+                    }
+                }
+            }
+
+            // invert the tables, a piece attacks a square if the square is in its table
+
+            for(int square = 0; square < kNumSquares; ++square)
+            {
+                knightAttackers[square] = kingAttackers[square] = rookReachedBy[square] = bishopReachedBy[square] = 0;
+                pawnAttackers[0][square] = pawnAttackers[1][square] = 0;
+
+                for(int from = 0; from < kNumSquares; ++from)
+                {
+                    if(knight[from]      & Bit(square)) knightAttackers[square]  |= Bit(from);
+                    if(king[from]        & Bit(square)) kingAttackers[square]    |= Bit(from);
+                    if(rookReach[from]   & Bit(square)) rookReachedBy[square]    |= Bit(from);
+                    if(bishopReach[from] & Bit(square)) bishopReachedBy[square]  |= Bit(from);
+
+                    for(int team = 0; team < 2; ++team)
+                    {
+                        if(pawnCapture[team][from] & Bit(square)) pawnAttackers[team][square] |= Bit(from);
+                    }
+                }
+            }
+
+            for(int x = 0; x < Board::kDimension; ++x)
+            {
+                column[x] = 0;
+
+                for(int y = 0; y < Board::kDimension; ++y)
+                {
+                    column[x] |= Bit(SquareIndex(Vec2i(x, y)));
+                }
+            }
+        }
+    };
+
+    const Tables& GetTables()
+    {
+        static const Tables tables;
+        return tables;
+    }
+
+    //! @brief Squares a slider reaches along a pair of opposite directions.
+    //!
+    //! Like Piece, the first direction is followed until a piece or back to the start,
+    //! and only when blocked is the opposite direction followed until a piece.
+    u64 PairTargets(const Tables& tables, int square, int direction, u64 occupancy)
+    {
+        u64 targets = 0;
+
+        const u8* ray    = tables.ray[square][direction];
+        const int length = tables.rayLength[square][direction];
+
+        for(int i = 0; i < length; ++i)
+        {
+            targets |= Bit(ray[i]);
+
+            if(occupancy & Bit(ray[i]))
+            {
+                const u8* back       = tables.ray[square][direction + 1];
+                const int backLength = tables.rayLength[square][direction + 1];
+
+                for(int j = 0; j < backLength; ++j)
+                {
+                    targets |= Bit(back[j]);
+
+                    if(occupancy & Bit(back[j]))
+                    {
+                        break;
+                    }
+                }
+
+                break;
+            }
+        }
+
+        return targets;
+    }
+
+    u64 RookTargets(const Tables& tables, int square, u64 occupancy)
+    {
+        return PairTargets(tables, square, Direction_right, occupancy) | PairTargets(tables, square, Direction_up, occupancy);
+    }
+
+    u64 BishopTargets(const Tables& tables, int square, u64 occupancy)
+    {
+        return PairTargets(tables, square, Direction_upRight, occupancy) | PairTargets(tables, square, Direction_upLeft, occupancy);
+    }
+
+    //! @brief Whether every square between the king and rook columns is empty, going in @p direction around the row.
+    bool CastlePathEmpty(int row, int rookColumn, int direction, u64 occupancy)
+    {
+        for(int x = (kKingColumn + direction + Board::kDimension) % Board::kDimension; x != rookColumn; x = (x + direction + Board::kDimension) % Board::kDimension)
+        {
+            if(occupancy & Bit(SquareIndex(Vec2i(x, row))))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //! @returns Square of the rook that castles with the king on @p row moving in @p direction, or -1.
+    int CastleRook(const BitboardPosition& position, int team, int row, int direction)
+    {
+        const u64 occupancy = position.GetOccupancy();
+
+        for(int rookColumn : { 0, Board::kDimension - 1 })
+        {
+            const int rook = SquareIndex(Vec2i(rookColumn, row));
+
+            if((position.unmoved & position.pieces[team][kRook] & Bit(rook)) && CastlePathEmpty(row, rookColumn, direction, occupancy))
+            {
+                return rook;
+            }
+        }
+
+        return -1;
+    }
+
+    bool IsCastle(const BitboardPosition& position, int team, int origin, int destination)
+    {
+        return (position.pieces[team][kKing] & position.unmoved & Bit(origin)) && Row(origin) == Row(destination) &&
+               std::abs(Column(destination) - Column(origin)) == 2;
+    }
+}
+
+void BitboardPosition::FromBoard(const Board& board)
+{
+    *this = BitboardPosition();
+
+    for(int square = 0; square < kNumSquares; ++square)
+    {
+        if(auto& piece = board.PieceAt(SquarePosition(square)))
+        {
+            pieces[int(piece.GetTeam())][int(piece.GetType())] |= Bit(square);
+
+            if(!piece.HasMoved() && (piece.GetType() == Piece::Type::King || piece.GetType() == Piece::Type::Rook))
+            {
+                unmoved |= Bit(square);
+            }
+        }
+    }
+
+    turn = u8(board.GetCurrentTeamTurn());
+
+    if(board.HasActions())
+    {
+        auto& last = board.GetLastAction();
+
+        if(last.piece.GetType() == Piece::Type::Pawn && !last.piece.HasMoved() && std::abs(last.destination.y - last.origin.y) == 2)
+        {
+            enPassant = s8(SquareIndex(last.destination));
+        }
+    }
+}
+
+void BitboardPosition::ToBoard(Board& board) const
+{
+    const int mover = turn ^ 1;
+
+    board.Clear(Piece::Team(enPassant >= 0 ? mover : turn));
+
+    for(int team = 0; team < 2; ++team)
+    {
+        for(int type = 0; type < kNumTypes; ++type)
+        {
+            for(u64 bits = pieces[team][type]; bits; bits &= bits - 1)
+            {
+                const int  square = LowestBit(bits);
+                const bool moved  = type != kPawn && !(unmoved & Bit(square));
+
+                board.PieceAt(SquarePosition(square)) = Piece(Piece::Team(team), Piece::Type(type), moved);
+            }
+        }
+    }
+
+    // like Transform(), the pawn is put back and pushed again
+
+    if(enPassant >= 0)
+    {
+        const Piece pawn(Piece::Team(mover), Piece::Type::Pawn);
+        const Vec2i origin      = SquarePosition(enPassant - 2 * Forward(mover) * Board::kDimension);
+        const Vec2i destination = SquarePosition(enPassant);
+
+        board.PieceAt(destination) = Piece();
+        board.PieceAt(origin)      = pawn;
+
+        board.DoAction(Piece::Action::MakeMove(pawn, std::make_pair(origin, destination)));
+    }
+}
+
+void BitboardPosition::SetStart()
+{
+    static const BitboardPosition start = []()
+    {
+        BitboardPosition position;
+        position.FromBoard(Board());
+        return position;
+    }();
+
+    *this = start;
+}
+
+u64 BitboardPosition::GetOccupancy(int team) const
+{
+    const u64* bitboards = pieces[team];
+
+    return bitboards[0] | bitboards[1] | bitboards[2] | bitboards[3] | bitboards[4] | bitboards[5];
+}
+
+int BitboardPosition::TypeAt(int team, int square) const
+{
+    for(int type = 0; type < kNumTypes; ++type)
+    {
+        if(pieces[team][type] & Bit(square))
+        {
+            return type;
+        }
+    }
+
+    return -1;
+}
+
+bool BitboardPosition::IsAttacked(int square, int team) const
+{
+    const Tables& tables = GetTables();
+    const u64* bitboards = pieces[team];
+
+    if((tables.knightAttackers[square] & bitboards[kKnight]) ||
+       (tables.kingAttackers[square]   & bitboards[kKing])   ||
+       (tables.pawnAttackers[team][square] & bitboards[kPawn]))
+    {
+        return true;
+    }
+
+    // sliders whose rays pass the square on an empty board, then checked with the pieces in the way
+
+    const u64 occupancy = GetOccupancy();
+
+    for(u64 rooks = tables.rookReachedBy[square] & (bitboards[kRook] | bitboards[kQueen]); rooks; rooks &= rooks - 1)
+    {
+        if(RookTargets(tables, LowestBit(rooks), occupancy) & Bit(square))
+        {
+            return true;
+        }
+    }
+
+    for(u64 bishops = tables.bishopReachedBy[square] & (bitboards[kBishop] | bitboards[kQueen]); bishops; bishops &= bishops - 1)
+    {
+        if(BishopTargets(tables, LowestBit(bishops), occupancy) & Bit(square))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool BitboardPosition::IsInCheck(int team) const
+{
+    const u64 king = pieces[team][kKing];
+
+    return king && IsAttacked(LowestBit(king), team ^ 1);
+}
+
+int BitboardPosition::GenerateLegal(u64 masks[kNumSquares]) const
+{
+    const Tables& tables = GetTables();
+
+    const u64 own       = GetOccupancy(turn);
+    const u64 enemy     = GetOccupancy(turn ^ 1);
+    const u64 occupancy = own | enemy;
+
+    int count = 0;
+
+    for(int square = 0; square < kNumSquares; ++square)
+    {
+        masks[square] = 0;
+    }
+
+    for(int type = 0; type < kNumTypes; ++type)
+    {
+        for(u64 bits = pieces[turn][type]; bits; bits &= bits - 1)
+        {
+            const int origin = LowestBit(bits);
+
+            u64 targets = 0;
+
+            switch(type)
+            {
+            case kPawn:
+            {
+                const int ahead = origin + Forward(turn) * Board::kDimension;
+
+                if(!(occupancy & Bit(ahead)))
+                {
+                    targets |= Bit(ahead);
+
+                    const int twoAhead = ahead + Forward(turn) * Board::kDimension;
+
+                    if(Row(origin) == StartingRow(turn) && !(occupancy & Bit(twoAhead)))
+                    {
+                        targets |= Bit(twoAhead);
+                    }
+                }
+
+                targets |= tables.pawnCapture[turn][origin] & enemy;
+
+                if(enPassant >= 0 && Row(origin) == EnPassantRow(turn))
+                {
+                    targets |= tables.pawnCapture[turn][origin] & tables.column[Column(enPassant)];
+                }
+
+                break;
+            }
+            case kKnight: targets = tables.knight[origin] & ~own; break;
+            case kBishop: targets = BishopTargets(tables, origin, occupancy) & ~own; break;
+            case kRook:   targets = RookTargets(tables, origin, occupancy) & ~own; break;
+            case kQueen:  targets = (RookTargets(tables, origin, occupancy) | BishopTargets(tables, origin, occupancy)) & ~own; break;
+            case kKing:
+            {
+                targets = tables.king[origin] & ~own;
+
+                if((unmoved & Bit(origin)) && Column(origin) == kKingColumn)
+                {
+                    for(int direction : { 1, -1 })
+                    {
+                        if(CastleRook(*this, turn, Row(origin), direction) >= 0)
+                        {
+                            targets |= Bit(origin + 2 * direction);
+                        }
+                    }
+                }
+
+                break;
+            }
+            }
+
+            // keep the moves that don't leave the king in check
+
+            for(; targets; targets &= targets - 1)
+            {
+                const int destination = LowestBit(targets);
+
+                BitboardPosition next = *this;
+                next.Apply(origin, destination);
+
+                if(!next.IsInCheck(turn))
+                {
+                    masks[origin] |= Bit(destination);
+                    ++count;
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+void BitboardPosition::Apply(int origin, int destination)
+{
+    const int team  = turn;
+    const int enemy = team ^ 1;
+    const int type  = TypeAt(team, origin);
+
+    assert(type >= 0);
+
+    const int captured = TypeAt(enemy, destination);
+
+    if(captured >= 0)
+    {
+        pieces[enemy][captured] &= ~Bit(destination);
+    }
+    else if(type == kPawn && Column(origin) != Column(destination) && enPassant >= 0)
+    {
+        pieces[enemy][kPawn] &= ~Bit(enPassant);
+    }
+
+    if(type == kKing && IsCastle(*this, team, origin, destination))
+    {
+        const int direction = Column(destination) > Column(origin) ? 1 : -1;
+        const int rook      = CastleRook(*this, team, Row(origin), direction);
+
+        assert(rook >= 0);
+
+        pieces[team][kRook] &= ~Bit(rook);
+        pieces[team][kRook] |= Bit(origin + direction);
+
+        unmoved &= ~Bit(rook);
+    }
+
+    pieces[team][type] &= ~Bit(origin);
+
+    if(type == kPawn && Row(destination) == UpgradeRow(team))
+    {
+        pieces[team][kQueen] |= Bit(destination);
+    }
+    else
+    {
+        pieces[team][type] |= Bit(destination);
+    }
+
+    unmoved &= ~(Bit(origin) | Bit(destination));
+
+    enPassant = (type == kPawn && std::abs(Row(destination) - Row(origin)) == 2) ? s8(destination) : s8(-1);
+    turn      = u8(enemy);
+}
+
+Move BitboardPosition::ToMove(int origin, int destination) const
+{
+    u16 data = u16(origin | (destination << 6));
+
+    const int type = TypeAt(turn, origin);
+
+    if(type == kPawn && Row(destination) == UpgradeRow(turn))
+    {
+        data |= Move::Flag_upgrade;
+    }
+
+    if(type == kKing && IsCastle(*this, turn, origin, destination))
+    {
+        data |= Move::Flag_castle;
+
+        if(Column(CastleRook(*this, turn, Row(origin), Column(destination) > Column(origin) ? 1 : -1)) == Board::kDimension - 1)
+        {
+            data |= Move::Flag_rookHigh;
+        }
+    }
+
+    return Move(data);
+}
+
+bool BitboardPosition::operator == (const BitboardPosition& position) const
+{
+    for(int team = 0; team < 2; ++team)
+    {
+        for(int type = 0; type < kNumTypes; ++type)
+        {
+            if(pieces[team][type] != position.pieces[team][type])
+            {
+                return false;
+            }
+        }
+    }
+
+    return unmoved == position.unmoved && enPassant == position.enPassant && turn == position.turn;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "move.hpp"
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+namespace Engine
+{
+
+constexpr int kNumSquares = Board::kDimension * Board::kDimension;
+constexpr int kNumTypes   = 6;
+
+//! @brief Index of the lowest set bit, @p bits must not be zero.
+inline int LowestBit(u64 bits)
+{
+    // de Bruijn multiplication of the isolated bit, portable unlike the compiler intrinsics
+
+    static const int kIndex[64] =
+    {
+         0,  1, 48,  2, 57, 49, 28,  3,
+        61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22,
+        45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16,
+        54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10,
+        25, 14, 19,  9, 13,  8,  7,  6,
+    };
+
+    return kIndex[((bits & (0 - bits)) * 0x03F79D71B4CB0A89ull) >> 58];
+}
+
+//! @brief Position stored as a bitboard per team and Piece::Type, with a bit per square index.
+//!
+//! Follows the same rules as Piece and GenerateLegalActions() but with precomputed tables for the sphere's
+//! wrapping, so generating moves and checking legality never allocates. Moves are a pair of origin and
+//! destination squares, as there is only ever one legal move for each pair.
+struct BitboardPosition
+{
+    u64 pieces[2][kNumTypes] = {};  //!< Indexed by Piece::Team then Piece::Type.
+    u64 unmoved   = 0;              //!< Kings and rooks that have never moved and can still castle.
+    s8  enPassant = -1;             //!< Square of a pawn that just moved two rows and can be captured en passant, or -1.
+    u8  turn      = 0;              //!< Piece::Team to move.
+
+    void FromBoard(const Board& board);
+    void SetStart();
+
+    //! @brief Sets @p board to this position, a pawn that can be captured en passant is made its only action.
+    void ToBoard(Board& board) const;
+
+    u64 GetOccupancy(int team) const;
+    u64 GetOccupancy() const { return GetOccupancy(0) | GetOccupancy(1); }
+
+    //! @returns Piece::Type on @p square for @p team, or -1 if there is none.
+    int TypeAt(int team, int square) const;
+
+    //! @brief Whether a piece of @p team could capture a piece on @p square.
+    bool IsAttacked(int square, int team) const;
+    bool IsInCheck(int team) const;
+
+    //! @brief Finds every legal move of the team to move.
+    //! @param [out] masks Destinations per origin square.
+    //! @returns Number of legal moves.
+    int GenerateLegal(u64 masks[kNumSquares]) const;
+
+    //! @brief Makes the move from @p origin to @p destination, which must be pseudo legal.
+    void Apply(int origin, int destination);
+
+    Move ToMove(int origin, int destination) const;
+
+    bool operator == (const BitboardPosition& position) const;
+    bool operator != (const BitboardPosition& position) const { return !(*this == position); }
+};
+
+}
@@ -0,0 +1,160 @@
+#include "datagenerator.hpp"
+
+#include "movegen.hpp"
+#include "threads.hpp"
+#include "transpositiontable.hpp"
+#include "zobrist.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace Engine
+{
+
+DataGeneratorStats DataGenerator::Run(const char* filename, const Callback& callback)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::app);
+
+    if(!file) throw std::runtime_error("Failed to open file: " + std::string(filename));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    stopped.store(false, std::memory_order_relaxed);
+
+    DataGeneratorStats stats;
+
+    std::mutex mutex;
+
+    RunOnThreads(settings.threads, [&](int thread)
+    {
+        TranspositionTable table(settings.tableMegabytes);
+        Search             search(table);
+
+        std::mt19937 random(settings.seed + u32(thread));
+
+        Board board;
+        Piece::ActionCollection actions;
+        std::vector<u64>        hashes;
+
+        std::vector<TrainingPosition> game;
+        std::vector<TrainingPosition> buffer;
+
+        game.reserve(settings.maxPlies);
+        buffer.reserve(settings.flushRecords + settings.maxPlies);
+
+        u64 games = 0;
+
+        auto Flush = [&]()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(TrainingPosition));
+            file.flush();
+
+            if(!file) throw std::runtime_error("Failed to write file: " + std::string(filename));
+
+            stats.games       += games;
+            stats.positions   += buffer.size();
+            stats.milliseconds = u64(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+            if(stats.positions >= settings.positions)
+            {
+                Stop();
+            }
+
+            if(callback)
+            {
+                callback(stats);
+            }
+
+            buffer.clear();
+            games = 0;
+        };
+
+        while(!stopped.load(std::memory_order_relaxed))
+        {
+            board = Board();
+            table.Clear();
+            hashes.clear();
+            game.clear();
+
+            Board::Result result = Board::Result::Draw;
+
+            for(int ply = 0; ply < settings.maxPlies; ++ply)
+            {
+                actions.clear();
+                GenerateLegalActions(board, actions);
+
+                const Piece::Team team    = board.GetCurrentTeamTurn();
+                const bool        inCheck = IsInCheck(board, team);
+
+                if(actions.empty())
+                {
+                    if(inCheck)
+                    {
+                        result = team == Piece::Team::White ? Board::Result::BlackWins : Board::Result::WhiteWins;
+                    }
+
+                    break;
+                }
+
+                if(!hashes.empty() && std::count(hashes.begin(), hashes.end(), hashes.back()) >= 3)
+                {
+                    break;
+                }
+
+                const Piece::Action* action;
+
+                if(ply < settings.randomPlies)
+                {
+                    action = &actions[random() % actions.size()];
+                }
+                else
+                {
+                    const SearchInfo info = search.Run(board, settings.limits);
+
+                    if(!inCheck)
+                    {
+                        TrainingPosition position = TrainingPosition::Pack(board);
+
+                        position.score = s16(info.lines.front().score);
+                        position.ply   = u16(ply);
+
+                        game.push_back(position);
+                    }
+
+                    action = Move::FindAction(info.lines.front().moves.front(), actions);
+                }
+
+                board.DoAction(*action);
+                hashes.push_back(Zobrist::Hash(board));
+            }
+
+            for(auto& position : game)
+            {
+                position.result = u8(result);
+            }
+
+            buffer.insert(buffer.end(), game.begin(), game.end());
+            ++games;
+
+            if(int(buffer.size()) >= settings.flushRecords)
+            {
+                Flush();
+            }
+        }
+
+        Flush();
+    },
+    [&] { Stop(); });
+
+    return stats;
+}
+
+}
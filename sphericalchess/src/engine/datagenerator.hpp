@@ -0,0 +1,68 @@
+#pragma once
+
+#include "search.hpp"
+#include "trainingposition.hpp"
+
+#include "../core.hpp"
+
+#include <atomic>
+#include <functional>
+
+namespace Engine
+{
+
+struct DataGeneratorSettings
+{
+    u64 positions = 1000000;    //!< Stops after at least this many positions are written.
+    int threads   = 1;          //!< Games played at the same time.
+
+    SearchLimits limits;        //!< Per move, kept shallow as the positions are more valuable than the quality of the games.
+
+    int randomPlies    = 8;     //!< Random moves at the start of every game so the games differ, these positions aren't written.
+    int maxPlies       = 300;   //!< Games still going after this many plies are a draw.
+    int flushRecords   = 4096;  //!< Records each thread buffers before appending them to the file.
+    int tableMegabytes = 8;     //!< Per thread.
+    u32 seed           = 1;
+};
+
+struct DataGeneratorStats
+{
+    u64 games        = 0;
+    u64 positions    = 0;
+    u64 milliseconds = 0;
+
+    double GetPositionsPerSecond() const { return milliseconds > 0 ? positions * 1000.0 / milliseconds : 0.0; }
+};
+
+//! @brief Plays shallow search games on a pool of threads and writes their positions as TrainingPosition records.
+//!
+//! Only the positions of the games being played and a fixed size buffer per thread are kept in memory, as the result
+//! of a game is only known once it ends. Records are appended to the file in whole batches and flushed, so the
+//! file always holds complete records and can be concatenated with others while still being written.
+//! Positions in check are skipped as they can't be evaluated statically.
+class DataGenerator
+{
+public:
+
+    //! @brief Called after every batch of records is flushed, one at a time.
+    using Callback = std::function<void(const DataGeneratorStats&)>;
+
+    explicit DataGenerator(const DataGeneratorSettings& settings) : settings(settings)
+    {
+    }
+
+    //! @brief Appends to @p filename until enough positions are written or Stop() is called.
+    //! @throws std::runtime_error When the file fails to open.
+    DataGeneratorStats Run(const char* filename, const Callback& callback = Callback());
+
+    //! @brief Finishes the games being played then stops.
+    void Stop() { stopped.store(true, std::memory_order_relaxed); }
+
+private:
+
+    DataGeneratorSettings settings;
+
+    std::atomic<bool> stopped { false };
+};
+
+}
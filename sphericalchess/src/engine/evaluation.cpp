@@ -0,0 +1,55 @@
+#include "evaluation.hpp"
+
+#include "evaluationparameters.hpp"
+
+namespace Engine
+{
+
+int Evaluate(const Board& board)
+{
+    int score = 0; // relative to white
+
+    for(int i = 0; i < Board::kDimension; ++i)
+    {
+        for(int j = 0; j < Board::kDimension; ++j)
+        {
+            if(auto& piece = board.PieceAt(i, j))
+            {
+                const int type = int(piece.GetType());
+
+                if(piece.GetTeam() == Piece::Team::White)
+                {
+                    score += Parameters::kPieceValue[type] + Parameters::kRankBonus[type][j];
+                }
+                else
+                {
+                    score -= Parameters::kPieceValue[type] + Parameters::kRankBonus[type][Board::kDimension - 1 - j];
+                }
+            }
+        }
+    }
+
+    return board.GetCurrentTeamTurn() == Piece::Team::White ? score : -score;
+}
+
+int Evaluate(const BitboardPosition& position)
+{
+    int score = 0; // relative to white
+
+    for(int type = 0; type < kNumTypes; ++type)
+    {
+        for(u64 bits = position.pieces[0][type]; bits; bits &= bits - 1)
+        {
+            score += Parameters::kPieceValue[type] + Parameters::kRankBonus[type][LowestBit(bits) / Board::kDimension];
+        }
+
+        for(u64 bits = position.pieces[1][type]; bits; bits &= bits - 1)
+        {
+            score -= Parameters::kPieceValue[type] + Parameters::kRankBonus[type][Board::kDimension - 1 - LowestBit(bits) / Board::kDimension];
+        }
+    }
+
+    return position.turn == u8(Piece::Team::White) ? score : -score;
+}
+
+}
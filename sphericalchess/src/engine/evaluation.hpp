@@ -0,0 +1,21 @@
+#pragma once
+
+#include "bitboard.hpp"
+
+#include "../game/board.hpp"
+
+namespace Engine
+{
+
+constexpr int kScoreInfinite = 32000;
+constexpr int kScoreMate     = 31000;               //!< Score of delivering checkmate, reduced by the number of plies it takes.
+constexpr int kScoreMateMin  = kScoreMate - 1000;   //!< Any score above this is a forced mate.
+
+//! @brief Static evaluation of @p board in centipawns.
+//! @returns Score relative to the team to move, positive is good for that team.
+int Evaluate(const Board& board);
+
+//! @brief Same as Evaluate(const Board&) for a BitboardPosition.
+int Evaluate(const BitboardPosition& position);
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+//! @file
+//! Weights used by Engine::Evaluate(), indexed by Piece::Type.
+//! Ranks are counted from the owning team's side of the board, the board has no edges
+//! along the x axis so there is no bonus per column.
+
+namespace Engine
+{
+namespace Parameters
+{
+
+constexpr int kPieceValue[6] =
+{
+    100,    // Pawn
+    350,    // Bishop, stronger than on a flat board as diagonals wrap around the sphere
+    300,    // Knight
+    500,    // Rook
+    950,    // Queen
+    0,      // King
+};
+
+constexpr int kRankBonus[6][8] =
+{
+    {   0,   0,   5,  10,  20,  35,  60,   0 },   // Pawn
+    {  -5,   5,  10,  10,  10,  10,   5,  -5 },   // Bishop
+    { -15,   0,  10,  15,  15,  10,   0, -15 },   // Knight
+    {   0,   0,   0,   0,   0,   0,  10,   5 },   // Rook
+    {  -5,   0,   5,   5,   5,   5,   0,  -5 },   // Queen
+    {  10,   0, -10, -20, -20, -25, -25, -25 },   // King
+};
+
+}
+}
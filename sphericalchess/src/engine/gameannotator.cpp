@@ -0,0 +1,321 @@
+#include "gameannotator.hpp"
+
+#include "evaluation.hpp"
+#include "gamerecord.hpp"
+#include "search.hpp"
+#include "threads.hpp"
+#include "transpositiontable.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+constexpr char GameAnnotator::kMagic[4];
+
+namespace
+{
+    struct FileHeader
+    {
+        char magic[4];
+        u32  version;
+        u64  games;
+        u64  gamesSize;
+        u64  nodes;
+    };
+
+    struct GameHeader
+    {
+        u64 offset;
+        u16 numPlies;
+        u16 inaccuracies;
+        u16 mistakes;
+        u16 blunders;
+    };
+
+    static_assert(sizeof(FileHeader) == 32, "FileHeader must match the file layout.");
+    static_assert(sizeof(GameHeader) == 16, "GameHeader must match the file layout.");
+
+    //! @brief Searches every position of @p game and annotates the moves played.
+    //! @returns Nodes searched.
+    u64 AnnotateGame(const GameRecordView& game, const AnnotationSettings& settings, TranspositionTable& table, Search& search,
+                     GameRecordReplay& replay, std::vector<BitboardPosition>& positions, std::vector<AnnotationPly>& plies)
+    {
+        std::vector<Move> moves;
+
+        positions.clear();
+        replay.Start(game);
+        positions.push_back(replay.GetPosition());
+
+        for(Move move; replay.Next(move);)
+        {
+            moves.push_back(move);
+            positions.push_back(replay.GetPosition());
+        }
+
+        plies.assign(positions.size(), AnnotationPly());
+
+        SearchLimits limits;
+
+        limits.nodes     = settings.nodes;
+        limits.threads   = 1;
+        limits.newSearch = false;
+
+        // the table is shared by every thread, so its entries are aged once a game rather than once a position
+
+        table.NewSearch();
+
+        Board board;
+        u64   nodes = 0;
+
+        for(std::size_t ply = 0; ply < positions.size(); ++ply)
+        {
+            const BitboardPosition& position = positions[ply];
+
+            position.ToBoard(board);
+
+            const SearchInfo info = search.Run(board, limits);
+
+            nodes += info.nodes;
+
+            if(info.lines.empty())
+            {
+                plies[ply].score = s16(position.IsInCheck(position.turn) ? -kScoreMate : 0);
+            }
+            else
+            {
+                plies[ply].score = s16(std::max(-kScoreInfinite, std::min(info.lines[0].score, kScoreInfinite)));
+                plies[ply].best  = info.lines[0].moves.empty() ? 0 : info.lines[0].moves[0].GetData();
+            }
+        }
+
+        // the move played is worth the score of the next position from the other side
+
+        for(std::size_t ply = 0; ply < moves.size(); ++ply)
+        {
+            AnnotationPly& annotation = plies[ply];
+
+            if(moves[ply].GetData() == annotation.best)
+            {
+                continue;
+            }
+
+            const int before = std::max(-settings.maxScore, std::min(int(annotation.score), settings.maxScore));
+            const int after  = std::max(-settings.maxScore, std::min(-int(plies[ply + 1].score), settings.maxScore));
+            const int loss   = std::max(before - after, 0);
+
+            annotation.loss = s16(loss);
+
+            if(loss >= settings.blunder)
+            {
+                annotation.glyph = VariationTree::Glyph_blunder;
+            }
+            else if(loss >= settings.mistake)
+            {
+                annotation.glyph = VariationTree::Glyph_mistake;
+            }
+            else if(loss >= settings.inaccuracy)
+            {
+                annotation.glyph = VariationTree::Glyph_dubious;
+            }
+        }
+
+        return nodes;
+    }
+}
+
+AnnotationStats GameAnnotator::Annotate(const char* gamesFilename, const char* filename, const AnnotationSettings& settings)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const int numThreads = std::max(settings.threads, 1);
+
+    std::vector<std::size_t> offsets;
+    u64                      gamesSize;
+
+    {
+        GameRecordReader reader(gamesFilename);
+
+        offsets   = reader.ReadOffsets();
+        gamesSize = reader.GetSize();
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+    if(!file) throw std::runtime_error("Failed to open file: " + std::string(filename));
+
+    FileHeader header = {};
+
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version   = kVersion;
+    header.gamesSize = gamesSize;
+    header.nodes     = settings.nodes;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    TranspositionTable table(std::size_t(std::max(settings.tableMegabytes, 1)));
+    AnnotationStats    stats;
+
+    std::atomic<std::size_t> nextGame { 0 };
+    std::atomic<bool>        stopped  { false };
+
+    std::mutex mutex;
+
+    std::map<std::size_t, std::vector<u8>> finished;    //!< Games waiting for the games before them to be written.
+    std::size_t                            nextWrite = 0;
+
+    RunOnThreads(numThreads, [&](int)
+    {
+        GameRecordReader reader(gamesFilename);
+        GameRecordReplay replay;
+        GameRecordView   game;
+        Search           search(table);
+
+        std::vector<BitboardPosition> positions;
+        std::vector<AnnotationPly>    plies;
+
+        for(std::size_t i; !stopped.load(std::memory_order_relaxed) && (i = nextGame.fetch_add(1)) < offsets.size();)
+        {
+            reader.Seek(offsets[i]);
+
+            if(!reader.Next(game))
+            {
+                throw std::runtime_error("Games file changed while annotating: " + std::string(gamesFilename));
+            }
+
+            const u64 nodes = AnnotateGame(game, settings, table, search, replay, positions, plies);
+
+            GameHeader gameHeader = {};
+
+            gameHeader.offset   = offsets[i];
+            gameHeader.numPlies = u16(plies.size() - 1);
+
+            for(const AnnotationPly& ply : plies)
+            {
+                gameHeader.inaccuracies += ply.glyph == VariationTree::Glyph_dubious;
+                gameHeader.mistakes     += ply.glyph == VariationTree::Glyph_mistake;
+                gameHeader.blunders     += ply.glyph == VariationTree::Glyph_blunder;
+            }
+
+            std::vector<u8> record(sizeof(GameHeader) + plies.size() * sizeof(AnnotationPly));
+
+            std::memcpy(record.data(), &gameHeader, sizeof(GameHeader));
+            std::memcpy(record.data() + sizeof(GameHeader), plies.data(), plies.size() * sizeof(AnnotationPly));
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            finished.emplace(i, std::move(record));
+
+            for(auto next = finished.begin(); next != finished.end() && next->first == nextWrite; next = finished.erase(next), ++nextWrite)
+            {
+                file.write(reinterpret_cast<const char*>(next->second.data()), std::streamsize(next->second.size()));
+            }
+
+            if(!file) throw std::runtime_error("Failed to write file: " + std::string(filename));
+
+            stats.games        += 1;
+            stats.positions    += plies.size();
+            stats.nodes        += nodes;
+            stats.inaccuracies += gameHeader.inaccuracies;
+            stats.mistakes     += gameHeader.mistakes;
+            stats.blunders     += gameHeader.blunders;
+            stats.milliseconds  = u64(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+            if(settings.progress)
+            {
+                settings.progress(stats);
+            }
+        }
+    },
+    [&] { stopped.store(true, std::memory_order_relaxed); });
+
+    header.games = offsets.size();
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+
+    if(!file) throw std::runtime_error("Failed to write file: " + std::string(filename));
+
+    stats.milliseconds = u64(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+    return stats;
+}
+
+AnnotationReader::AnnotationReader(const char* filename)
+{
+    file.Open(filename);
+
+    FileHeader header;
+
+    if(file.GetSize() < sizeof(FileHeader))
+    {
+        throw std::runtime_error("Not an annotation file: " + std::string(filename));
+    }
+
+    std::memcpy(&header, file.GetData(), sizeof(FileHeader));
+
+    if(std::memcmp(header.magic, GameAnnotator::kMagic, sizeof(GameAnnotator::kMagic)) != 0 || header.version != GameAnnotator::kVersion)
+    {
+        throw std::runtime_error("Not a supported annotation file: " + std::string(filename));
+    }
+
+    games     = header.games;
+    gamesSize = header.gamesSize;
+    nodes     = header.nodes;
+
+    Rewind();
+}
+
+bool AnnotationReader::Next(AnnotatedGame& game)
+{
+    const std::size_t size = file.GetSize();
+
+    if(offset >= size)
+    {
+        return false;
+    }
+
+    GameHeader header;
+
+    if(size - offset < sizeof(GameHeader))
+    {
+        throw std::runtime_error("Annotated game is cut short");
+    }
+
+    std::memcpy(&header, file.GetData() + offset, sizeof(GameHeader));
+
+    const std::size_t pliesSize = (std::size_t(header.numPlies) + 1) * sizeof(AnnotationPly);
+
+    if(size - offset - sizeof(GameHeader) < pliesSize)
+    {
+        throw std::runtime_error("Annotated game is cut short");
+    }
+
+    game.offset       = header.offset;
+    game.numPlies     = header.numPlies;
+    game.inaccuracies = header.inaccuracies;
+    game.mistakes     = header.mistakes;
+    game.blunders     = header.blunders;
+    game.plies        = reinterpret_cast<const AnnotationPly*>(file.GetData() + offset + sizeof(GameHeader));
+
+    offset += sizeof(GameHeader) + pliesSize;
+
+    return true;
+}
+
+void AnnotationReader::Rewind()
+{
+    offset = sizeof(FileHeader);
+}
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "move.hpp"
+#include "variationtree.hpp"
+
+#include "../mappedfile.hpp"
+#include "../core.hpp"
+
+#include <cstddef>
+#include <functional>
+
+namespace Engine
+{
+
+struct AnnotationStats
+{
+    u64 games        = 0;
+    u64 positions    = 0;   //!< Positions searched, every position of every game including the last.
+    u64 nodes        = 0;
+    u64 inaccuracies = 0;
+    u64 mistakes     = 0;
+    u64 blunders     = 0;
+    u64 milliseconds = 0;
+
+    double GetGamesPerHour() const { return milliseconds > 0 ? games * 3600000.0 / milliseconds : 0.0; }
+};
+
+struct AnnotationSettings
+{
+    int threads        = 1;
+    u64 nodes          = 20000;    //!< Searched in each position.
+    int tableMegabytes = 256;      //!< Of the TranspositionTable shared by the threads.
+
+    //! @brief Centipawns lost by a move, against the best move found, to be annotated as each glyph.
+    int inaccuracy = 50;
+    int mistake    = 100;
+    int blunder    = 300;
+
+    //! @brief Scores are clamped to this before comparing, so a slower mate or a move in a lost position isn't a blunder.
+    int maxScore = 1000;
+
+    //! @brief Called as games are written, from whichever thread wrote them.
+    std::function<void(const AnnotationStats&)> progress;
+};
+
+//! @brief Evaluation of a position of an annotated game and the move played in it.
+struct AnnotationPly
+{
+    u16 best;       //!< Move::GetData() of the best move found, zero when there is no legal move.
+    s16 score;      //!< Of the position, relative to the team to move.
+    s16 loss;       //!< Centipawns the move played lost against the best move, zero for the best move itself.
+    u8  glyph;      //!< VariationTree::Glyph of the move played.
+    u8  reserved;
+
+    Move GetBest() const { return Move(best); }
+};
+
+static_assert(sizeof(AnnotationPly) == 8, "AnnotationPly must match the file layout.");
+
+//! @brief An annotated game, pointing into an annotation file.
+struct AnnotatedGame
+{
+    u64 offset       = 0;   //!< Of the game in the games file, for GameRecordReader::Seek().
+    u16 numPlies     = 0;
+    u16 inaccuracies = 0;
+    u16 mistakes     = 0;
+    u16 blunders     = 0;
+
+    const AnnotationPly* plies = nullptr;   //!< numPlies + 1, for the position before each move and the final position.
+};
+
+//! @brief Searches every position of the games of a GameRecordWriter file and writes a sidecar file of the
+//! evaluations, the best moves and the moves that lost the most.
+//!
+//! | Field            | Size                                                                            |
+//! |------------------|---------------------------------------------------------------------------------|
+//! | Magic "SCGA"     | 4 bytes, once at the start of the file.                                         |
+//! | Version          | 4 bytes, once at the start of the file.                                         |
+//! | Games            | 8 bytes, once at the start of the file.                                         |
+//! | Games file size  | 8 bytes, once at the start of the file, to notice annotations of another file.  |
+//! | Nodes            | 8 bytes, once at the start of the file, searched in each position.              |
+//! | Offset           | 8 bytes, of the game in the games file.                                         |
+//! | Number of plies  | 2 bytes.                                                                        |
+//! | Counts           | 2 bytes each of inaccuracies, mistakes and blunders.                            |
+//! | Plies            | AnnotationPly for each ply and the final position, 8 bytes each.                |
+//!
+//! Games are written in the order of the games file. All values are stored little endian.
+class GameAnnotator
+{
+public:
+
+    static constexpr char kMagic[4] = { 'S', 'C', 'G', 'A' };
+    static constexpr u32  kVersion  = 1;
+
+    //! @brief Annotates every game of @p gamesFilename and writes the annotations to @p filename.
+    //!
+    //! Threads take turns at games, each searching with its own Search and all sharing one TranspositionTable,
+    //! so positions the games have in common are only searched deeply once. Games finished out of order wait
+    //! until the games before them are written. With more than one thread the evaluations depend on timing.
+    //! @throws std::runtime_error When a file fails to open or be written, or the games file is corrupt.
+    static AnnotationStats Annotate(const char* gamesFilename, const char* filename, const AnnotationSettings& settings);
+};
+
+//! @brief Reads the games of an annotation file written by GameAnnotator, mapped into memory.
+class AnnotationReader
+{
+public:
+
+    //! @throws std::runtime_error When the file fails to open or isn't an annotation file.
+    explicit AnnotationReader(const char* filename);
+
+    //! @returns False after the last game.
+    //! @throws std::runtime_error When the game is cut short.
+    bool Next(AnnotatedGame& game);
+
+    //! @brief Goes back to the first game.
+    void Rewind();
+
+    u64 GetNumGames()  const { return games; }
+    u64 GetGamesSize() const { return gamesSize; }
+    u64 GetNodes()     const { return nodes; }
+
+private:
+
+    MappedFile  file;
+    std::size_t offset    = 0;
+    u64         games     = 0;
+    u64         gamesSize = 0;
+    u64         nodes     = 0;
+};
+
+}
@@ -0,0 +1,149 @@
+#include "gameindex.hpp"
+
+#include "gamerecord.hpp"
+#include "threads.hpp"
+#include "zobrist.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+constexpr char GameIndex::kMagic[4];
+
+namespace
+{
+    constexpr int kMaxOffsetBits = 48;
+
+    using Entry = GameIndex::Entry;
+
+    struct EntryPolicy
+    {
+        static bool Less(const Entry& a, const Entry& b)
+        {
+            return a.key != b.key ? a.key < b.key : a.location < b.location;
+        }
+
+        static bool Combine(Entry&, const Entry&) { return false; }
+        static void Finish(Entry*, Entry*)        {}
+    };
+
+    using Builder = SortedTableBuilder<Entry, EntryPolicy>;
+}
+
+GameIndexStats GameIndex::Build(const char* gamesFilename, const char* filename, const GameIndexSettings& settings)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const int numThreads = std::max(settings.threads, 1);
+
+    std::vector<std::size_t> offsets;
+    u64                      gamesSize;
+
+    {
+        GameRecordReader reader(gamesFilename);
+
+        offsets   = reader.ReadOffsets();
+        gamesSize = reader.GetSize();
+    }
+
+    if(gamesSize >> kMaxOffsetBits)
+    {
+        throw std::runtime_error("Games file is too large to index: " + std::string(gamesFilename));
+    }
+
+    const std::size_t runEntries = std::max<std::size_t>(std::size_t(settings.memoryMegabytes) * (1 << 20) / sizeof(Entry) / std::size_t(numThreads), Builder::kWriteEntries);
+
+    GameIndexStats stats;
+
+    std::atomic<std::size_t> nextChunk { 0 };
+    std::atomic<bool>        stopped   { false };
+
+    Builder builder(filename);
+
+    RunOnThreads(numThreads, [&](int)
+    {
+        GameRecordReader reader(gamesFilename);
+        GameRecordReplay replay;
+        GameRecordView   game;
+
+        std::vector<Entry> entries;
+        std::vector<Entry> gameEntries;
+
+        for(std::size_t chunk; !stopped.load(std::memory_order_relaxed) && (chunk = nextChunk.fetch_add(GameRecordReader::kChunkGames)) < offsets.size();)
+        {
+            const std::size_t last = std::min(chunk + GameRecordReader::kChunkGames, offsets.size());
+
+            reader.Seek(offsets[chunk]);
+
+            for(std::size_t i = chunk; i < last && reader.Next(game); ++i)
+            {
+                gameEntries.clear();
+                replay.Start(game);
+
+                u64 ply = 0;
+
+                for(Move move; replay.Next(move);)
+                {
+                    gameEntries.push_back({ Zobrist::Hash(replay.GetPosition()), (u64(offsets[i]) << 16) | ++ply });
+                }
+
+                // a repeated position keeps its first ply, which sorts first
+
+                std::sort(gameEntries.begin(), gameEntries.end(), EntryPolicy::Less);
+
+                for(std::size_t j = 0; j < gameEntries.size(); ++j)
+                {
+                    if(j == 0 || gameEntries[j].key != gameEntries[j - 1].key)
+                    {
+                        entries.push_back(gameEntries[j]);
+                    }
+                }
+            }
+
+            if(entries.size() >= runEntries)
+            {
+                builder.AddRun(entries);
+            }
+        }
+
+        builder.AddRun(entries);
+    },
+    [&] { stopped.store(true, std::memory_order_relaxed); });
+
+    Header header = {};
+
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.version   = kVersion;
+    header.gamesSize = gamesSize;
+
+    stats.positions = builder.Merge(header);
+
+    stats.games        = offsets.size();
+    stats.runs         = builder.GetNumRuns();
+    stats.milliseconds = u64(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+    return stats;
+}
+
+void GameIndex::Open(const char* filename)
+{
+    Close();
+
+    gamesSize = table.Open<Header>(filename, "Game index", kMagic, kVersion).gamesSize;
+}
+
+void GameIndex::Close()
+{
+    table.Close();
+
+    gamesSize = 0;
+}
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "sortedtable.hpp"
+
+#include "../core.hpp"
+
+#include <cstddef>
+#include <utility>
+
+namespace Engine
+{
+
+struct GameIndexSettings
+{
+    int threads         = 1;
+    int memoryMegabytes = 1024;     //!< For the entries held before they are sorted into a temporary file, shared by the threads.
+};
+
+struct GameIndexStats
+{
+    u64 games        = 0;
+    u64 positions    = 0;   //!< Entries in the index.
+    u64 runs         = 0;   //!< Sorted temporary files merged into the index.
+    u64 milliseconds = 0;
+
+    double GetGamesPerSecond() const { return milliseconds > 0 ? games * 1000.0 / milliseconds : 0.0; }
+};
+
+//! @brief Read only index from positions to the games of a GameRecordWriter file that reach them, memory mapped
+//! and searched in place.
+//!
+//! A SortedTable of an Entry for every position a game reaches after one of its moves, sorted by key then
+//! location, after a Header that keeps the size of the games file to notice an index of a different file.
+//!
+//! Positions are keyed by Zobrist::Hash(const BitboardPosition&), a position repeated in a game is only
+//! entered for its first ply. The start position is left out as every game has it. All values are stored
+//! little endian.
+class GameIndex
+{
+public:
+
+    struct Entry
+    {
+        u64 key;
+        u64 location;   //!< Offset of the game in the games file shifted up 16 bits, with the ply in the low 16 bits.
+
+        std::size_t GetOffset() const { return std::size_t(location >> 16); }
+
+        //! @brief Moves made to reach the position.
+        int GetPly() const { return int(location & 0xFFFF); }
+    };
+
+    struct Header
+    {
+        char magic[4];      //!< Always kMagic.
+        u32  version;
+        u64  count;         //!< Number of entries following the buckets.
+        u64  gamesSize;     //!< Size in bytes of the games file that was indexed.
+        u32  bucketBits;
+        u32  reserved;
+    };
+
+    static_assert(sizeof(Entry)  == 16, "Entry must match the file layout.");
+    static_assert(sizeof(Header) == 32, "Header must match the file layout.");
+
+    static constexpr char kMagic[4] = { 'S', 'C', 'G', 'I' };
+    static constexpr u32  kVersion  = 1;
+
+    //! @brief Indexes every game of @p gamesFilename on a pool of threads and writes the index to @p filename.
+    //!
+    //! Each thread sorts its entries into temporary files next to @p filename once it holds its share of the
+    //! memory, which are then merged into the index and removed, so games of any number can be indexed.
+    //! @throws std::runtime_error When a file fails to open or be written, or the games file is corrupt.
+    static GameIndexStats Build(const char* gamesFilename, const char* filename, const GameIndexSettings& settings);
+
+    //! @throws std::runtime_error When the file can't be opened or isn't a valid index.
+    void Open(const char* filename);
+    void Close();
+
+    bool IsOpen() const { return table.IsOpen(); }
+
+    std::size_t GetNumEntries() const { return table.GetNumEntries(); }
+    u64         GetGamesSize()  const { return gamesSize; }
+
+    //! @returns Every game reaching position @p key, as a [first, last) range that is empty when none does.
+    std::pair<const Entry*, const Entry*> Find(u64 key) const { return table.Find(key); }
+
+private:
+
+    SortedTable<Entry> table;
+    u64                gamesSize = 0;
+};
+
+}
@@ -0,0 +1,398 @@
+#include "gamerecord.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr std::size_t kFileHeaderSize = sizeof(kGameRecordMagic) + sizeof(u32);
+    constexpr std::size_t kGameHeaderSize = 4;
+    constexpr int         kMaxByteIndex   = 256;   //!< Moves in a position for indices to fit in a byte.
+
+    void Write16(std::vector<u8>& output, u16 value)
+    {
+        output.push_back(u8(value));
+        output.push_back(u8(value >> 8));
+    }
+
+    void Write32(std::vector<u8>& output, u32 value)
+    {
+        Write16(output, u16(value));
+        Write16(output, u16(value >> 16));
+    }
+
+    u16 Read16(const u8* data)
+    {
+        return u16(data[0] | (data[1] << 8));
+    }
+
+    u32 Read32(const u8* data)
+    {
+        return u32(Read16(data)) | (u32(Read16(data + 2)) << 16);
+    }
+
+    std::runtime_error Corrupt(const char* what)
+    {
+        return std::runtime_error(std::string("Corrupt game record: ") + what);
+    }
+}
+
+bool GameRecordView::FindTag(const char* key, GameRecordTag& value) const
+{
+    const std::size_t keySize = std::strlen(key);
+
+    bool found = false;
+
+    ForEachTag([&](const GameRecordTag& tag)
+    {
+        if(!found && tag.keySize == keySize && std::memcmp(tag.key, key, keySize) == 0)
+        {
+            value = tag;
+            found = true;
+        }
+    });
+
+    return found;
+}
+
+void GameRecordReplay::Start(const GameRecordView& game)
+{
+    position.SetStart();
+    numMoves = position.GenerateLegal(masks);
+
+    data      = game.moves;
+    end       = game.moves + game.movesSize;
+    remaining = game.numPlies;
+}
+
+bool GameRecordReplay::Next(Move& move)
+{
+    if(remaining == 0)
+    {
+        return false;
+    }
+
+    const int size = numMoves > kMaxByteIndex ? 2 : 1;
+
+    if(end - data < size)
+    {
+        throw Corrupt("moves cut short");
+    }
+
+    int index = size == 2 ? Read16(data) : *data;
+    data += size;
+
+    if(index >= numMoves)
+    {
+        throw Corrupt("move index out of range");
+    }
+
+    for(int origin = 0; origin < kNumSquares; ++origin)
+    {
+        for(u64 bits = masks[origin]; bits; bits &= bits - 1)
+        {
+            if(index-- == 0)
+            {
+                const int destination = LowestBit(bits);
+
+                move = position.ToMove(origin, destination);
+
+                position.Apply(origin, destination);
+                numMoves = position.GenerateLegal(masks);
+
+                --remaining;
+
+                return true;
+            }
+        }
+    }
+
+    return false; // not reached, the index is below the number of moves
+}
+
+GameRecordWriter::GameRecordWriter(const char* filename, bool append) : filename(filename)
+{
+    if(append)
+    {
+        std::ifstream existing(filename, std::ios::binary);
+
+        if(existing)
+        {
+            char header[kFileHeaderSize];
+
+            if(!existing.read(header, sizeof(header)) || std::memcmp(header, kGameRecordMagic, sizeof(kGameRecordMagic)) != 0
+                || Read32(reinterpret_cast<const u8*>(header) + sizeof(kGameRecordMagic)) != kGameRecordVersion)
+            {
+                throw std::runtime_error("Not a game record file of version " + std::to_string(kGameRecordVersion) + ": " + filename);
+            }
+
+            existing.close();
+
+            file.open(filename, std::ios::binary | std::ios::app);
+        }
+    }
+
+    if(!file.is_open())
+    {
+        file.open(filename, std::ios::binary | std::ios::trunc);
+
+        buffer.assign(kGameRecordMagic, kGameRecordMagic + sizeof(kGameRecordMagic));
+        Write32(buffer, kGameRecordVersion);
+
+        file.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size()));
+    }
+
+    if(!file)
+    {
+        throw std::runtime_error("Failed to open file: " + std::string(filename));
+    }
+
+    Begin();
+}
+
+void GameRecordWriter::Begin()
+{
+    tags.clear();
+    moves.clear();
+
+    numTags  = 0;
+    numPlies = 0;
+
+    position.SetStart();
+    numMoves = position.GenerateLegal(masks);
+}
+
+void GameRecordWriter::AddTag(const std::string& key, const std::string& value)
+{
+    if(key.size() > 255 || value.size() > 65535 || numTags == 255)
+    {
+        throw std::runtime_error("Game record tag too long or too many tags: " + key);
+    }
+
+    tags.push_back(u8(key.size()));
+    tags.insert(tags.end(), key.begin(), key.end());
+
+    Write16(tags, u16(value.size()));
+    tags.insert(tags.end(), value.begin(), value.end());
+
+    ++numTags;
+}
+
+void GameRecordWriter::AddMove(Move move)
+{
+    const int origin      = move.GetData() & 63;
+    const int destination = (move.GetData() >> 6) & 63;
+
+    if((masks[origin] & (u64(1) << destination)) == 0)
+    {
+        throw std::runtime_error("Illegal move in game record: " + move.ToString());
+    }
+
+    // moves from earlier origins, then those to lower destinations from the same origin
+
+    int index = 0;
+
+    for(int square = 0; square < origin; ++square)
+    {
+        for(u64 bits = masks[square]; bits; bits &= bits - 1)
+        {
+            ++index;
+        }
+    }
+
+    for(u64 bits = masks[origin] & ((u64(1) << destination) - 1); bits; bits &= bits - 1)
+    {
+        ++index;
+    }
+
+    if(numMoves > kMaxByteIndex)
+    {
+        Write16(moves, u16(index));
+    }
+    else
+    {
+        moves.push_back(u8(index));
+    }
+
+    position.Apply(origin, destination);
+    numMoves = position.GenerateLegal(masks);
+
+    ++numPlies;
+}
+
+void GameRecordWriter::End(Board::Result result)
+{
+    buffer.clear();
+
+    Write32(buffer, u32(1 + 1 + tags.size() + 2 + moves.size()));
+
+    buffer.push_back(u8(result));
+    buffer.push_back(numTags);
+    buffer.insert(buffer.end(), tags.begin(), tags.end());
+
+    Write16(buffer, numPlies);
+    buffer.insert(buffer.end(), moves.begin(), moves.end());
+
+    file.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size()));
+
+    Begin();
+
+    if(!file) throw std::runtime_error("Failed to write file: " + filename);
+}
+
+void GameRecordWriter::Flush()
+{
+    file.flush();
+
+    if(!file) throw std::runtime_error("Failed to write file: " + filename);
+}
+
+GameRecordReader::GameRecordReader(const char* filename)
+{
+    file.Open(filename);
+
+    if(file.GetSize() < kFileHeaderSize || std::memcmp(file.GetData(), kGameRecordMagic, sizeof(kGameRecordMagic)) != 0)
+    {
+        throw std::runtime_error("Not a game record file: " + std::string(filename));
+    }
+
+    const u32 version = Read32(file.GetData() + sizeof(kGameRecordMagic));
+
+    if(version != kGameRecordVersion)
+    {
+        throw std::runtime_error("Unsupported game record version " + std::to_string(version) + ": " + filename);
+    }
+
+    Rewind();
+}
+
+bool GameRecordReader::Next(GameRecordView& game)
+{
+    const std::size_t size = file.GetSize();
+
+    if(offset >= size)
+    {
+        return false;
+    }
+
+    const u8* data = file.GetData() + offset;
+
+    if(size - offset < kGameHeaderSize + 4 || Read32(data) > size - offset - kGameHeaderSize)
+    {
+        throw Corrupt("game cut short");
+    }
+
+    const u8* const end = data + kGameHeaderSize + Read32(data);
+
+    data += kGameHeaderSize;
+
+    game.result  = Board::Result(data[0]);
+    game.numTags = data[1];
+    game.tags    = data + 2;
+
+    data += 2;
+
+    // only the sizes are read here, the contents when asked for
+
+    for(int i = 0; i < game.numTags; ++i)
+    {
+        if(end - data < 1 || end - data < 1 + data[0] + 2 || end - data < 1 + data[0] + 2 + Read16(data + 1 + data[0]))
+        {
+            throw Corrupt("tags cut short");
+        }
+
+        data += 1 + data[0];
+        data += 2 + Read16(data);
+    }
+
+    if(end - data < 2)
+    {
+        throw Corrupt("moves cut short");
+    }
+
+    game.numPlies  = Read16(data);
+    game.moves     = data + 2;
+    game.movesSize = std::size_t(end - game.moves);
+
+    offset = std::size_t(end - file.GetData());
+
+    return true;
+}
+
+void GameRecordReader::Rewind()
+{
+    offset = kFileHeaderSize;
+}
+
+std::vector<std::size_t> GameRecordReader::ReadOffsets()
+{
+    std::vector<std::size_t> offsets;
+    GameRecordView           game;
+
+    for(std::size_t next = offset; Next(game); next = offset)
+    {
+        offsets.push_back(next);
+    }
+
+    return offsets;
+}
+
+const char* ResultToString(Board::Result result)
+{
+    switch(result)
+    {
+    case Board::Result::WhiteWins: return "1-0";
+    case Board::Result::BlackWins: return "0-1";
+    case Board::Result::Draw:      return "1/2-1/2";
+    default:                       return "*";
+    }
+}
+
+void WriteGameText(std::ostream& output, const GameRecordView& game, GameRecordReplay& replay)
+{
+    game.ForEachTag([&](const GameRecordTag& tag)
+    {
+        output << '[';
+        output.write(tag.key, std::streamsize(tag.keySize));
+        output << " \"";
+
+        for(std::size_t i = 0; i < tag.valueSize; ++i)
+        {
+            if(tag.value[i] == '"' || tag.value[i] == '\\')
+            {
+                output << '\\';
+            }
+
+            output << tag.value[i];
+        }
+
+        output << "\"]\n";
+    });
+
+    output << "[Result \"" << ResultToString(game.result) << "\"]\n\n";
+
+    replay.Start(game);
+
+    Move move;
+
+    for(int ply = 0; replay.Next(move); ++ply)
+    {
+        if(ply % 2 == 0)
+        {
+            output << (ply > 0 && ply % 16 == 0 ? "\n" : ply > 0 ? " " : "") << ply / 2 + 1 << ". ";
+        }
+        else
+        {
+            output << ' ';
+        }
+
+        output << move.ToString();
+    }
+
+    output << (game.numPlies > 0 ? " " : "") << ResultToString(game.result) << "\n\n";
+}
+
+}
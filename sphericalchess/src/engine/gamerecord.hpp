@@ -0,0 +1,198 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include "move.hpp"
+
+#include "../game/board.hpp"
+#include "../mappedfile.hpp"
+#include "../core.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+constexpr char kGameRecordMagic[4] = { 'S', 'C', 'G', 'R' };
+constexpr u32  kGameRecordVersion  = 1;
+
+struct GameRecordTag
+{
+    const char* key       = nullptr;
+    std::size_t keySize   = 0;
+    const char* value     = nullptr;
+    std::size_t valueSize = 0;
+};
+
+//! @brief A game in a record file, pointing into the file rather than holding a copy.
+struct GameRecordView
+{
+    Board::Result result   = Board::Result::Undecided;
+    u8            numTags  = 0;
+    u16           numPlies = 0;
+
+    const u8*   tags      = nullptr;
+    const u8*   moves     = nullptr;
+    std::size_t movesSize = 0;
+
+    //! @brief Calls @p function with every GameRecordTag in the order they were added.
+    template<typename Function>
+    void ForEachTag(Function function) const
+    {
+        const u8* data = tags;
+
+        for(int i = 0; i < numTags; ++i)
+        {
+            GameRecordTag tag;
+
+            tag.keySize   = data[0];
+            tag.key       = reinterpret_cast<const char*>(data + 1);
+            data         += 1 + tag.keySize;
+            tag.valueSize = std::size_t(data[0] | (data[1] << 8));
+            tag.value     = reinterpret_cast<const char*>(data + 2);
+            data         += 2 + tag.valueSize;
+
+            function(tag);
+        }
+    }
+
+    //! @returns False if there is no tag @p key, otherwise @p value is set, the value isn't null terminated.
+    bool FindTag(const char* key, GameRecordTag& value) const;
+};
+
+//! @brief Plays through the moves of a GameRecordView, reused from game to game without allocating.
+class GameRecordReplay
+{
+public:
+
+    void Start(const GameRecordView& game);
+
+    //! @returns False after the last move.
+    //! @throws std::runtime_error When the record has a move that isn't legal.
+    bool Next(Move& move);
+
+    //! @brief Of the moves played so far.
+    const BitboardPosition& GetPosition() const { return position; }
+
+private:
+
+    BitboardPosition position;
+    u64              masks[kNumSquares];
+    int              numMoves = 0;
+
+    const u8* data      = nullptr;
+    const u8* end       = nullptr;
+    int       remaining = 0;
+};
+
+//! @brief Appends games to a record file as each one finishes.
+//!
+//! | Field            | Size                                                                            |
+//! |------------------|---------------------------------------------------------------------------------|
+//! | Magic "SCGR"     | 4 bytes, once at the start of the file.                                         |
+//! | Version          | 4 bytes, once at the start of the file.                                         |
+//! | Size             | 4 bytes, of the rest of the game.                                               |
+//! | Result           | 1 byte, Board::Result.                                                          |
+//! | Number of tags   | 1 byte.                                                                         |
+//! | Tags             | Key size 1 byte, key, value size 2 bytes, value, for each tag.                  |
+//! | Number of plies  | 2 bytes.                                                                        |
+//! | Moves            | Index of each move in the legal moves of its position, 1 byte each, or 2 bytes  |
+//! |                  | in the rare position with more than 256 legal moves.                            |
+//!
+//! Legal moves are in the order BitboardPosition::GenerateLegal() gives them, by origin then destination
+//! square index, so reading the moves back needs the position they were made in. Games always start from
+//! the start position. All values are stored little endian.
+class GameRecordWriter
+{
+public:
+
+    //! @param [in] append Whether to add to the games already in @p filename rather than replace them.
+    //! @throws std::runtime_error When the file fails to open, or has a different format when appending.
+    explicit GameRecordWriter(const char* filename, bool append = false);
+
+    //! @brief Starts a game from the start position, discarding any game begun and not ended.
+    void Begin();
+
+    //! @throws std::runtime_error When @p key is longer than 255 bytes, @p value longer than 65535 or there are 255 tags already.
+    void AddTag(const std::string& key, const std::string& value);
+
+    //! @throws std::runtime_error When @p move isn't legal in the game so far.
+    void AddMove(Move move);
+
+    //! @brief Writes the game, it is in the file once the writer is flushed or destroyed.
+    //! @throws std::runtime_error When the file fails to be written, such as when the disk is full.
+    void End(Board::Result result);
+
+    //! @throws std::runtime_error When the file fails to be written.
+    void Flush();
+
+private:
+
+    std::ofstream file;
+    std::string   filename;     //!< For errors.
+
+    std::vector<u8> tags;
+    std::vector<u8> moves;
+    u8              numTags  = 0;
+    u16             numPlies = 0;
+
+    BitboardPosition position;
+    u64              masks[kNumSquares];
+    int              numMoves = 0;
+
+    std::vector<u8> buffer;     //!< The game being written, kept for its capacity.
+};
+
+//! @brief Reads the games of a record file mapped into memory, the views point into the mapping.
+class GameRecordReader
+{
+public:
+
+    static constexpr std::size_t kChunkGames = 256;    //!< Games a thread takes at a time when threads share out the games of ReadOffsets().
+
+    //! @throws std::runtime_error When the file fails to open or isn't a game record file.
+    explicit GameRecordReader(const char* filename);
+
+    //! @returns False after the last game.
+    //! @throws std::runtime_error When the game is cut short or its sizes don't add up.
+    bool Next(GameRecordView& game);
+
+    //! @brief Goes back to the first game.
+    void Rewind();
+
+    //! @brief Goes to the game at @p offset, which must be from GetOffset(), the next Next() checks it.
+    void Seek(std::size_t offset) { this->offset = offset; }
+
+    //! @brief Reads through every game from the next one on, so threads can share them out without each reading through the file.
+    //! @returns GetOffset() of each game, for Seek().
+    //! @throws std::runtime_error As Next().
+    std::vector<std::size_t> ReadOffsets();
+
+    //! @returns Offset of the game the next Next() reads.
+    std::size_t GetOffset() const { return offset; }
+
+    std::size_t GetSize() const { return file.GetSize(); }
+
+private:
+
+    MappedFile  file;
+    std::size_t offset = 0;
+};
+
+//! @returns "1-0", "0-1", "1/2-1/2" or "*" when undecided.
+const char* ResultToString(Board::Result result);
+
+//! @brief Writes @p game for people to read, with every tag, the result and the moves in Move coordinate notation.
+//!
+//!     [White "a"]
+//!     [Result "1-0"]
+//!
+//!     1. e2e4 e7e5 2. f1c4 ... 1-0
+//!
+//! @throws std::runtime_error When the record has a move that isn't legal.
+void WriteGameText(std::ostream& output, const GameRecordView& game, GameRecordReplay& replay);
+
+}
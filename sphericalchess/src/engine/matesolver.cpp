@@ -0,0 +1,437 @@
+#include "matesolver.hpp"
+
+#include "threads.hpp"
+#include "zobrist.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr u32 kInfinite = 1 << 28;
+
+    constexpr int kBucketSize = 4;
+
+    //! Mixed into the keys when black is attacking, as the same position is a different node for each attacker.
+    constexpr u64 kBlackAttackerKey = 0x9E3779B97F4A7C15ull;
+
+    u32 SaturatingAdd(u32 a, u32 b)
+    {
+        return std::min(a + b, kInfinite);
+    }
+}
+
+//! @brief Proof and disproof numbers of searched nodes, in buckets replacing the entry with the least work.
+class MateSolver::Table
+{
+public:
+
+    explicit Table(std::size_t megabytes)
+    {
+        std::size_t count = 1;
+
+        while(count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024)
+        {
+            count *= 2;
+        }
+
+        buckets.reset(new Bucket[count]);
+        mask = count - 1;
+    }
+
+    //! @param [in] attacking Whether the team to move is the attacker, which decides how long a result holds.
+    bool Probe(u64 key, int depth, bool attacking, u32& phi, u32& delta) const
+    {
+        const Bucket& bucket = buckets[key & mask];
+
+        for(auto& entry : bucket.entries)
+        {
+            if(entry.key != key)
+            {
+                continue;
+            }
+
+            // a mate within fewer plies is also one within more, no mate within more plies is also none within fewer
+
+            const bool mate   = attacking ? entry.phi == 0 : entry.delta == 0;
+            const bool noMate = attacking ? entry.delta == 0 : entry.phi == 0;
+
+            if(entry.depth == depth || (mate && entry.depth <= depth) || (noMate && entry.depth >= depth))
+            {
+                phi   = entry.phi;
+                delta = entry.delta;
+                return true;
+            }
+
+            return false;
+        }
+
+        return false;
+    }
+
+    void Store(u64 key, int depth, u32 phi, u32 delta, u64 work)
+    {
+        Bucket& bucket = buckets[key & mask];
+        Entry*  target = &bucket.entries[0];
+
+        for(auto& entry : bucket.entries)
+        {
+            if(entry.key == key)
+            {
+                target = &entry;
+                break;
+            }
+
+            if(entry.work < target->work)
+            {
+                target = &entry;
+            }
+        }
+
+        target->key   = key;
+        target->phi   = phi;
+        target->delta = delta;
+        target->work  = u32(std::min<u64>(work, ~u32(0)));
+        target->depth = u8(depth);
+    }
+
+private:
+
+    struct Entry
+    {
+        u64 key   = 0;
+        u32 phi   = 0;
+        u32 delta = 0;
+        u32 work  = 0;  //!< Nodes searched below the entry.
+        u8  depth = 0;
+    };
+
+    struct Bucket
+    {
+        Entry entries[kBucketSize];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    std::size_t               mask = 0;
+};
+
+struct MateSolver::Child
+{
+    BitboardPosition position;
+    u64 hash;
+    u32 phi;
+    u32 delta;
+    u8  origin;
+    u8  destination;
+};
+
+MateSolver::MateSolver(std::size_t megabytes) : table(new Table(megabytes))
+{
+}
+
+MateSolver::~MateSolver() = default;
+
+MateSolution MateSolver::Solve(const Board& board, int maxMoves, u64 maxNodes)
+{
+    BitboardPosition position;
+    position.FromBoard(board);
+
+    return Solve(position, maxMoves, maxNodes);
+}
+
+MateSolution MateSolver::Solve(const BitboardPosition& position, int maxMoves, u64 maxNodes)
+{
+    MateSolution solution;
+
+    attacker = position.turn;
+    nodes    = 0;
+    budget   = maxNodes != 0 ? maxNodes : ~u64(0);
+
+    stack.resize(std::max(2 * maxMoves, 1));
+
+    const u64 hash = Zobrist::Hash(position);
+
+    for(int moves = 1; moves <= maxMoves && nodes < budget; ++moves)
+    {
+        const int depth = 2 * moves - 1;
+
+        u32 phi, delta;
+
+        if(!Lookup(position, hash, depth, phi, delta) || (phi != 0 && delta != 0))
+        {
+            Search(position, hash, depth, 0, kInfinite, kInfinite, phi, delta);
+        }
+
+        if(phi == 0)
+        {
+            solution.moves = moves;
+
+            // extracting the line searches again where the table has lost entries, it isn't part of the budget
+
+            budget = ~u64(0);
+
+            BuildLine(position, depth, 0, solution.line);
+            break;
+        }
+    }
+
+    solution.nodes = nodes;
+
+    return solution;
+}
+
+void MateSolver::Search(const BitboardPosition& position, u64 hash, int depth, int ply, u32 thresholdPhi, u32 thresholdDelta, u32& phi, u32& delta)
+{
+    const u64 startNodes = nodes++;
+
+    std::vector<Child>& children = stack[ply];
+    children.clear();
+
+    u64 masks[kNumSquares];
+
+    if(position.GenerateLegal(masks) == 0)
+    {
+        SetEnded(position.turn == attacker, position.IsInCheck(position.turn), phi, delta);
+
+        table->Store(Key(hash), depth, phi, delta, 1);
+        return;
+    }
+
+    for(int origin = 0; origin < kNumSquares; ++origin)
+    {
+        for(u64 bits = masks[origin]; bits; bits &= bits - 1)
+        {
+            Child child;
+
+            child.origin      = u8(origin);
+            child.destination = u8(LowestBit(bits));
+            child.position    = position;
+            child.position.Apply(child.origin, child.destination);
+            child.hash        = Zobrist::Hash(child.position);
+
+            Lookup(child.position, child.hash, depth - 1, child.phi, child.delta);
+
+            children.push_back(child);
+        }
+    }
+
+    while(true)
+    {
+        // a node is proven by any child that is disproven for the other team, and disproven by all of them
+
+        phi   = kInfinite;
+        delta = 0;
+
+        Child* best        = nullptr;
+        u32    secondDelta = kInfinite;
+
+        for(auto& child : children)
+        {
+            delta = SaturatingAdd(delta, child.phi);
+
+            if(child.delta < phi)
+            {
+                secondDelta = phi;
+                phi         = child.delta;
+                best        = &child;
+            }
+            else if(child.delta < secondDelta)
+            {
+                secondDelta = child.delta;
+            }
+        }
+
+        if(phi >= thresholdPhi || delta >= thresholdDelta || nodes >= budget)
+        {
+            break;
+        }
+
+        const u32 childPhi   = thresholdDelta - delta + best->phi;
+        const u32 childDelta = std::min(thresholdPhi, secondDelta + 1);
+
+        Search(best->position, best->hash, depth - 1, ply + 1, childPhi, childDelta, best->phi, best->delta);
+    }
+
+    table->Store(Key(hash), depth, phi, delta, nodes - startNodes);
+}
+
+bool MateSolver::Lookup(const BitboardPosition& position, u64 hash, int depth, u32& phi, u32& delta) const
+{
+    const bool attacking = position.turn == attacker;
+
+    if(depth <= 0)
+    {
+        // out of plies, only a mate already on the board counts and that needs the defence in check
+
+        u64 masks[kNumSquares];
+
+        const bool mated = !attacking && position.IsInCheck(position.turn) && position.GenerateLegal(masks) == 0;
+
+        SetEnded(attacking, mated, phi, delta);
+        return true;
+    }
+
+    if(table->Probe(Key(hash), depth, attacking, phi, delta))
+    {
+        return true;
+    }
+
+    // generating the moves to count them costs more than the better ordering saves
+
+    phi   = 1;
+    delta = 1;
+    return false;
+}
+
+bool MateSolver::Prove(const BitboardPosition& position, int depth, int ply)
+{
+    const u64 hash = Zobrist::Hash(position);
+
+    u32 phi, delta;
+
+    if(!Lookup(position, hash, depth, phi, delta) || (phi != 0 && delta != 0))
+    {
+        Search(position, hash, depth, ply, kInfinite, kInfinite, phi, delta);
+    }
+
+    return position.turn == attacker ? phi == 0 : delta == 0;
+}
+
+int MateSolver::ShortestMate(const BitboardPosition& position, int depth, int ply)
+{
+    for(int plies = 1; plies <= depth; plies += 2)
+    {
+        if(Prove(position, plies, ply))
+        {
+            return plies;
+        }
+    }
+
+    return -1;
+}
+
+void MateSolver::BuildLine(const BitboardPosition& position, int depth, int ply, std::vector<Move>& line)
+{
+    u64 masks[kNumSquares];
+
+    if(position.GenerateLegal(masks) == 0)
+    {
+        return;
+    }
+
+    const bool attacking = position.turn == attacker;
+
+    // the attacker takes the quickest mate, the defence the reply that delays it the most
+
+    int bestOrigin      = -1;
+    int bestDestination = -1;
+    int bestPlies       = attacking ? ShortestMate(position, depth, ply) : -1;
+
+    if(bestPlies < 0 && attacking)
+    {
+        return;
+    }
+
+    for(int origin = 0; origin < kNumSquares && !(attacking && bestOrigin >= 0); ++origin)
+    {
+        for(u64 bits = masks[origin]; bits; bits &= bits - 1)
+        {
+            const int destination = LowestBit(bits);
+
+            BitboardPosition child = position;
+            child.Apply(origin, destination);
+
+            if(attacking)
+            {
+                if(Prove(child, bestPlies - 1, ply + 1))
+                {
+                    bestOrigin      = origin;
+                    bestDestination = destination;
+                    break;
+                }
+            }
+            else
+            {
+                const int plies = ShortestMate(child, depth - 1, ply + 1);
+
+                if(plies > bestPlies)
+                {
+                    bestOrigin      = origin;
+                    bestDestination = destination;
+                    bestPlies       = plies;
+                }
+            }
+        }
+    }
+
+    if(bestOrigin < 0)
+    {
+        return;
+    }
+
+    line.push_back(position.ToMove(bestOrigin, bestDestination));
+
+    BitboardPosition next = position;
+    next.Apply(bestOrigin, bestDestination);
+
+    BuildLine(next, attacking ? bestPlies - 1 : bestPlies, ply + 1, line);
+}
+
+void MateSolver::SetEnded(bool attacking, bool mated, u32& phi, u32& delta)
+{
+    // mate is only a proof when the defence is mated, stalemate or mating the attacker is never one
+
+    const bool proven = !attacking && mated;
+
+    phi   = proven || attacking ? kInfinite : 0;
+    delta = proven || attacking ? 0 : kInfinite;
+}
+
+u64 MateSolver::Key(u64 hash) const
+{
+    return attacker == int(Piece::Team::Black) ? hash ^ kBlackAttackerKey : hash;
+}
+
+MateBatchStats SolveMates(const std::vector<BitboardPosition>& positions, const MateBatchSettings& settings,
+                          std::vector<MateSolution>& solutions, const std::function<void(const MateBatchStats&)>& callback)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    solutions.assign(positions.size(), MateSolution());
+
+    MateBatchStats   stats;
+    std::atomic<u64> next { 0 };
+    std::mutex       mutex;
+
+    RunOnThreads(settings.threads, [&](int)
+    {
+        MateSolver solver(settings.tableMegabytes);
+
+        for(u64 i = next++; i < positions.size(); i = next++)
+        {
+            solutions[i] = solver.Solve(positions[i], settings.maxMoves, settings.nodes);
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            stats.positions   += 1;
+            stats.solved      += solutions[i].moves != 0 ? 1 : 0;
+            stats.nodes       += solutions[i].nodes;
+            stats.milliseconds = u64(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+            if(callback)
+            {
+                callback(stats);
+            }
+        }
+    },
+    [&] { next = positions.size(); });
+
+    return stats;
+}
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include "move.hpp"
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Engine
+{
+
+struct MateSolution
+{
+    int moves = 0;              //!< Moves of the attacking team in the shortest forced mate, zero if none was found.
+    u64 nodes = 0;
+
+    std::vector<Move> line;     //!< Moves of both teams, with the defence holding out as long as it can.
+};
+
+//! @brief Finds forced mates for the team to move with depth-first proof-number search (df-pn).
+//!
+//! Each node has a proof and disproof number, the least number of leaves that must be shown to be mates
+//! or not for the node to be decided, stored relative to the team to move as phi and delta. The search
+//! always descends into the most proving child and only returns when the node's numbers exceed the
+//! thresholds passed down, so it needs no tree in memory, only a table of the numbers of visited nodes.
+//! The table has a fixed size and keeps the nodes that took the most work to decide when full.
+//!
+//! Mates are searched for in 1, 2 ... moves, each with a limit on the plies, as a table entry
+//! only holds for the remaining plies it was found with. Repetitions are ignored.
+class MateSolver
+{
+public:
+
+    explicit MateSolver(std::size_t megabytes);
+    ~MateSolver();
+
+    MateSolver(const MateSolver&) = delete;
+
+    //! @brief Finds the shortest mate in at most @p maxMoves moves.
+    //! @param [in] maxNodes Nodes searched before giving up, zero for no limit.
+    MateSolution Solve(const BitboardPosition& position, int maxMoves, u64 maxNodes = 0);
+    MateSolution Solve(const Board& board, int maxMoves, u64 maxNodes = 0);
+
+private:
+
+    class Table;
+    struct Child;
+
+    std::unique_ptr<Table> table;
+
+    std::vector<std::vector<Child>> stack;  //!< Children of each node on the path, indexed by ply.
+
+    int attacker = 0;
+    u64 nodes    = 0;
+    u64 budget   = 0;
+
+    //! @brief Searches until @p phi or @p delta reaches its threshold, or it runs out of budget.
+    void Search(const BitboardPosition& position, u64 hash, int depth, int ply, u32 thresholdPhi, u32 thresholdDelta, u32& phi, u32& delta);
+
+    //! @brief Numbers of a position with @p depth plies remaining, from the depth running out or the table.
+    //! @returns False if the position is not in the table, @p phi and @p delta are set to the initial estimate.
+    bool Lookup(const BitboardPosition& position, u64 hash, int depth, u32& phi, u32& delta) const;
+
+    //! @brief Whether the attacker mates from @p position within @p depth plies, searching if necessary.
+    bool Prove(const BitboardPosition& position, int depth, int ply);
+
+    //! @returns Fewest plies the attacker needs to mate from @p position to move, at most @p depth, or -1.
+    int ShortestMate(const BitboardPosition& position, int depth, int ply);
+
+    void BuildLine(const BitboardPosition& position, int depth, int ply, std::vector<Move>& line);
+
+    //! @brief Numbers of a position where the game has ended, or the plies have run out.
+    static void SetEnded(bool attacking, bool mated, u32& phi, u32& delta);
+
+    u64 Key(u64 hash) const;
+};
+
+struct MateBatchSettings
+{
+    int         maxMoves       = 3;
+    u64         nodes          = 1000000;   //!< Per position, zero for no limit.
+    std::size_t tableMegabytes = 64;        //!< Per thread.
+    int         threads        = 1;
+};
+
+struct MateBatchStats
+{
+    u64 positions    = 0;
+    u64 solved       = 0;
+    u64 nodes        = 0;
+    u64 milliseconds = 0;
+
+    u64 GetPositionsPerMinute() const { return milliseconds > 0 ? positions * 60000 / milliseconds : 0; }
+};
+
+//! @brief Solves every position, each thread taking the next unsolved position with its own MateSolver.
+//! @param [out] solutions One per position, in the same order.
+//! @param [in]  callback  Called after each position with the totals so far, from the thread that solved it
+//!                        while holding a lock.
+MateBatchStats SolveMates(const std::vector<BitboardPosition>& positions, const MateBatchSettings& settings,
+                          std::vector<MateSolution>& solutions, const std::function<void(const MateBatchStats&)>& callback = nullptr);
+
+}
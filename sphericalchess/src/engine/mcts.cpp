@@ -0,0 +1,613 @@
+#include "mcts.hpp"
+
+#include "evaluation.hpp"
+#include "evaluationparameters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <thread>
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr u32 kWin  = 1 << 16;  // score of a won playout, a loss is zero
+    constexpr u32 kDraw = kWin / 2;
+
+    constexpr int kTimeCheckInterval = 64;  // playouts between checks of the clock
+
+    //! @brief Expected result for the team an evaluation is relative to, the same scale as the Elo formula.
+    u32 EvaluationToResult(int score)
+    {
+        return u32(kWin / (1.0 + std::pow(10.0, -score / 400.0)));
+    }
+}
+
+struct Mcts::Node
+{
+    enum State : u8
+    {
+        State_unexpanded,
+        State_expanding,    //!< A thread is generating the children, others treat the node as a leaf meanwhile.
+        State_expanded,
+        State_terminal,     //!< The game has ended, terminalResult is the result.
+    };
+
+    std::atomic<u32> firstChild { 0 };
+    std::atomic<s32> visits     { 0 };  //!< Including the virtual losses of searches passing through.
+    std::atomic<u64> score      { 0 };  //!< Sum of results for the team that made the move into this node.
+    std::atomic<u8>  state      { State_unexpanded };
+
+    u16   numChildren    = 0;
+    u16   action         = 0;   //!< origin * kNumSquares + destination of the move into this node.
+    u32   terminalResult = 0;
+    float prior          = 0;
+
+    void Reset(u16 action, float prior)
+    {
+        firstChild.store(0, std::memory_order_relaxed);
+        visits.store(0, std::memory_order_relaxed);
+        score.store(0, std::memory_order_relaxed);
+        state.store(State_unexpanded, std::memory_order_relaxed);
+
+        this->numChildren    = 0;
+        this->action         = action;
+        this->terminalResult = 0;
+        this->prior          = prior;
+    }
+
+    void CopyFrom(const Node& node)
+    {
+        firstChild.store(node.firstChild.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        visits.store(node.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        score.store(node.score.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        state.store(node.state.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        numChildren    = node.numChildren;
+        action         = node.action;
+        terminalResult = node.terminalResult;
+        prior          = node.prior;
+    }
+
+    int Origin()      const { return action / kNumSquares; }
+    int Destination() const { return action % kNumSquares; }
+
+    //! @returns Average result, or @p unvisited if there have been no visits.
+    float Value(float unvisited) const
+    {
+        const s32 n = visits.load(std::memory_order_relaxed);
+
+        return n > 0 ? float(double(score.load(std::memory_order_relaxed)) / (double(n) * kWin)) : unvisited;
+    }
+};
+
+class Mcts::Worker
+{
+public:
+
+    Worker(Mcts& mcts, int id) : mcts(mcts), random(mcts.settings.seed + mcts.runs * 65537 + u32(id))
+    {
+    }
+
+    //! @brief Runs playouts until the search is stopped.
+    void Run();
+
+private:
+
+    Mcts& mcts;
+
+    std::mt19937     random;
+    std::vector<u32> path;
+    u64              masks[kNumSquares];
+
+    void Playout();
+
+    //! @returns Index of the child to descend into.
+    u32 Select(const Node& node) const;
+
+    //! @brief Generates the children of @p node, which this thread has marked as expanding.
+    //! @returns The new state of the node, unexpanded again if the pool is full.
+    Node::State Expand(Node& node, const BitboardPosition& position);
+
+    //! @returns Result of @p position for its team to move.
+    u32 Simulate(BitboardPosition position);
+
+    //! @returns The square index of the @p n-th move in masks, with the origin in @p origin.
+    int FindMove(int n, int& origin) const;
+};
+
+void Mcts::Worker::Run()
+{
+    path.reserve(256);
+
+    for(int i = 1; !mcts.stopped.load(std::memory_order_relaxed); ++i)
+    {
+        Playout();
+
+        const u64 playouts = mcts.playouts.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        if(mcts.limits.playouts != 0 && playouts >= mcts.limits.playouts)
+        {
+            mcts.Stop();
+        }
+
+        if(mcts.limits.milliseconds != 0 && i % kTimeCheckInterval == 0 && mcts.ElapsedMilliseconds() >= mcts.limits.milliseconds)
+        {
+            mcts.Stop();
+        }
+    }
+}
+
+void Mcts::Worker::Playout()
+{
+    const int virtualLoss = mcts.settings.virtualLoss;
+
+    BitboardPosition position = mcts.root;
+
+    path.clear();
+
+    u32 index  = 0;
+    u32 result = 0; // for the team that moved into the last node of the path
+
+    while(true)
+    {
+        Node& node = mcts.nodes[index];
+
+        path.push_back(index);
+        node.visits.fetch_add(virtualLoss, std::memory_order_relaxed);
+
+        u8 state = node.state.load(std::memory_order_acquire);
+
+        if(state != Node::State_expanded)
+        {
+            u8 expected = Node::State_unexpanded;
+
+            if(state == Node::State_unexpanded && !mcts.full.load(std::memory_order_relaxed) &&
+               node.state.compare_exchange_strong(expected, Node::State_expanding, std::memory_order_acquire))
+            {
+                state = Expand(node, position);
+            }
+
+            result = state == Node::State_terminal ? node.terminalResult : kWin - Simulate(position);
+            break;
+        }
+
+        index = Select(node);
+
+        const Node& child = mcts.nodes[index];
+        position.Apply(child.Origin(), child.Destination());
+    }
+
+    // back up, alternating between the teams
+
+    for(auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        Node& node = mcts.nodes[*it];
+
+        node.score.fetch_add(result, std::memory_order_relaxed);
+        node.visits.fetch_add(1 - virtualLoss, std::memory_order_relaxed);
+
+        result = kWin - result;
+    }
+}
+
+u32 Mcts::Worker::Select(const Node& node) const
+{
+    const u32   first  = node.firstChild.load(std::memory_order_relaxed);
+    const float c      = mcts.settings.exploration;
+    const float parent = float(std::max(node.visits.load(std::memory_order_relaxed), 1));
+
+    u32   best      = first;
+    float bestValue = -1e30f;
+
+    if(mcts.settings.selection == MctsSettings::Selection::Uct)
+    {
+        const float logParent = std::log(parent);
+
+        for(u32 i = first; i < first + node.numChildren; ++i)
+        {
+            const Node& child = mcts.nodes[i];
+            const s32   n     = child.visits.load(std::memory_order_relaxed);
+
+            if(n <= 0)
+            {
+                return i;
+            }
+
+            const float value = child.Value(0) + c * std::sqrt(logParent / float(n));
+
+            if(value > bestValue)
+            {
+                best      = i;
+                bestValue = value;
+            }
+        }
+    }
+    else
+    {
+        // unvisited children are assumed as good as the parent, for the team choosing between them
+
+        const float sqrtParent = std::sqrt(parent);
+        const float unvisited  = 1 - node.Value(0.5f);
+
+        for(u32 i = first; i < first + node.numChildren; ++i)
+        {
+            const Node& child = mcts.nodes[i];
+            const s32   n     = child.visits.load(std::memory_order_relaxed);
+
+            const float value = child.Value(unvisited) + c * child.prior * sqrtParent / float(1 + n);
+
+            if(value > bestValue)
+            {
+                best      = i;
+                bestValue = value;
+            }
+        }
+    }
+
+    return best;
+}
+
+Mcts::Node::State Mcts::Worker::Expand(Node& node, const BitboardPosition& position)
+{
+    const int count = position.GenerateLegal(masks);
+
+    if(count == 0)
+    {
+        // checkmate is a win for the team that just moved
+
+        node.terminalResult = position.IsInCheck(position.turn) ? kWin : kDraw;
+        node.state.store(Node::State_terminal, std::memory_order_release);
+
+        return Node::State_terminal;
+    }
+
+    // only claimed when they fit, so numNodes stays the number of nodes in use once the pool is full
+
+    u32 first = mcts.numNodes.load(std::memory_order_relaxed);
+
+    do
+    {
+        if(u64(first) + u64(count) > mcts.settings.maxNodes)
+        {
+            mcts.full.store(true, std::memory_order_relaxed);
+            node.state.store(Node::State_unexpanded, std::memory_order_release);
+
+            return Node::State_unexpanded;
+        }
+    }
+    while(!mcts.numNodes.compare_exchange_weak(first, first + u32(count), std::memory_order_relaxed));
+
+    const bool puct = mcts.settings.selection == MctsSettings::Selection::Puct;
+    const int  them = 1 - position.turn;
+
+    float total = 0;
+    u32   index = first;
+
+    for(int origin = 0; origin < kNumSquares; ++origin)
+    {
+        for(u64 bits = masks[origin]; bits; bits &= bits - 1)
+        {
+            const int destination = LowestBit(bits);
+
+            float weight = 1;
+
+            if(puct)
+            {
+                // no policy to learn priors from, so captures and upgrades get more weight by material won
+
+                const int victim = position.TypeAt(them, destination);
+
+                weight = float(Parameters::kPieceValue[0]);
+
+                if(victim >= 0)
+                {
+                    weight += float(Parameters::kPieceValue[victim]);
+                }
+
+                if(position.ToMove(origin, destination).IsUpgrade())
+                {
+                    weight += float(Parameters::kPieceValue[int(Piece::Type::Queen)]);
+                }
+            }
+
+            mcts.nodes[index++].Reset(u16(origin * kNumSquares + destination), weight);
+            total += weight;
+        }
+    }
+
+    for(u32 i = first; i < index; ++i)
+    {
+        mcts.nodes[i].prior /= total;
+    }
+
+    node.numChildren = u16(count);
+    node.firstChild.store(first, std::memory_order_relaxed);
+    node.state.store(Node::State_expanded, std::memory_order_release);
+
+    return Node::State_expanded;
+}
+
+u32 Mcts::Worker::Simulate(BitboardPosition position)
+{
+    const u8 team = position.turn;
+
+    if(mcts.settings.leaf == MctsSettings::Leaf::Playout)
+    {
+        for(int ply = 0; ply < mcts.settings.playoutPlies; ++ply)
+        {
+            const int count = position.GenerateLegal(masks);
+
+            if(count == 0)
+            {
+                if(!position.IsInCheck(position.turn))
+                {
+                    return kDraw;
+                }
+
+                return position.turn == team ? 0 : kWin;
+            }
+
+            int origin;
+            const int destination = FindMove(int(random() % u32(count)), origin);
+
+            position.Apply(origin, destination);
+        }
+    }
+
+    const u32 result = EvaluationToResult(Evaluate(position));
+
+    return position.turn == team ? result : kWin - result;
+}
+
+int Mcts::Worker::FindMove(int n, int& origin) const
+{
+    for(origin = 0; origin < kNumSquares; ++origin)
+    {
+        for(u64 bits = masks[origin]; bits; bits &= bits - 1)
+        {
+            if(n-- == 0)
+            {
+                return LowestBit(bits);
+            }
+        }
+    }
+
+    return -1;
+}
+
+Mcts::Mcts(const MctsSettings& settings) : settings(settings), nodes(new Node[std::max(settings.maxNodes, 1u)])
+{
+    this->settings.maxNodes = std::max(settings.maxNodes, 1u);
+}
+
+Mcts::~Mcts() = default;
+
+void Mcts::Clear()
+{
+    numNodes.store(0, std::memory_order_relaxed);
+    full.store(false, std::memory_order_relaxed);
+}
+
+MctsInfo Mcts::Run(const Board& board, const MctsLimits& limits)
+{
+    BitboardPosition position;
+    position.FromBoard(board);
+
+    Reuse(position);
+
+    MctsInfo info;
+    info.reusedNodes = numNodes.load(std::memory_order_relaxed) - 1;
+
+    u64 masks[kNumSquares];
+
+    if(position.GenerateLegal(masks) == 0)
+    {
+        return info;
+    }
+
+    this->limits = limits;
+    this->start  = Clock::now();
+
+    stopped.store(false, std::memory_order_relaxed);
+    playouts.store(0, std::memory_order_relaxed);
+    ++runs;
+
+    const int numThreads = std::max(limits.threads, 1);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread>             threads;
+
+    for(int i = 0; i < numThreads; ++i)
+    {
+        workers.emplace_back(new Worker(*this, i));
+    }
+
+    for(int i = 1; i < numThreads; ++i)
+    {
+        threads.emplace_back(&Worker::Run, workers[i].get());
+    }
+
+    workers[0]->Run();
+
+    Stop();
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    info.playouts     = playouts.load(std::memory_order_relaxed);
+    info.milliseconds = ElapsedMilliseconds();
+    info.nodes        = numNodes.load(std::memory_order_relaxed);
+
+    // most visited line
+
+    u32 index = 0;
+
+    while(nodes[index].state.load(std::memory_order_relaxed) == Node::State_expanded)
+    {
+        const Node& node  = nodes[index];
+        const u32   first = node.firstChild.load(std::memory_order_relaxed);
+
+        u32 best = first;
+
+        for(u32 i = first; i < first + node.numChildren; ++i)
+        {
+            if(nodes[i].visits.load(std::memory_order_relaxed) > nodes[best].visits.load(std::memory_order_relaxed))
+            {
+                best = i;
+            }
+        }
+
+        if(nodes[best].visits.load(std::memory_order_relaxed) == 0)
+        {
+            break;
+        }
+
+        if(index == 0)
+        {
+            info.value = nodes[best].Value(0.5f);
+        }
+
+        info.moves.push_back(position.ToMove(nodes[best].Origin(), nodes[best].Destination()));
+        position.Apply(nodes[best].Origin(), nodes[best].Destination());
+
+        index = best;
+    }
+
+    return info;
+}
+
+void Mcts::Reuse(const BitboardPosition& position)
+{
+    if(numNodes.load(std::memory_order_relaxed) != 0)
+    {
+        if(position == root)
+        {
+            return;
+        }
+
+        // the opponent's reply to our move is usually two plies down, but any child or grandchild will do
+
+        const Node& node = nodes[0];
+
+        if(node.state.load(std::memory_order_relaxed) == Node::State_expanded)
+        {
+            const u32 first = node.firstChild.load(std::memory_order_relaxed);
+
+            for(u32 i = first; i < first + node.numChildren; ++i)
+            {
+                BitboardPosition child = root;
+                child.Apply(nodes[i].Origin(), nodes[i].Destination());
+
+                if(child == position)
+                {
+                    Reroot(i, position);
+                    return;
+                }
+
+                if(nodes[i].state.load(std::memory_order_relaxed) != Node::State_expanded)
+                {
+                    continue;
+                }
+
+                const u32 grandchildren = nodes[i].firstChild.load(std::memory_order_relaxed);
+
+                for(u32 j = grandchildren; j < grandchildren + nodes[i].numChildren; ++j)
+                {
+                    BitboardPosition grandchild = child;
+                    grandchild.Apply(nodes[j].Origin(), nodes[j].Destination());
+
+                    if(grandchild == position)
+                    {
+                        Reroot(j, position);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    root = position;
+
+    nodes[0].Reset(0, 1);
+    numNodes.store(1, std::memory_order_relaxed);
+    full.store(false, std::memory_order_relaxed);
+}
+
+void Mcts::Reroot(u32 index, const BitboardPosition& position)
+{
+    // Blocks of children are moved in order of their old index. A block is always after its parent
+    // and everything placed before it had a lower old index, so it only ever moves down over nodes
+    // that are no longer needed.
+
+    struct Block
+    {
+        u32 first;
+        u32 count;
+        u32 parent; //!< New index of the node the block belongs to.
+
+        bool operator > (const Block& block) const { return first > block.first; }
+    };
+
+    std::priority_queue<Block, std::vector<Block>, std::greater<Block>> blocks;
+
+    auto PushChildren = [&](u32 parent)
+    {
+        if(nodes[parent].state.load(std::memory_order_relaxed) == Node::State_expanded)
+        {
+            blocks.push({ nodes[parent].firstChild.load(std::memory_order_relaxed), nodes[parent].numChildren, parent });
+        }
+    };
+
+    nodes[0].CopyFrom(nodes[index]);
+    PushChildren(0);
+
+    u32 next = 1;
+
+    while(!blocks.empty())
+    {
+        const Block block = blocks.top();
+        blocks.pop();
+
+        for(u32 i = 0; i < block.count; ++i)
+        {
+            if(next + i != block.first + i)
+            {
+                nodes[next + i].CopyFrom(nodes[block.first + i]);
+            }
+        }
+
+        nodes[block.parent].firstChild.store(next, std::memory_order_relaxed);
+
+        for(u32 i = 0; i < block.count; ++i)
+        {
+            PushChildren(next + i);
+        }
+
+        next += block.count;
+    }
+
+    root = position;
+
+    // the tree can grow again if anything was left behind
+
+    if(next < numNodes.load(std::memory_order_relaxed))
+    {
+        full.store(false, std::memory_order_relaxed);
+    }
+
+    numNodes.store(next, std::memory_order_relaxed);
+}
+
+int Mcts::ElapsedMilliseconds() const
+{
+    return int(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+}
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include "move.hpp"
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace Engine
+{
+
+struct MctsSettings
+{
+    enum class Selection
+    {
+        Uct,    //!< Upper confidence bound of every child, unvisited children first.
+        Puct,   //!< Exploration weighted by a prior per move, favoring captures and upgrades.
+    };
+
+    enum class Leaf
+    {
+        Playout,    //!< Random moves until the game ends or playoutPlies, scored by Evaluate() if it hasn't ended.
+        Evaluate,   //!< Evaluate() of the leaf itself.
+    };
+
+    u32       maxNodes     = 1 << 20;   //!< Size of the node pool, the tree stops growing once it is full.
+    Selection selection    = Selection::Uct;
+    Leaf      leaf         = Leaf::Playout;
+    float     exploration  = 1.4f;
+    int       virtualLoss  = 3;         //!< Losses added to each node on the way down, so threads spread out over the tree.
+    int       playoutPlies = 100;
+    u32       seed         = 0;
+};
+
+struct MctsLimits
+{
+    u64 playouts     = 0;   //!< Total playouts of all threads, zero for no limit.
+    int milliseconds = 0;   //!< Zero for no limit.
+    int threads      = 1;
+};
+
+struct MctsInfo
+{
+    u64   playouts     = 0;
+    int   milliseconds = 0;
+    u32   nodes        = 0;     //!< Nodes in the tree at the end of the search.
+    u32   reusedNodes  = 0;     //!< Nodes kept from the previous search.
+    float value        = 0.5f;  //!< Expected result of the best move for the team to move, a win is one.
+
+    std::vector<Move> moves;    //!< Most visited line, empty if there is no legal move.
+
+    u64 PlayoutsPerSecond() const { return milliseconds > 0 ? playouts * 1000 / milliseconds : playouts * 1000; }
+};
+
+//! @brief Monte Carlo tree search of a Board.
+//!
+//! Nodes come from a fixed pool allocated up front and the children of a node are a contiguous block in it,
+//! so threads grow the tree by bumping a shared counter. Threads search the same tree, with virtual losses
+//! keeping them off each other's paths and a flag per node so only one thread expands it.
+//! Positions are BitboardPositions replayed from the root, nodes only store the move leading to them.
+//! When the board given to Run() is the root or is found within two plies of it, that subtree is moved
+//! to the front of the pool and kept, otherwise the tree starts over. Repetitions are not detected.
+class Mcts
+{
+public:
+
+    explicit Mcts(const MctsSettings& settings);
+    ~Mcts();
+
+    Mcts(const Mcts&) = delete;
+
+    //! @brief Searches @p board until one of the @p limits is reached or Stop() is called.
+    MctsInfo Run(const Board& board, const MctsLimits& limits);
+
+    //! @brief Stops a search running on another thread, can be called at any time.
+    void Stop() { stopped.store(true, std::memory_order_relaxed); }
+
+    //! @brief Forgets the tree, the next search starts over.
+    void Clear();
+
+private:
+
+    struct Node;
+    class  Worker;
+
+    using Clock = std::chrono::steady_clock;
+
+    MctsSettings            settings;
+    std::unique_ptr<Node[]> nodes;
+    std::atomic<u32>        numNodes { 0 };         //!< In use, never more than maxNodes.
+    std::atomic<bool>       full     { false };     //!< An expansion didn't fit, until rerooting frees nodes.
+    BitboardPosition        root;
+
+    MctsLimits        limits;
+    Clock::time_point start;
+    u32               runs = 0;
+
+    std::atomic<bool> stopped  { false };
+    std::atomic<u64>  playouts { 0 };
+
+    //! @brief Makes the node at @p index the root, compacting its subtree to the front of the pool.
+    void Reroot(u32 index, const BitboardPosition& position);
+
+    //! @brief Keeps as much of the tree as possible for a search of @p position.
+    void Reuse(const BitboardPosition& position);
+
+    int ElapsedMilliseconds() const;
+};
+
+}
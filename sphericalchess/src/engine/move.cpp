@@ -0,0 +1,108 @@
+#include "move.hpp"
+
+namespace Engine
+{
+
+Move Move::FromAction(const Piece::Action& action)
+{
+    u16 data = u16(SquareIndex(action.origin) | (SquareIndex(action.destination) << 6));
+
+    if(action.type & Piece::Action::TypeBit_upgrade)
+    {
+        data |= Flag_upgrade;
+    }
+
+    if(action.type & Piece::Action::TypeBit_castle)
+    {
+        data |= Flag_castle;
+
+        if(action.additional.origin.x == Board::kDimension - 1)
+        {
+            data |= Flag_rookHigh;
+        }
+    }
+
+    return Move(data);
+}
+
+const Piece::Action* Move::FindAction(Move move, const Piece::ActionCollection& actions)
+{
+    for(auto& action : actions)
+    {
+        if(FromAction(action) == move)
+        {
+            return &action;
+        }
+    }
+
+    return nullptr;
+}
+
+bool Move::Parse(const std::string& text, Move& output)
+{
+    if(text.size() < 4 || text.size() > 5)
+    {
+        return false;
+    }
+
+    auto ParseSquare = [](char column, char row, int& square)
+    {
+        if(!Util::InRange(column, 'a', char('a' + Board::kDimension)) || !Util::InRange(row, '1', char('1' + Board::kDimension)))
+        {
+            return false;
+        }
+
+        square = SquareIndex(Vec2i(column - 'a', row - '1'));
+        return true;
+    };
+
+    int origin;
+    int destination;
+
+    if(!ParseSquare(text[0], text[1], origin) || !ParseSquare(text[2], text[3], destination) || origin == destination)
+    {
+        return false;
+    }
+
+    u16 data = u16(origin | (destination << 6));
+
+    if(text.size() == 5)
+    {
+        switch(text[4])
+        {
+        case 'q': data |= Flag_upgrade;                 break;
+        case 'a': data |= Flag_castle;                  break;
+        case 'h': data |= Flag_castle | Flag_rookHigh;  break;
+        default:  return false;
+        }
+    }
+
+    output = Move(data);
+
+    return true;
+}
+
+std::string Move::ToString() const
+{
+    const Vec2i origin      = Origin();
+    const Vec2i destination = Destination();
+
+    std::string text =
+    {
+        char('a' + origin.x),      char('1' + origin.y),
+        char('a' + destination.x), char('1' + destination.y),
+    };
+
+    if(IsUpgrade())
+    {
+        text.push_back('q');
+    }
+    else if(IsCastle())
+    {
+        text.push_back((data & Flag_rookHigh) ? 'h' : 'a');
+    }
+
+    return text;
+}
+
+}
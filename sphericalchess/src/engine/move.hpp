@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../game/piece.hpp"
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+#include <string>
+
+//! Contains the computer player, searching and analysis of a Board.
+namespace Engine
+{
+
+//! @brief Index of a square on the Board, in the range [0, 64).
+inline int SquareIndex(const Vec2i& position)
+{
+    return position.y * Board::kDimension + position.x;
+}
+
+inline Vec2i SquarePosition(int index)
+{
+    return Vec2i(index % Board::kDimension, index / Board::kDimension);
+}
+
+//! @brief Compact 16-bit encoding of a Piece::Action.
+//!
+//! Only stores what is needed to pick the action out of the list of legal actions
+//! for a position, the remaining state (captured piece, rook position) is recovered from the Board.
+//!
+//! | Bits  | Meaning                                       |
+//! |-------|-----------------------------------------------|
+//! | 0-5   | Origin square index.                          |
+//! | 6-11  | Destination square index.                     |
+//! | 12    | Upgrade to queen.                             |
+//! | 13    | Castle.                                       |
+//! | 14    | Castle uses the rook at x = kDimension - 1.   |
+class Move
+{
+public:
+
+    enum Flag : u16
+    {
+        Flag_upgrade  = 1 << 12,
+        Flag_castle   = 1 << 13,
+        Flag_rookHigh = 1 << 14,
+    };
+
+    Move() = default;
+
+    explicit Move(u16 data) : data(data)
+    {
+    }
+
+    static Move FromAction(const Piece::Action& action);
+
+    //! @brief Finds the action @p move represents in @p actions.
+    //! @returns Pointer into @p actions, nullptr when no action matches.
+    static const Piece::Action* FindAction(Move move, const Piece::ActionCollection& actions);
+
+    //! @brief Parses coordinate notation written by ToString().
+    //! @returns False if @p text is not a well formed move, it is not checked against any board.
+    static bool Parse(const std::string& text, Move& output);
+
+    //! @brief Coordinate notation, columns a-h and rows 1-8, eg. "b1c3".
+    //!
+    //! An upgrade is followed by 'q', a castle by the column of the rook as there can be two
+    //! castles with the same king move when the rooks can pass around the back of the sphere, eg. "e1g1h".
+    std::string ToString() const;
+
+    Vec2i Origin()      const { return SquarePosition(data & 63); }
+    Vec2i Destination() const { return SquarePosition((data >> 6) & 63); }
+
+    bool IsUpgrade() const { return (data & Flag_upgrade) != 0; }
+    bool IsCastle()  const { return (data & Flag_castle)  != 0; }
+
+    u16 GetData() const { return data; }
+
+    explicit operator bool() const { return data != 0; }
+
+    bool operator == (Move move) const { return data == move.data; }
+    bool operator != (Move move) const { return data != move.data; }
+
+private:
+
+    u16 data = 0; // a move can never have the same origin and destination, zero is never a valid move
+};
+
+}
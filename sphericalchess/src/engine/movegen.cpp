@@ -0,0 +1,76 @@
+#include "movegen.hpp"
+
+namespace Engine
+{
+
+bool IsInCheck(const Board& board, Piece::Team team)
+{
+    Vec2i kingPosition;
+
+    if(!board.FindAnyPiece(Piece::Type::King, team, kingPosition))
+    {
+        return false;
+    }
+
+    for(int i = 0; i < Board::kDimension; ++i)
+    {
+        for(int j = 0; j < Board::kDimension; ++j)
+        {
+            if(auto& piece = board.PieceAt(i, j))
+            {
+                if(piece.GetTeam() != team && piece.CanCaptureDestination(board, Vec2i(i, j), kingPosition))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void GeneratePseudoLegalActions(const Board& board, Piece::ActionCollection& output)
+{
+    const Piece::Team team = board.GetCurrentTeamTurn();
+
+    for(int i = 0; i < Board::kDimension; ++i)
+    {
+        for(int j = 0; j < Board::kDimension; ++j)
+        {
+            if(auto& piece = board.PieceAt(i, j))
+            {
+                if(piece.GetTeam() == team)
+                {
+                    auto actions = piece.CalculatePossibleActions(board, Vec2i(i, j));
+
+                    output.insert(output.end(), actions.begin(), actions.end());
+                }
+            }
+        }
+    }
+}
+
+void GenerateLegalActions(Board& board, Piece::ActionCollection& output)
+{
+    const Piece::Team team = board.GetCurrentTeamTurn();
+
+    Piece::ActionCollection actions;
+
+    GeneratePseudoLegalActions(board, actions);
+
+    for(auto& action : actions)
+    {
+        board.DoAction(action);
+
+        bool inCheck = IsInCheck(board, team);
+
+        board.UndoAction();
+
+        if(!inCheck)
+        {
+            output.push_back(action);
+        }
+    }
+}
+
+}
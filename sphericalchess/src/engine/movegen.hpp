@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../game/board.hpp"
+#include "../game/piece.hpp"
+
+namespace Engine
+{
+
+//! @brief Checks if the king of @p team can be captured by any piece of the opposing team.
+//! @returns False if @p team has no king on the board.
+bool IsInCheck(const Board& board, Piece::Team team);
+
+//! @brief Appends every action of the current team's pieces to @p output, including those that leave its own king in check.
+void GeneratePseudoLegalActions(const Board& board, Piece::ActionCollection& output);
+
+//! @brief Appends every action of the current team that does not leave its own king in check to @p output.
+//! @remarks The board is temporarily modified to test each action but is restored before returning.
+void GenerateLegalActions(Board& board, Piece::ActionCollection& output);
+
+}
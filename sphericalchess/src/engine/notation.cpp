@@ -0,0 +1,572 @@
+#include "notation.hpp"
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr int kPawn = int(Piece::Type::Pawn);
+    constexpr int kRook = int(Piece::Type::Rook);
+    constexpr int kKing = int(Piece::Type::King);
+
+    constexpr int kKingColumn = Board::kDimension / 2;
+
+    constexpr char kLetters[2][kNumTypes + 1] = { "PBNRQK", "pbnrqk" };
+
+    constexpr u64 kEndRows = 0xFF000000000000FFull;     //!< Rows 1 and 8, where there are never pawns.
+
+    u64 Bit(int square) { return u64(1) << square; }
+
+    int Column(int square) { return square % Board::kDimension; }
+    int Row   (int square) { return square / Board::kDimension; }
+
+    int BackRow    (int team) { return team == 0 ? 0 : Board::kDimension - 1; }
+    int SkippedRow (int team) { return team == 0 ? 2 : Board::kDimension - 3; }
+    int Forward    (int team) { return team == 0 ? 1 : -1; }
+
+    bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    bool IsColumn(char c) { return c >= 'a' && c < 'a' + Board::kDimension; }
+    bool IsRow   (char c) { return c >= '1' && c < '1' + Board::kDimension; }
+
+    //! @returns Piece::Team * kNumTypes + Piece::Type of a piece letter, or -1.
+    int PieceIndex(char c)
+    {
+        switch(c)
+        {
+        case 'P': return 0;
+        case 'B': return 1;
+        case 'N': return 2;
+        case 'R': return 3;
+        case 'Q': return 4;
+        case 'K': return 5;
+        case 'p': return kNumTypes + 0;
+        case 'b': return kNumTypes + 1;
+        case 'n': return kNumTypes + 2;
+        case 'r': return kNumTypes + 3;
+        case 'q': return kNumTypes + 4;
+        case 'k': return kNumTypes + 5;
+        default:  return -1;
+        }
+    }
+
+    //! @brief Moves @p text past spaces and tabs.
+    //! @returns False if there were none, as a field must be followed by one.
+    bool SkipSpaces(const char*& text, const char* end)
+    {
+        const char* start = text;
+
+        while(text != end && (*text == ' ' || *text == '\t'))
+        {
+            ++text;
+        }
+
+        return text != start;
+    }
+
+    bool ParseNumber(const char*& text, const char* end)
+    {
+        const char* start = text;
+
+        while(text != end && *text >= '0' && *text <= '9')
+        {
+            ++text;
+        }
+
+        return text != start;
+    }
+
+    char* WriteSquare(char* output, int square)
+    {
+        output[0] = char('a' + Column(square));
+        output[1] = char('1' + Row(square));
+
+        return output + 2;
+    }
+}
+
+std::size_t FormatPosition(const BitboardPosition& position, char* output)
+{
+    char* text = output;
+
+    char squares[kNumSquares] = {};
+
+    for(int team = 0; team < 2; ++team)
+    {
+        for(int type = 0; type < kNumTypes; ++type)
+        {
+            for(u64 bits = position.pieces[team][type]; bits; bits &= bits - 1)
+            {
+                squares[LowestBit(bits)] = kLetters[team][type];
+            }
+        }
+    }
+
+    for(int y = Board::kDimension - 1; y >= 0; --y)
+    {
+        int empty = 0;
+
+        for(int x = 0; x < Board::kDimension; ++x)
+        {
+            const char letter = squares[y * Board::kDimension + x];
+
+            if(letter == 0)
+            {
+                ++empty;
+                continue;
+            }
+
+            if(empty > 0)
+            {
+                *text++ = char('0' + empty);
+                empty   = 0;
+            }
+
+            *text++ = letter;
+        }
+
+        if(empty > 0)
+        {
+            *text++ = char('0' + empty);
+        }
+
+        *text++ = y > 0 ? '/' : ' ';
+    }
+
+    *text++ = position.turn == 0 ? 'w' : 'b';
+    *text++ = ' ';
+
+    char* const castling = text;
+
+    for(int team = 0; team < 2; ++team)
+    {
+        const u64 castlers = position.unmoved & (position.pieces[team][kKing] | position.pieces[team][kRook]);
+
+        for(int x = 0; x < Board::kDimension; ++x)
+        {
+            if(castlers & Bit(BackRow(team) * Board::kDimension + x))
+            {
+                *text++ = char((team == 0 ? 'A' : 'a') + x);
+            }
+        }
+    }
+
+    if(text == castling)
+    {
+        *text++ = '-';
+    }
+
+    *text++ = ' ';
+
+    if(position.enPassant >= 0)
+    {
+        text = WriteSquare(text, position.enPassant - Forward(position.turn ^ 1) * Board::kDimension);
+    }
+    else
+    {
+        *text++ = '-';
+    }
+
+    *text = 0;
+
+    return std::size_t(text - output);
+}
+
+bool ParsePosition(const char* text, std::size_t size, BitboardPosition& position)
+{
+    const char* const end = text + size;
+
+    BitboardPosition result;
+
+    // pieces, row by row from black's pole
+
+    int x = 0;
+    int y = Board::kDimension - 1;
+
+    for(; text != end && !IsSpace(*text); ++text)
+    {
+        const char c = *text;
+
+        if(c == '/')
+        {
+            if(x != Board::kDimension || y == 0)
+            {
+                return false;
+            }
+
+            x = 0;
+            --y;
+        }
+        else if(c >= '1' && c <= '8')
+        {
+            x += c - '0';
+
+            if(x > Board::kDimension)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            const int index = PieceIndex(c);
+
+            if(index < 0 || x == Board::kDimension)
+            {
+                return false;
+            }
+
+            result.pieces[index / kNumTypes][index % kNumTypes] |= Bit(y * Board::kDimension + x);
+            ++x;
+        }
+    }
+
+    if(x != Board::kDimension || y != 0 || !SkipSpaces(text, end) || text == end)
+    {
+        return false;
+    }
+
+    // turn
+
+    if(*text != 'w' && *text != 'b')
+    {
+        return false;
+    }
+
+    result.turn = *text++ == 'w' ? 0 : 1;
+
+    if(!SkipSpaces(text, end) || text == end)
+    {
+        return false;
+    }
+
+    // castling
+
+    if(*text == '-')
+    {
+        ++text;
+    }
+    else
+    {
+        for(; text != end && !IsSpace(*text); ++text)
+        {
+            const bool white = *text >= 'A' && *text < 'A' + Board::kDimension;
+
+            if(!white && !IsColumn(*text))
+            {
+                return false;
+            }
+
+            const int team   = white ? 0 : 1;
+            const int square = BackRow(team) * Board::kDimension + (*text - (white ? 'A' : 'a'));
+
+            if(!((result.pieces[team][kKing] | result.pieces[team][kRook]) & Bit(square)))
+            {
+                return false;
+            }
+
+            result.unmoved |= Bit(square);
+        }
+    }
+
+    if(!SkipSpaces(text, end) || text == end)
+    {
+        return false;
+    }
+
+    // en passant, given as the square passed over like FEN but kept as the square of the pawn
+
+    if(*text == '-')
+    {
+        ++text;
+    }
+    else
+    {
+        if(end - text < 2 || !IsColumn(text[0]) || !IsRow(text[1]))
+        {
+            return false;
+        }
+
+        const int mover   = result.turn ^ 1;
+        const int skipped = (text[1] - '1') * Board::kDimension + (text[0] - 'a');
+        const int pawn    = skipped + Forward(mover) * Board::kDimension;
+        const int origin  = skipped - Forward(mover) * Board::kDimension;
+
+        const u64 occupancy = result.GetOccupancy();
+
+        if(Row(skipped) != SkippedRow(mover) || !(result.pieces[mover][kPawn] & Bit(pawn)) || (occupancy & (Bit(skipped) | Bit(origin))))
+        {
+            return false;
+        }
+
+        result.enPassant = s8(pawn);
+        text += 2;
+    }
+
+    // the move counters of FEN, if any
+
+    for(int i = 0; i < 2 && SkipSpaces(text, end) && ParseNumber(text, end); ++i)
+    {
+    }
+
+    for(; text != end; ++text)
+    {
+        if(!IsSpace(*text))
+        {
+            return false;
+        }
+    }
+
+    for(int team = 0; team < 2; ++team)
+    {
+        const u64 king = result.pieces[team][kKing];
+
+        if(king == 0 || (king & (king - 1)) != 0 || (result.pieces[team][kPawn] & kEndRows))
+        {
+            return false;
+        }
+    }
+
+    // the team that just moved can't have left its king in check
+
+    if(result.IsInCheck(result.turn ^ 1))
+    {
+        return false;
+    }
+
+    position = result;
+
+    return true;
+}
+
+std::size_t FormatMove(const BitboardPosition& position, const u64 masks[kNumSquares], Move move, char* output)
+{
+    char* text = output;
+
+    const int origin      = move.GetData() & 63;
+    const int destination = (move.GetData() >> 6) & 63;
+    const int type        = position.TypeAt(position.turn, origin);
+
+    move = position.ToMove(origin, destination);
+
+    if(move.IsCastle())
+    {
+        const char* castle = Column(destination) > Column(origin) ? "O-O" : "O-O-O";
+
+        while(*castle)
+        {
+            *text++ = *castle++;
+        }
+    }
+    else
+    {
+        const bool capture = position.TypeAt(position.turn ^ 1, destination) >= 0 || (type == kPawn && Column(origin) != Column(destination));
+
+        if(type == kPawn)
+        {
+            if(capture)
+            {
+                *text++ = char('a' + Column(origin));
+            }
+        }
+        else
+        {
+            *text++ = kLetters[0][type];
+
+            // the other pieces of the type that can move there, by any route
+
+            bool ambiguous = false;
+            bool sameRow   = false;
+            bool sameFile  = false;
+
+            for(u64 bits = position.pieces[position.turn][type] & ~Bit(origin); bits; bits &= bits - 1)
+            {
+                const int other = LowestBit(bits);
+
+                if(masks[other] & Bit(destination))
+                {
+                    ambiguous  = true;
+                    sameFile  |= Column(other) == Column(origin);
+                    sameRow   |= Row(other) == Row(origin);
+                }
+            }
+
+            if(ambiguous && (!sameFile || sameRow))
+            {
+                *text++ = char('a' + Column(origin));
+            }
+
+            if(ambiguous && sameFile)
+            {
+                *text++ = char('1' + Row(origin));
+            }
+        }
+
+        if(capture)
+        {
+            *text++ = 'x';
+        }
+
+        text = WriteSquare(text, destination);
+
+        if(move.IsUpgrade())
+        {
+            *text++ = '=';
+            *text++ = 'Q';
+        }
+    }
+
+    BitboardPosition next = position;
+    next.Apply(origin, destination);
+
+    if(next.IsInCheck(next.turn))
+    {
+        u64 nextMasks[kNumSquares];
+
+        *text++ = next.GenerateLegal(nextMasks) == 0 ? '#' : '+';
+    }
+
+    *text = 0;
+
+    return std::size_t(text - output);
+}
+
+bool ParseMove(const BitboardPosition& position, const u64 masks[kNumSquares], const char* text, std::size_t size, Move& move)
+{
+    const char* end = text + size;
+
+    while(text != end && IsSpace(*text))
+    {
+        ++text;
+    }
+
+    while(end != text && (IsSpace(end[-1]) || end[-1] == '+' || end[-1] == '#' || end[-1] == '!' || end[-1] == '?'))
+    {
+        --end;
+    }
+
+    const std::size_t length = std::size_t(end - text);
+
+    const int team = position.turn;
+
+    if(length >= 3 && (text[0] == 'O' || text[0] == '0') && text[1] == '-')
+    {
+        const char zero = text[0];
+
+        const bool queenSide = length == 5 && text[2] == zero && text[3] == '-' && text[4] == zero;
+
+        if(!queenSide && !(length == 3 && text[2] == zero))
+        {
+            return false;
+        }
+
+        const u64 king = position.pieces[team][kKing] & position.unmoved;
+
+        if(king == 0)
+        {
+            return false;
+        }
+
+        const int origin      = LowestBit(king);
+        const int destination = origin + (queenSide ? -2 : 2);
+
+        if(Column(origin) != kKingColumn || !(masks[origin] & Bit(destination)))
+        {
+            return false;
+        }
+
+        move = position.ToMove(origin, destination);
+
+        return true;
+    }
+
+    int type = kPawn;
+
+    if(text != end && PieceIndex(*text) >= 0 && PieceIndex(*text) < kNumTypes)
+    {
+        type = PieceIndex(*text++);
+    }
+
+    bool upgrade = false;
+
+    if(end - text >= 4 && end[-2] == '=' && (end[-1] == 'Q' || end[-1] == 'q'))
+    {
+        upgrade = true;
+        end    -= 2;
+    }
+    else if(end - text >= 3 && (end[-1] == 'Q' || end[-1] == 'q') && IsRow(end[-2]))
+    {
+        upgrade = true;
+        end    -= 1;
+    }
+
+    if(end - text < 2 || !IsColumn(end[-2]) || !IsRow(end[-1]))
+    {
+        return false;
+    }
+
+    const int destination = (end[-1] - '1') * Board::kDimension + (end[-2] - 'a');
+
+    end -= 2;
+
+    if(end != text && end[-1] == 'x')
+    {
+        --end;
+    }
+
+    // what is left can only say which piece moves, by its column, row or both
+
+    int column = -1;
+    int row    = -1;
+
+    if(text != end && IsColumn(*text))
+    {
+        column = *text++ - 'a';
+    }
+
+    if(text != end && IsRow(*text))
+    {
+        row = *text++ - '1';
+    }
+
+    if(text != end)
+    {
+        return false;
+    }
+
+    int found = -1;
+
+    for(u64 bits = position.pieces[team][type]; bits; bits &= bits - 1)
+    {
+        const int origin = LowestBit(bits);
+
+        if(!(masks[origin] & Bit(destination)) || (column >= 0 && Column(origin) != column) || (row >= 0 && Row(origin) != row))
+        {
+            continue;
+        }
+
+        // a pawn is only named by its column when it captures
+
+        if(type == kPawn && column < 0 && Column(origin) != Column(destination))
+        {
+            continue;
+        }
+
+        if(found >= 0)
+        {
+            return false;
+        }
+
+        found = origin;
+    }
+
+    if(found < 0)
+    {
+        return false;
+    }
+
+    move = position.ToMove(found, destination);
+
+    return !upgrade || move.IsUpgrade();
+}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include "move.hpp"
+
+#include "../core.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace Engine
+{
+
+constexpr std::size_t kMaxPositionTextSize = 96;    //!< Longest position string, with its terminating null.
+constexpr std::size_t kMaxMoveTextSize     = 12;    //!< Longest algebraic move, with its terminating null.
+
+//! @brief Writes @p position as a line of text in the style of FEN, with four fields separated by spaces.
+//!
+//! | Field      | Contents                                                                                   |
+//! |------------|--------------------------------------------------------------------------------------------|
+//! | Pieces     | Rows from 8 at black's pole to 1 at white's separated by '/', each from column a to h.     |
+//! |            | PBNRQK for white pieces, pbnrqk for black and a digit for a run of empty squares.          |
+//! | Turn       | w or b.                                                                                    |
+//! | Castling   | Column of every king and rook that has never moved, A-H for white on row 1 then a-h for   |
+//! |            | black on row 8, or '-'. Columns rather than KQkq as either rook can castle either way      |
+//! |            | around the sphere, eg. "AEHaeh" at the start.                                              |
+//! | En passant | Square the pawn that just moved two rows passed over, or '-'.                              |
+//!
+//! Kings and rooks off their back row are always treated as moved, there is no way to write them otherwise.
+//! @param [out] output At least kMaxPositionTextSize characters, null terminated.
+//! @returns The number of characters written before the null.
+std::size_t FormatPosition(const BitboardPosition& position, char* output);
+
+//! @brief Reads a position written by FormatPosition(), without allocating.
+//!
+//! Two trailing numbers are accepted and ignored, so FEN move counters can be left on.
+//! @returns False when @p text isn't a well formed position, a team doesn't have exactly one king, a pawn is on
+//!          the first or last row, or the castling or en passant squares don't hold the pieces they need.
+bool ParsePosition(const char* text, std::size_t size, BitboardPosition& position);
+
+//! @brief Writes @p move in algebraic notation, eg. "Nf3", "exd5", "Raxd1", "e8=Q+" or "O-O-O".
+//!
+//! A move across a pole or around the back of the sphere needs no mark, as there is only one legal move for each
+//! origin and destination. "O-O" castles with the king moving towards column h and "O-O-O" towards column a,
+//! whichever rook that reaches, which is the rook on the far side of the wrap when the near one has moved.
+//! @param [in] masks The legal moves of @p position from BitboardPosition::GenerateLegal(), @p move must be one.
+//! @param [out] output At least kMaxMoveTextSize characters, null terminated.
+//! @returns The number of characters written before the null.
+std::size_t FormatMove(const BitboardPosition& position, const u64 masks[kNumSquares], Move move, char* output);
+
+//! @brief Reads a move written by FormatMove(), without allocating.
+//!
+//! Checks and annotations are ignored and superfluous disambiguation is accepted, so coordinate moves like "g1f3"
+//! are also read, as is castling written with zeros.
+//! @param [in] masks The legal moves of @p position from BitboardPosition::GenerateLegal().
+//! @returns False when @p text isn't well formed or doesn't name exactly one legal move.
+bool ParseMove(const BitboardPosition& position, const u64 masks[kNumSquares], const char* text, std::size_t size, Move& move);
+
+inline std::string FormatPosition(const BitboardPosition& position)
+{
+    char text[kMaxPositionTextSize];
+    return std::string(text, FormatPosition(position, text));
+}
+
+inline bool ParsePosition(const std::string& text, BitboardPosition& position)
+{
+    return ParsePosition(text.data(), text.size(), position);
+}
+
+}
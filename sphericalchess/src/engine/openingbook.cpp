@@ -0,0 +1,209 @@
+#include "openingbook.hpp"
+
+#include "movegen.hpp"
+#include "zobrist.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace Engine
+{
+
+constexpr char OpeningBook::kMagic[4];
+
+namespace
+{
+    bool EntryLess(const OpeningBook::Entry& a, const OpeningBook::Entry& b)
+    {
+        return a.key != b.key ? a.key < b.key : a.move < b.move;
+    }
+
+    //! @brief Number of unmerged entries allowed before they are merged, keeps memory bounded by the number of unique moves.
+    constexpr std::size_t kMergeThreshold = 1 << 22;
+}
+
+void OpeningBook::Open(const char* filename)
+{
+    Close();
+
+    file.Open(filename);
+
+    Header header;
+
+    if(file.GetSize() < sizeof(Header))
+    {
+        Close();
+        throw std::runtime_error("Opening book is too small: " + std::string(filename));
+    }
+
+    std::memcpy(&header, file.GetData(), sizeof(Header));
+
+    if(std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion)
+    {
+        Close();
+        throw std::runtime_error("Not a supported opening book: " + std::string(filename));
+    }
+
+    if(header.count > (file.GetSize() - sizeof(Header)) / sizeof(Entry))
+    {
+        Close();
+        throw std::runtime_error("Opening book is truncated: " + std::string(filename));
+    }
+
+    entries = reinterpret_cast<const Entry*>(file.GetData() + sizeof(Header));
+    count   = std::size_t(header.count);
+}
+
+void OpeningBook::Close()
+{
+    file.Close();
+
+    entries = nullptr;
+    count   = 0;
+}
+
+auto OpeningBook::Find(u64 key) const -> std::pair<const Entry*, const Entry*>
+{
+    const Entry* first = std::lower_bound(entries, entries + count, key, [](const Entry& e, u64 k) { return e.key < k; });
+    const Entry* last  = first;
+
+    while(last != entries + count && last->key == key)
+    {
+        ++last;
+    }
+
+    return std::make_pair(first, last);
+}
+
+Move OpeningBook::Choose(const Board& board, u32 random) const
+{
+    auto range = Find(Zobrist::Hash(board));
+
+    u32 total = 0;
+
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        total += it->weight;
+    }
+
+    if(total == 0)
+    {
+        return Move();
+    }
+
+    u32 pick = random % total;
+
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        if(pick < it->weight)
+        {
+            return Move(it->move);
+        }
+
+        pick -= it->weight;
+    }
+
+    return Move();
+}
+
+bool OpeningBookBuilder::AddGame(const std::vector<Move>& moves, Board::Result result, int maxPly)
+{
+    Board board;
+
+    const int count = std::min<int>(int(moves.size()), maxPly);
+
+    for(int i = 0; i < count; ++i)
+    {
+        Piece::ActionCollection actions;
+
+        GenerateLegalActions(board, actions);
+
+        const Piece::Action* action = Move::FindAction(moves[i], actions);
+
+        if(action == nullptr)
+        {
+            return false;
+        }
+
+        const Piece::Team team = board.GetCurrentTeamTurn();
+
+        u16 points = 1;
+
+        if(result == Board::Result::WhiteWins) points = team == Piece::Team::White ? 2 : 0;
+        if(result == Board::Result::BlackWins) points = team == Piece::Team::Black ? 2 : 0;
+
+        entries.push_back({ Zobrist::Hash(board), moves[i].GetData(), points, 1 });
+
+        board.DoAction(*action);
+    }
+
+    if(entries.size() - merged >= kMergeThreshold)
+    {
+        Merge();
+    }
+
+    return true;
+}
+
+void OpeningBookBuilder::Write(const char* filename)
+{
+    Merge();
+
+    // entries are kept sorted by move to merge them, the book wants the highest weight first
+
+    std::stable_sort(entries.begin(), entries.end(), [](const OpeningBook::Entry& a, const OpeningBook::Entry& b)
+    {
+        return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+    });
+
+    std::ofstream file(filename, std::ios::binary);
+
+    if(!file) throw std::runtime_error("Failed to open file: " + std::string(filename));
+
+    OpeningBook::Header header;
+
+    std::memcpy(header.magic, OpeningBook::kMagic, sizeof(header.magic));
+    header.version = OpeningBook::kVersion;
+    header.count   = entries.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(OpeningBook::Entry));
+    file.close();
+
+    // back in merge order before any error, so the builder can still be added to
+
+    std::sort(entries.begin(), entries.end(), EntryLess);
+
+    if(!file) throw std::runtime_error("Failed to write file: " + std::string(filename));
+}
+
+void OpeningBookBuilder::Merge()
+{
+    std::sort(entries.begin() + merged, entries.end(), EntryLess);
+    std::inplace_merge(entries.begin(), entries.begin() + merged, entries.end(), EntryLess);
+
+    std::size_t output = 0;
+
+    for(std::size_t i = 0; i < entries.size(); ++i)
+    {
+        if(output > 0 && entries[output - 1].key == entries[i].key && entries[output - 1].move == entries[i].move)
+        {
+            auto& entry = entries[output - 1];
+
+            entry.weight = u16(std::min<u32>(u32(entry.weight) + entries[i].weight, 0xFFFF));
+            entry.learn += entries[i].learn;
+        }
+        else
+        {
+            entries[output++] = entries[i];
+        }
+    }
+
+    entries.resize(output);
+    merged = output;
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "move.hpp"
+
+#include "../game/board.hpp"
+#include "../mappedfile.hpp"
+#include "../core.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace Engine
+{
+
+//! @brief Read only opening book, memory mapped and searched in place.
+//!
+//! The file is a header followed by fixed size entries sorted by position key then by descending weight,
+//! all values stored little endian. Nothing is parsed or allocated when opened, a probe is a binary search
+//! that only touches the pages it needs so a book larger than the available memory still works.
+class OpeningBook
+{
+public:
+
+    struct Entry
+    {
+        u64 key;        //!< Zobrist::Hash() of the position before the move.
+        u16 move;       //!< Move::GetData() of the move played.
+        u16 weight;     //!< Two points per win and one per draw for the team that played the move.
+        u32 learn;      //!< Number of games the move was played in.
+    };
+
+    struct Header
+    {
+        char magic[4];  //!< Always kMagic.
+        u32  version;
+        u64  count;     //!< Number of entries following the header.
+    };
+
+    static_assert(sizeof(Entry)  == 16, "Entry must match the file layout.");
+    static_assert(sizeof(Header) == 16, "Header must match the file layout.");
+
+    static constexpr char kMagic[4] = { 'S', 'C', 'B', 'K' };
+    static constexpr u32  kVersion  = 1;
+
+    //! @throws std::runtime_error When the file can't be opened or isn't a valid book.
+    void Open(const char* filename);
+    void Close();
+
+    bool IsOpen() const { return file.IsOpen(); }
+
+    std::size_t GetNumEntries() const { return count; }
+
+    //! @returns All entries for position @p key, as a [first, last) range that is empty when the position isn't in the book.
+    std::pair<const Entry*, const Entry*> Find(u64 key) const;
+
+    //! @brief Picks a move for @p board with probability proportional to its weight.
+    //! @param [in] random Any random value, the same value always picks the same move.
+    //! @returns An empty Move if the position isn't in the book.
+    Move Choose(const Board& board, u32 random) const;
+
+private:
+
+    MappedFile   file;
+    const Entry* entries = nullptr;
+    std::size_t  count   = 0;
+};
+
+//! @brief Accumulates played moves from game records and writes them as an OpeningBook file.
+class OpeningBookBuilder
+{
+public:
+
+    //! @brief Adds the first @p maxPly moves of a game.
+    //! @returns False if a move isn't legal, the moves up until it are still added.
+    bool AddGame(const std::vector<Move>& moves, Board::Result result, int maxPly);
+
+    //! @throws std::runtime_error When the file fails to open or be written.
+    void Write(const char* filename);
+
+    std::size_t GetNumEntries() { Merge(); return entries.size(); }
+
+private:
+
+    std::vector<OpeningBook::Entry> entries;
+    std::size_t                     merged = 0;    //!< Entries before this index are sorted and unique.
+
+    void Merge();
+};
+
+}
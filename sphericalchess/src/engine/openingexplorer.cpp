@@ -0,0 +1,235 @@
+#include "openingexplorer.hpp"
+
+#include "gamerecord.hpp"
+#include "symmetry.hpp"
+#include "threads.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+constexpr char OpeningExplorer::kMagic[4];
+
+namespace
+{
+    constexpr std::size_t kMergeThreshold = 1 << 18;    //!< Unmerged counters a thread holds before adding them up.
+
+    using Entry = OpeningExplorer::Entry;
+
+    u32 GetGames(const Entry& entry)
+    {
+        return entry.wins + entry.draws + entry.losses;
+    }
+
+    //! @brief Adds up the counters of the same move, then reorders a position's moves by the most games.
+    struct EntryPolicy
+    {
+        static bool Less(const Entry& a, const Entry& b)
+        {
+            return a.key != b.key ? a.key < b.key : a.move < b.move;
+        }
+
+        static bool Combine(Entry& entry, const Entry& counts)
+        {
+            if(entry.key != counts.key || entry.move != counts.move)
+            {
+                return false;
+            }
+
+            entry.wins   += counts.wins;
+            entry.draws  += counts.draws;
+            entry.losses += counts.losses;
+
+            return true;
+        }
+
+        static void Finish(Entry* first, Entry* last)
+        {
+            std::sort(first, last, [](const Entry& a, const Entry& b)
+            {
+                return GetGames(a) != GetGames(b) ? GetGames(a) > GetGames(b) : a.move < b.move;
+            });
+        }
+    };
+
+    using Builder = SortedTableBuilder<Entry, EntryPolicy>;
+
+    //! @brief Sorts the counters after @p merged into those before it, adding up the counters of the same move.
+    void Combine(std::vector<Entry>& entries, std::size_t& merged)
+    {
+        std::sort(entries.begin() + std::ptrdiff_t(merged), entries.end(), EntryPolicy::Less);
+        std::inplace_merge(entries.begin(), entries.begin() + std::ptrdiff_t(merged), entries.end(), EntryPolicy::Less);
+
+        std::size_t output = 0;
+
+        for(std::size_t i = 0; i < entries.size(); ++i)
+        {
+            if(output == 0 || !EntryPolicy::Combine(entries[output - 1], entries[i]))
+            {
+                entries[output++] = entries[i];
+            }
+        }
+
+        entries.resize(output);
+        merged = output;
+    }
+}
+
+OpeningExplorerStats OpeningExplorer::Build(const char* gamesFilename, const char* filename, const OpeningExplorerSettings& settings)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const int numThreads = std::max(settings.threads, 1);
+
+    const std::vector<std::size_t> offsets = GameRecordReader(gamesFilename).ReadOffsets();
+
+    const std::size_t runEntries = std::max<std::size_t>(std::size_t(settings.memoryMegabytes) * (1 << 20) / sizeof(Entry) / std::size_t(numThreads), 2 * kMergeThreshold);
+
+    OpeningExplorerStats stats;
+
+    std::atomic<std::size_t> nextChunk { 0 };
+    std::atomic<bool>        stopped   { false };
+
+    std::mutex mutex;
+    Builder    builder(filename);
+
+    RunOnThreads(numThreads, [&](int)
+    {
+        GameRecordReader reader(gamesFilename);
+        GameRecordReplay replay;
+        GameRecordView   game;
+
+        std::vector<Entry> entries;
+        std::size_t        merged = 0;
+
+        u64 games = 0;
+        u64 moves = 0;
+
+        auto Flush = [&]()
+        {
+            Combine(entries, merged);
+
+            builder.AddRun(entries);
+            merged = 0;
+        };
+
+        for(std::size_t chunk; !stopped.load(std::memory_order_relaxed) && (chunk = nextChunk.fetch_add(GameRecordReader::kChunkGames)) < offsets.size();)
+        {
+            const std::size_t last = std::min(chunk + GameRecordReader::kChunkGames, offsets.size());
+
+            reader.Seek(offsets[chunk]);
+
+            for(std::size_t i = chunk; i < last && reader.Next(game); ++i)
+            {
+                if(game.result == Board::Result::Undecided)
+                {
+                    continue;
+                }
+
+                replay.Start(game);
+
+                BitboardPosition before = replay.GetPosition();
+
+                Move move;
+
+                for(int ply = 0; ply < settings.maxPlies && replay.Next(move); ++ply)
+                {
+                    const CanonicalKey key = Canonicalize(before);
+
+                    // from the side of the team that moved, which the symmetry may swap
+
+                    const bool white = before.turn == u8(Piece::Team::White);
+                    const bool won   = game.result == (white ? Board::Result::WhiteWins : Board::Result::BlackWins);
+                    const bool drawn = game.result == Board::Result::Draw;
+
+                    entries.push_back({ key.hash, key.symmetry.Apply(move).GetData(), 0, u32(won), u32(drawn), u32(!won && !drawn) });
+
+                    before = replay.GetPosition();
+                }
+
+                ++games;
+                moves += u64(std::min<int>(settings.maxPlies, game.numPlies));
+            }
+
+            if(entries.size() - merged >= kMergeThreshold)
+            {
+                Combine(entries, merged);
+
+                if(entries.size() >= runEntries)
+                {
+                    Flush();
+                }
+            }
+        }
+
+        Flush();
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        stats.games += games;
+        stats.moves += moves;
+    },
+    [&] { stopped.store(true, std::memory_order_relaxed); });
+
+    Header header = {};
+
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.version  = kVersion;
+    header.games    = stats.games;
+    header.maxPlies = u32(settings.maxPlies);
+
+    stats.entries = builder.Merge(header);
+
+    stats.runs         = builder.GetNumRuns();
+    stats.milliseconds = u64(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+    return stats;
+}
+
+void OpeningExplorer::Open(const char* filename)
+{
+    Close();
+
+    const Header header = table.Open<Header>(filename, "Opening explorer", kMagic, kVersion);
+
+    games    = header.games;
+    maxPlies = int(header.maxPlies);
+}
+
+void OpeningExplorer::Close()
+{
+    table.Close();
+
+    games    = 0;
+    maxPlies = 0;
+}
+
+std::size_t OpeningExplorer::Lookup(const BitboardPosition& position, ExplorerMove* moves, std::size_t capacity) const
+{
+    const CanonicalKey key     = Canonicalize(position);
+    const Symmetry     inverse = key.symmetry.Inverse();
+
+    const auto range = Find(key.hash);
+
+    for(auto entry = range.first; entry != range.second && std::size_t(entry - range.first) < capacity; ++entry)
+    {
+        ExplorerMove& move = moves[entry - range.first];
+
+        move.move   = inverse.Apply(Move(entry->move));
+        move.wins   = entry->wins;
+        move.draws  = entry->draws;
+        move.losses = entry->losses;
+    }
+
+    return std::size_t(range.second - range.first);
+}
+
+}
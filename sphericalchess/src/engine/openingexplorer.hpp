@@ -0,0 +1,114 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include "move.hpp"
+#include "sortedtable.hpp"
+
+#include "../core.hpp"
+
+#include <cstddef>
+#include <utility>
+
+namespace Engine
+{
+
+struct OpeningExplorerSettings
+{
+    int threads         = 1;
+    int maxPlies        = 40;       //!< Moves later in a game aren't counted, few positions past the opening are reached twice.
+    int memoryMegabytes = 1024;     //!< For the counters held before they are sorted into a temporary file, shared by the threads.
+};
+
+struct OpeningExplorerStats
+{
+    u64 games        = 0;   //!< Decided games counted.
+    u64 moves        = 0;   //!< Moves counted, once for every game they were played in.
+    u64 entries      = 0;   //!< Distinct moves of distinct positions in the explorer.
+    u64 runs         = 0;   //!< Sorted temporary files merged into the explorer.
+    u64 milliseconds = 0;
+
+    double GetGamesPerSecond() const { return milliseconds > 0 ? games * 1000.0 / milliseconds : 0.0; }
+};
+
+//! @brief How a move played in a position turned out, for the team that played it.
+struct ExplorerMove
+{
+    Move move;
+    u32  wins   = 0;
+    u32  draws  = 0;
+    u32  losses = 0;
+
+    u32 GetGames() const { return wins + draws + losses; }
+};
+
+//! @brief Read only table of win, draw and loss counts for the moves played in the games of a GameRecordWriter
+//! file, memory mapped and searched in place.
+//!
+//! A SortedTable of an Entry for every move played in a position, sorted by key then by the most games.
+//!
+//! Positions are keyed by their CanonicalKey, so the games of every position equal under a Symmetry are counted
+//! together, and moves are stored as they are in the representative. Undecided games are left out. All values
+//! are stored little endian.
+class OpeningExplorer
+{
+public:
+
+    struct Entry
+    {
+        u64 key;        //!< CanonicalKey::hash of the position before the move.
+        u16 move;       //!< Move::GetData() of the move in the representative of the position.
+        u16 reserved;
+        u32 wins;
+        u32 draws;
+        u32 losses;
+    };
+
+    struct Header
+    {
+        char magic[4];  //!< Always kMagic.
+        u32  version;
+        u64  count;     //!< Number of entries following the buckets.
+        u64  games;
+        u32  bucketBits;
+        u32  maxPlies;
+    };
+
+    static_assert(sizeof(Entry)  == 24, "Entry must match the file layout.");
+    static_assert(sizeof(Header) == 32, "Header must match the file layout.");
+
+    static constexpr char kMagic[4] = { 'S', 'C', 'O', 'X' };
+    static constexpr u32  kVersion  = 1;
+
+    //! @brief Counts the moves of every game of @p gamesFilename and writes the explorer to @p filename.
+    //!
+    //! Threads take turns at chunks of games, adding up the counts of their own games and sorting them into
+    //! temporary files next to @p filename once they hold their share of the memory. The files are then merged
+    //! into the explorer, adding up the counts of the same move, and removed.
+    //! @throws std::runtime_error When a file fails to open or be written, or the games file is corrupt.
+    static OpeningExplorerStats Build(const char* gamesFilename, const char* filename, const OpeningExplorerSettings& settings);
+
+    //! @throws std::runtime_error When the file can't be opened or isn't a valid explorer.
+    void Open(const char* filename);
+    void Close();
+
+    bool IsOpen() const { return table.IsOpen(); }
+
+    std::size_t GetNumEntries() const { return table.GetNumEntries(); }
+    u64         GetNumGames()   const { return games; }
+    int         GetMaxPlies()   const { return maxPlies; }
+
+    //! @returns All entries for CanonicalKey::hash @p key, as a [first, last) range that is empty when the position wasn't reached.
+    std::pair<const Entry*, const Entry*> Find(u64 key) const { return table.Find(key); }
+
+    //! @brief Finds the moves played in @p position, most played first, with the moves as they are in @p position.
+    //! @returns Number of moves played, only the first @p capacity are written to @p moves.
+    std::size_t Lookup(const BitboardPosition& position, ExplorerMove* moves, std::size_t capacity) const;
+
+private:
+
+    SortedTable<Entry> table;
+    u64                games    = 0;
+    int                maxPlies = 0;
+};
+
+}
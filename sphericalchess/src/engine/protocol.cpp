@@ -0,0 +1,385 @@
+#include "protocol.hpp"
+
+#include "evaluation.hpp"
+#include "movegen.hpp"
+#include "notation.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <random>
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr int kDefaultHash       = 64;
+    constexpr int kMaxHash           = 65536;
+    constexpr int kMaxThreads        = 256;
+    constexpr int kMaxMultiPV        = 64;
+    constexpr int kDefaultMovesToGo  = 30;
+    constexpr int kMoveOverhead      = 30;  // milliseconds kept back for the protocol and process switching
+
+    std::string ScoreToString(int score)
+    {
+        if(std::abs(score) > kScoreMateMin)
+        {
+            // in moves rather than plies, negative when being mated
+
+            const int plies = kScoreMate - std::abs(score);
+            const int moves = (plies + 1) / 2;
+
+            return "mate " + std::to_string(score > 0 ? moves : -moves);
+        }
+
+        return "cp " + std::to_string(score);
+    }
+
+    //! @brief Reads the rest of the tokens up to @p stop, joined by spaces.
+    std::string ReadUntil(std::istringstream& tokens, const std::string& stop)
+    {
+        std::string result, token;
+
+        while(tokens >> token && token != stop)
+        {
+            result += (result.empty() ? "" : " ") + token;
+        }
+
+        return result;
+    }
+}
+
+Protocol::Protocol(std::istream& input, std::ostream& output)
+    : input(input)
+    , output(output)
+    , table(kDefaultHash)
+    , search(table)
+{
+}
+
+Protocol::~Protocol()
+{
+    StopSearch();
+}
+
+void Protocol::Run()
+{
+    std::string line;
+
+    while(std::getline(input, line))
+    {
+        if(!Execute(line))
+        {
+            break;
+        }
+    }
+
+    StopSearch();
+}
+
+bool Protocol::Execute(const std::string& line)
+{
+    std::istringstream tokens(line);
+    std::string command;
+
+    if(!(tokens >> command))
+    {
+        return true;
+    }
+
+    if(command == "uci")
+    {
+        Uci();
+    }
+    else if(command == "isready")
+    {
+        Send("readyok");
+    }
+    else if(command == "setoption")
+    {
+        StopSearch();
+        SetOption(tokens);
+    }
+    else if(command == "ucinewgame")
+    {
+        StopSearch();
+        table.Clear();
+    }
+    else if(command == "position")
+    {
+        StopSearch();
+        Position(tokens);
+    }
+    else if(command == "go")
+    {
+        StopSearch();
+        Go(tokens);
+    }
+    else if(command == "stop")
+    {
+        StopSearch();
+    }
+    else if(command == "quit")
+    {
+        return false;
+    }
+    else
+    {
+        Send("info string unknown command " + command);
+    }
+
+    return true;
+}
+
+void Protocol::Uci()
+{
+    Send("id name Spherical Chess");
+    Send("id author Spherical Chess developers");
+    Send("option name Hash type spin default " + std::to_string(kDefaultHash) + " min 1 max " + std::to_string(kMaxHash));
+    Send("option name Threads type spin default 1 min 1 max " + std::to_string(kMaxThreads));
+    Send("option name MultiPV type spin default 1 min 1 max " + std::to_string(kMaxMultiPV));
+    Send("option name BookFile type string default <empty>");
+    Send("option name TablebasePath type string default <empty>");
+    Send("uciok");
+}
+
+void Protocol::SetOption(std::istringstream& tokens)
+{
+    std::string token;
+
+    if(!(tokens >> token) || token != "name")
+    {
+        return;
+    }
+
+    const std::string name  = ReadUntil(tokens, "value");
+    const std::string value = ReadUntil(tokens, "");
+
+    try
+    {
+        if(name == "Hash")
+        {
+            table.Resize(std::size_t(std::max(1, std::min(std::stoi(value), kMaxHash))));
+        }
+        else if(name == "Threads")
+        {
+            threads = std::max(1, std::min(std::stoi(value), kMaxThreads));
+        }
+        else if(name == "MultiPV")
+        {
+            multiPV = std::max(1, std::min(std::stoi(value), kMaxMultiPV));
+        }
+        else if(name == "BookFile")
+        {
+            book.Close();
+
+            if(!value.empty() && value != "<empty>")
+            {
+                book.Open(value.c_str());
+            }
+        }
+        else if(name == "TablebasePath")
+        {
+            tablebases.Close();
+
+            const int count = value.empty() || value == "<empty>" ? 0 : tablebases.Open(value);
+
+            search.SetTablebases(count > 0 ? &tablebases : nullptr);
+            Send("info string " + std::to_string(count) + " tablebases");
+        }
+        else
+        {
+            Send("info string unknown option " + name);
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        Send("info string " + std::string(ex.what()));
+    }
+}
+
+void Protocol::Position(std::istringstream& tokens)
+{
+    std::string token;
+
+    tokens >> token;
+
+    if(token == "startpos")
+    {
+        board = Board();
+        tokens >> token;
+    }
+    else if(token == "fen")
+    {
+        std::string fen;
+
+        while(tokens >> token && token != "moves")
+        {
+            fen += (fen.empty() ? "" : " ") + token;
+        }
+
+        BitboardPosition position;
+
+        if(!ParsePosition(fen, position))
+        {
+            Send("info string invalid fen " + fen);
+            return;
+        }
+
+        position.ToBoard(board);
+    }
+    else
+    {
+        Send("info string unsupported position " + token);
+        return;
+    }
+
+    if(token != "moves")
+    {
+        return;
+    }
+
+    Piece::ActionCollection actions;
+
+    while(tokens >> token)
+    {
+        actions.clear();
+        GenerateLegalActions(board, actions);
+
+        Move move;
+        const Piece::Action* action = Move::Parse(token, move) ? Move::FindAction(move, actions) : nullptr;
+
+        if(!action)
+        {
+            Send("info string illegal move " + token);
+            return;
+        }
+
+        board.DoAction(*action);
+    }
+}
+
+void Protocol::Go(std::istringstream& tokens)
+{
+    SearchLimits limits;
+
+    limits.threads = threads;
+    limits.multiPV = multiPV;
+
+    int time[2]   = {};
+    int inc[2]    = {};
+    int movesToGo = kDefaultMovesToGo;
+
+    std::string token;
+
+    while(tokens >> token)
+    {
+        if     (token == "depth")     tokens >> limits.depth;
+        else if(token == "nodes")     tokens >> limits.nodes;
+        else if(token == "movetime")  tokens >> limits.milliseconds;
+        else if(token == "wtime")     tokens >> time[int(Piece::Team::White)];
+        else if(token == "btime")     tokens >> time[int(Piece::Team::Black)];
+        else if(token == "winc")      tokens >> inc[int(Piece::Team::White)];
+        else if(token == "binc")      tokens >> inc[int(Piece::Team::Black)];
+        else if(token == "movestogo") tokens >> movesToGo;
+    }
+
+    limits.depth = std::max(1, std::min(limits.depth, kMaxPly - 1));
+
+    const int team = int(board.GetCurrentTeamTurn());
+
+    if(limits.milliseconds == 0 && time[team] > 0)
+    {
+        // an even share of the remaining time plus most of the increment, never all of what is left
+
+        const int share = time[team] / std::max(movesToGo, 1) + inc[team] * 3 / 4;
+
+        limits.milliseconds = std::max(1, std::min(share, time[team] - kMoveOverhead));
+    }
+
+    if(book.IsOpen())
+    {
+        const Move move = book.Choose(board, std::random_device()());
+
+        // the book only matches a hash, so a collision or a book of another version can give a move that isn't legal
+
+        Piece::ActionCollection actions;
+        GenerateLegalActions(board, actions);
+
+        if(move && Move::FindAction(move, actions))
+        {
+            Send("bestmove " + move.ToString());
+            return;
+        }
+    }
+
+    stopRequested = false;
+
+    searchThread = std::thread([this, limits, board = board]()
+    {
+        const SearchInfo info = search.Run(board, limits, [this](const SearchInfo& info)
+        {
+            SendInfo(info);
+
+            if(stopRequested)
+            {
+                search.Stop();
+            }
+        });
+
+        if(info.lines.empty())
+        {
+            Send("bestmove 0000");
+        }
+        else
+        {
+            const std::vector<Move>& moves = info.lines.front().moves;
+
+            Send("bestmove " + moves.front().ToString() + (moves.size() > 1 ? " ponder " + moves[1].ToString() : ""));
+        }
+    });
+}
+
+void Protocol::StopSearch()
+{
+    if(searchThread.joinable())
+    {
+        stopRequested = true;
+        search.Stop();
+        searchThread.join();
+    }
+}
+
+void Protocol::Send(const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(outputMutex);
+
+    output << line << std::endl;
+}
+
+void Protocol::SendInfo(const SearchInfo& info)
+{
+    for(std::size_t i = 0; i < info.lines.size(); ++i)
+    {
+        const SearchLine& line = info.lines[i];
+
+        std::string text = "info depth " + std::to_string(info.depth)
+                         + " multipv " + std::to_string(i + 1)
+                         + " score " + ScoreToString(line.score)
+                         + " nodes " + std::to_string(info.nodes)
+                         + " nps " + std::to_string(info.NodesPerSecond())
+                         + " time " + std::to_string(info.milliseconds)
+                         + " pv";
+
+        for(auto& move : line.moves)
+        {
+            text += " " + move.ToString();
+        }
+
+        Send(text);
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "openingbook.hpp"
+#include "search.hpp"
+#include "tablebase.hpp"
+#include "transpositiontable.hpp"
+
+#include "../game/board.hpp"
+
+#include <atomic>
+#include <iosfwd>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace Engine
+{
+
+//! @brief Line based text protocol to drive the engine from another process, modelled on UCI.
+//!
+//! Squares are named by column a-h around the sphere and row 1-8 from white's pole to black's, and moves
+//! use Move::ToString() notation, where a castle names the rook's column as either rook can reach the king.
+//! Commands are read one per line and answered as they are read, while a search runs on its own thread
+//! so "stop" and "isready" are answered during it.
+//!
+//! | Command                                              | Reply                                          |
+//! |------------------------------------------------------|------------------------------------------------|
+//! | uci                                                  | id, supported options and uciok.               |
+//! | isready                                              | readyok.                                       |
+//! | setoption name <name> value <value>                  | Nothing.                                       |
+//! | ucinewgame                                           | Nothing, clears the transposition table.       |
+//! | position startpos [moves <move> ...]                 | Nothing, or info string for an illegal move.   |
+//! | position fen <position> [moves <move> ...]           | As above, the position as FormatPosition().    |
+//! | go [limits]                                          | info per depth and line, then bestmove.        |
+//! | stop                                                 | bestmove of the search that was stopped.       |
+//! | quit                                                 | Stops any search and returns from Run().       |
+//!
+//! The limits of go are any of depth, nodes, movetime, wtime, btime, winc, binc and movestogo followed by
+//! a number, times in milliseconds, or infinite. Options are Hash, Threads, MultiPV, BookFile and TablebasePath.
+class Protocol
+{
+public:
+
+    Protocol(std::istream& input, std::ostream& output);
+    ~Protocol();
+
+    Protocol(const Protocol&) = delete;
+
+    //! @brief Reads and answers commands until "quit" or the end of the input.
+    void Run();
+
+    //! @brief Answers a single command.
+    //! @returns False for "quit".
+    bool Execute(const std::string& line);
+
+private:
+
+    std::istream& input;
+    std::ostream& output;
+    std::mutex    outputMutex;
+
+    TranspositionTable table;
+    Search             search;
+    Tablebases         tablebases;
+    OpeningBook        book;
+
+    Board board;
+
+    int threads = 1;
+    int multiPV = 1;
+
+    std::thread       searchThread;
+    std::atomic<bool> stopRequested { false };  //!< Search::Run() clears its own flag, so a stop sent as it starts is kept here.
+
+    void Uci();
+    void SetOption(std::istringstream& tokens);
+    void Position(std::istringstream& tokens);
+    void Go(std::istringstream& tokens);
+
+    //! @brief Stops a running search and waits for its bestmove to be sent.
+    void StopSearch();
+
+    void Send(const std::string& line);
+    void SendInfo(const SearchInfo& info);
+};
+
+}
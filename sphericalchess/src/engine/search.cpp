@@ -0,0 +1,806 @@
+#include "search.hpp"
+
+#include "evaluation.hpp"
+#include "movegen.hpp"
+#include "zobrist.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr int kNodeBatch = 256; // nodes counted locally before being added to the shared total
+
+    int ActionVictimValue(const Piece::Action& action)
+    {
+        return (action.type & Piece::Action::TypeBit_capture) ? int(action.additional.piece.GetType()) + 1 : 0;
+    }
+
+    bool IsQuiet(const Piece::Action& action)
+    {
+        return (action.type & (Piece::Action::TypeBit_capture | Piece::Action::TypeBit_upgrade)) == 0;
+    }
+
+    constexpr int kNullMoveMinDepth       = 3;
+    constexpr int kNullMoveVerifyDepth    = 10;    // deeper null moves are verified with a reduced search without null moves
+    constexpr int kReverseFutilityDepth   = 6;
+    constexpr int kReverseFutilityMargin  = 120;   // per ply of depth
+    constexpr int kFutilityDepth          = 3;
+    constexpr int kFutilityMargin         = 150;   // per ply of depth
+    constexpr int kLateMoveMinDepth       = 3;
+    constexpr int kLateMoveMinIndex       = 3;     // moves searched at full depth before reducing
+    constexpr int kLateMoveHistory        = 4096;  // history per ply of reduction taken off
+    constexpr int kMaxHistory             = 1 << 20;
+    constexpr int kMaxReductionMoves      = 64;
+
+    //! @brief Late move reduction by depth and index of the move, growing with the log of both.
+    int LateMoveReduction(int depth, int index)
+    {
+        static const struct Table
+        {
+            int reductions[kMaxPly][kMaxReductionMoves];
+
+            Table()
+            {
+                for(int d = 0; d < kMaxPly; ++d)
+                {
+                    for(int i = 0; i < kMaxReductionMoves; ++i)
+                    {
+                        reductions[d][i] = (d > 0 && i > 0) ? int(0.5 + std::log(double(d)) * std::log(double(i)) / 2.25) : 0;
+                    }
+                }
+            }
+        } table;
+
+        return table.reductions[std::min(depth, kMaxPly - 1)][std::min(index, kMaxReductionMoves - 1)];
+    }
+
+    //! @brief Whether @p team has a piece other than pawns and its king, without which zugzwang is common.
+    bool HasPieces(const Board& board, Piece::Team team)
+    {
+        for(int i = 0; i < Board::kDimension; ++i)
+        {
+            for(int j = 0; j < Board::kDimension; ++j)
+            {
+                auto& piece = board.PieceAt(i, j);
+
+                if(piece && piece.GetTeam() == team && piece.GetType() != Piece::Type::Pawn && piece.GetType() != Piece::Type::King)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    //! @brief An action that moves nothing, a pass, found as an empty square to move to itself.
+    Piece::Action MakeNullAction(const Board& board)
+    {
+        Vec2i square;
+
+        for(square.y = 0; square.y < Board::kDimension; ++square.y)
+        {
+            for(square.x = 0; square.x < Board::kDimension; ++square.x)
+            {
+                if(!board.PieceAt(square))
+                {
+                    return Piece::Action::MakeMove(Piece(), { square, square });
+                }
+            }
+        }
+
+        assert(false);
+        return Piece::Action();
+    }
+}
+
+class Search::Worker
+{
+public:
+
+    Worker(Search& search, const Board& board, int id) : search(search), board(board), id(id)
+    {
+    }
+
+    //! @brief Iterative deepening loop, only the main worker (id zero) reports to @p callback.
+    void Run(const Callback& callback);
+
+    const SearchInfo& GetResult() const { return result; }
+    u64 GetUncountedNodes() const { return localNodes % kNodeBatch; }
+
+private:
+
+    Search& search;
+    Board   board;
+    int     id;
+
+    int rootDepth  = 0;
+    u64 localNodes = 0;
+
+    SearchInfo result;
+
+    Piece::ActionCollection rootActions;
+
+    Move pv[kMaxPly + 1][kMaxPly + 1];
+    int  pvLength[kMaxPly + 1] = {};
+
+    Move killers[kMaxPly + 1][2];
+    int  history[64][64] = {};      //!< Starts empty every Run(), as each search makes new workers.
+
+    u64  hashes[kMaxPly + 1]    = {};
+    bool nullMoves[kMaxPly + 1] = {};   //!< Whether the move into each ply was a pass.
+    bool verifying = false;             //!< Null moves are disabled while verifying one.
+
+    int SearchRoot(int depth, const std::vector<Move>& excluded, SearchLine& line);
+    int AlphaBeta(int alpha, int beta, int depth, int ply);
+    int Quiesce(int alpha, int beta, int ply);
+
+    bool CountNode();
+    bool IsRepetition(int ply) const;
+
+    void UpdatePV(int ply, Move move);
+    void AddHistory(const Piece::Action& action, int bonus);
+    void OrderActions(const Piece::ActionCollection& actions, Move ttMove, int ply, std::vector<int>& scores) const;
+};
+
+void Search::Worker::Run(const Callback& callback)
+{
+    GenerateLegalActions(board, rootActions);
+
+    if(rootActions.empty())
+    {
+        return;
+    }
+
+    const int numLines = std::min<int>(search.limits.multiPV, int(rootActions.size()));
+
+    // helper threads search every other depth one deeper than the main thread, so they fill the table with
+    // entries the main thread needs next, but never deeper than a table entry can store
+
+    for(int depth = 1; depth <= std::min(search.limits.depth, kMaxPly - 1); ++depth)
+    {
+        rootDepth = (id > 0 && depth > 1) ? std::min(depth + (id & 1), kMaxPly - 1) : depth;
+
+        std::vector<SearchLine> lines;
+        std::vector<Move>       excluded;
+
+        for(int i = 0; i < numLines; ++i)
+        {
+            SearchLine line;
+
+            SearchRoot(rootDepth, excluded, line);
+
+            if(rootDepth > 1 && search.stopped.load(std::memory_order_relaxed))
+            {
+                break;
+            }
+
+            excluded.push_back(line.moves.front());
+            lines.push_back(std::move(line));
+        }
+
+        if(int(lines.size()) != numLines)
+        {
+            break; // incomplete depth, keep the previous result
+        }
+
+        std::stable_sort(lines.begin(), lines.end(), [](const SearchLine& a, const SearchLine& b)
+        {
+            return a.score > b.score;
+        });
+
+        // search the best lines first in the next iteration
+
+        for(int i = numLines - 1; i >= 0; --i)
+        {
+            auto it = std::find_if(rootActions.begin(), rootActions.end(), [move = lines[i].moves.front()](const Piece::Action& a)
+            {
+                return Move::FromAction(a) == move;
+            });
+
+            std::rotate(rootActions.begin(), it, it + 1);
+        }
+
+        result.depth = rootDepth;
+        result.lines = std::move(lines);
+
+        if(id == 0)
+        {
+            result.nodes        = search.nodes.load(std::memory_order_relaxed) + GetUncountedNodes();
+            result.milliseconds = search.ElapsedMilliseconds();
+
+            if(callback)
+            {
+                callback(result);
+            }
+        }
+
+        if(search.stopped.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+}
+
+int Search::Worker::SearchRoot(int depth, const std::vector<Move>& excluded, SearchLine& line)
+{
+    int alpha = -kScoreInfinite;
+    int beta  =  kScoreInfinite;
+
+    hashes[0]   = Zobrist::Hash(board);
+    pvLength[0] = 0;
+
+    line.score = -kScoreInfinite;
+    line.moves.clear();
+
+    for(auto& action : rootActions)
+    {
+        const Move move = Move::FromAction(action);
+
+        if(std::find(excluded.begin(), excluded.end(), move) != excluded.end())
+        {
+            continue;
+        }
+
+        board.DoAction(action);
+
+        int score;
+
+        if(line.moves.empty())
+        {
+            score = -AlphaBeta(-beta, -alpha, depth - 1, 1);
+        }
+        else
+        {
+            score = -AlphaBeta(-alpha - 1, -alpha, depth - 1, 1);
+
+            if(score > alpha)
+            {
+                score = -AlphaBeta(-beta, -alpha, depth - 1, 1);
+            }
+        }
+
+        board.UndoAction();
+
+        if(depth > 1 && search.stopped.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+
+        if(score > line.score)
+        {
+            line.score = score;
+            alpha      = score;
+
+            line.moves.assign(1, move);
+            line.moves.insert(line.moves.end(), &pv[1][1], &pv[1][pvLength[1]]);
+        }
+    }
+
+    // a stopped iteration hasn't searched every move, so its score isn't a bound worth storing
+
+    if(!line.moves.empty() && !(depth > 1 && search.stopped.load(std::memory_order_relaxed)))
+    {
+        TranspositionTable::Entry entry;
+
+        entry.move  = line.moves.front();
+        entry.score = s16(TranspositionTable::ScoreToTable(line.score, 0));
+        entry.depth = s8(depth);
+        entry.bound = excluded.empty() ? TranspositionTable::Bound::Exact : TranspositionTable::Bound::Lower;
+
+        search.table.Store(hashes[0], entry);
+    }
+
+    return line.score;
+}
+
+int Search::Worker::AlphaBeta(int alpha, int beta, int depth, int ply)
+{
+    pvLength[ply] = ply;
+
+    if(depth <= 0)
+    {
+        return Quiesce(alpha, beta, ply);
+    }
+
+    if(CountNode())
+    {
+        return 0;
+    }
+
+    const u64 hash = hashes[ply] = Zobrist::Hash(board);
+
+    if(IsRepetition(ply))
+    {
+        return 0;
+    }
+
+    if(ply >= kMaxPly)
+    {
+        return Evaluate(board);
+    }
+
+    Tablebases::Result tablebase;
+
+    if(search.tablebases && search.tablebases->Probe(board, tablebase))
+    {
+        switch(tablebase.outcome)
+        {
+        case Tablebases::Outcome::Win:  return  kScoreMate - ply - tablebase.distance;
+        case Tablebases::Outcome::Loss: return -kScoreMate + ply + tablebase.distance;
+        default:                        return 0;
+        }
+    }
+
+    const SearchSelectivity& selectivity = search.limits.selectivity;
+
+    const Piece::Team team = board.GetCurrentTeamTurn();
+    const bool inCheck = IsInCheck(board, team);
+
+    // extensions are limited so checks back and forth can't keep a line going forever, or go past what an entry stores
+
+    if(inCheck && selectivity.checkExtensions && ply < 2 * rootDepth && depth < kMaxPly - 1)
+    {
+        ++depth;
+    }
+
+    const bool pvNode = beta - alpha > 1;
+
+    TranspositionTable::Entry entry;
+    Move ttMove;
+
+    if(search.table.Probe(hash, entry))
+    {
+        ttMove = entry.move;
+
+        if(!pvNode && entry.depth >= depth)
+        {
+            const int score = TranspositionTable::ScoreFromTable(entry.score, ply);
+
+            switch(entry.bound)
+            {
+            case TranspositionTable::Bound::Exact: return score;
+            case TranspositionTable::Bound::Lower: if(score >= beta)  return score; break;
+            case TranspositionTable::Bound::Upper: if(score <= alpha) return score; break;
+            default: break;
+            }
+        }
+    }
+
+    const bool pruning    = !pvNode && !inCheck;
+    const int  staticEval = pruning ? Evaluate(board) : 0;
+
+    if(pruning && selectivity.reverseFutility && depth <= kReverseFutilityDepth && std::abs(beta) < kScoreMateMin &&
+       staticEval - kReverseFutilityMargin * depth >= beta)
+    {
+        return staticEval;
+    }
+
+    if(pruning && selectivity.nullMove && !verifying && !nullMoves[ply] && depth >= kNullMoveMinDepth &&
+       staticEval >= beta && std::abs(beta) < kScoreMateMin && HasPieces(board, team))
+    {
+        // reduced more at higher depths and the further the evaluation is above beta
+
+        const int reduction = 3 + depth / 6 + std::min((staticEval - beta) / 200, 2);
+
+        board.DoAction(MakeNullAction(board));
+        nullMoves[ply + 1] = true;
+
+        int score = -AlphaBeta(-beta, -beta + 1, depth - 1 - reduction, ply + 1);
+
+        nullMoves[ply + 1] = false;
+        board.UndoAction();
+
+        if(search.stopped.load(std::memory_order_relaxed) && rootDepth > 1)
+        {
+            return 0;
+        }
+
+        if(score >= beta)
+        {
+            if(depth >= kNullMoveVerifyDepth)
+            {
+                verifying = true;
+                score = AlphaBeta(beta - 1, beta, depth - reduction, ply);
+                verifying = false;
+            }
+
+            if(score >= beta)
+            {
+                return score >= kScoreMateMin ? beta : score;
+            }
+        }
+    }
+
+    const bool futile = pruning && selectivity.futility && depth <= kFutilityDepth &&
+                        std::abs(alpha) < kScoreMateMin && staticEval + kFutilityMargin * depth <= alpha;
+
+    Piece::ActionCollection actions;
+    std::vector<int>        scores;
+
+    GeneratePseudoLegalActions(board, actions);
+    OrderActions(actions, ttMove, ply, scores);
+
+    const int originalAlpha = alpha;
+
+    int  bestScore = -kScoreInfinite;
+    Move bestMove;
+    int  legal = 0;
+
+    for(std::size_t i = 0; i < actions.size(); ++i)
+    {
+        // selection sort as a cutoff usually happens within the first few actions
+
+        std::size_t best = i;
+
+        for(std::size_t j = i + 1; j < actions.size(); ++j)
+        {
+            if(scores[j] > scores[best]) best = j;
+        }
+
+        std::swap(actions[i], actions[best]);
+        std::swap(scores[i],  scores[best]);
+
+        const Piece::Action& action = actions[i];
+        const Move move  = Move::FromAction(action);
+        const bool quiet = IsQuiet(action);
+
+        board.DoAction(action);
+
+        if(IsInCheck(board, team))
+        {
+            board.UndoAction();
+            continue;
+        }
+
+        ++legal;
+
+        if(futile && quiet && legal > 1)
+        {
+            board.UndoAction();
+
+            bestScore = std::max(bestScore, staticEval + kFutilityMargin * depth);
+            continue;
+        }
+
+        int score;
+
+        if(legal == 1)
+        {
+            score = -AlphaBeta(-beta, -alpha, depth - 1, ply + 1);
+        }
+        else
+        {
+            int reduction = 0;
+
+            if(selectivity.lateMoveReductions && quiet && !inCheck && depth >= kLateMoveMinDepth && legal > kLateMoveMinIndex &&
+               move != killers[ply][0] && move != killers[ply][1])
+            {
+                // less for moves that caused cutoffs elsewhere and along the principal variation
+
+                reduction  = LateMoveReduction(depth, legal);
+                reduction -= history[SquareIndex(action.origin)][SquareIndex(action.destination)] / kLateMoveHistory;
+                reduction -= pvNode ? 1 : 0;
+                reduction  = std::max(0, std::min(reduction, depth - 2));
+            }
+
+            score = -AlphaBeta(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
+
+            if(reduction > 0 && score > alpha)
+            {
+                score = -AlphaBeta(-alpha - 1, -alpha, depth - 1, ply + 1);
+            }
+
+            if(score > alpha && score < beta)
+            {
+                score = -AlphaBeta(-beta, -alpha, depth - 1, ply + 1);
+            }
+        }
+
+        board.UndoAction();
+
+        if(search.stopped.load(std::memory_order_relaxed) && rootDepth > 1)
+        {
+            return 0;
+        }
+
+        if(score > bestScore)
+        {
+            bestScore = score;
+            bestMove  = move;
+
+            if(score > alpha)
+            {
+                alpha = score;
+                UpdatePV(ply, bestMove);
+
+                if(score >= beta)
+                {
+                    if(quiet)
+                    {
+                        if(killers[ply][0] != bestMove)
+                        {
+                            killers[ply][1] = killers[ply][0];
+                            killers[ply][0] = bestMove;
+                        }
+
+                        AddHistory(action, depth * depth);
+                    }
+
+                    break;
+                }
+            }
+        }
+    }
+
+    if(legal == 0)
+    {
+        return inCheck ? -kScoreMate + ply : 0;
+    }
+
+    entry.move  = bestMove;
+    entry.score = s16(TranspositionTable::ScoreToTable(bestScore, ply));
+    entry.depth = s8(depth);
+    entry.bound = bestScore >= beta          ? TranspositionTable::Bound::Lower
+                : bestScore > originalAlpha  ? TranspositionTable::Bound::Exact
+                :                              TranspositionTable::Bound::Upper;
+
+    search.table.Store(hash, entry);
+
+    return bestScore;
+}
+
+int Search::Worker::Quiesce(int alpha, int beta, int ply)
+{
+    pvLength[ply] = ply;
+
+    if(CountNode())
+    {
+        return 0;
+    }
+
+    const int standPat = Evaluate(board);
+
+    if(standPat >= beta || ply >= kMaxPly)
+    {
+        return standPat;
+    }
+
+    alpha = std::max(alpha, standPat);
+
+    const Piece::Team team = board.GetCurrentTeamTurn();
+
+    Piece::ActionCollection actions;
+    std::vector<int>        scores;
+
+    GeneratePseudoLegalActions(board, actions);
+
+    actions.erase(std::remove_if(actions.begin(), actions.end(), IsQuiet), actions.end());
+
+    OrderActions(actions, Move(), ply, scores);
+
+    int bestScore = standPat;
+
+    for(std::size_t i = 0; i < actions.size(); ++i)
+    {
+        std::size_t best = i;
+
+        for(std::size_t j = i + 1; j < actions.size(); ++j)
+        {
+            if(scores[j] > scores[best]) best = j;
+        }
+
+        std::swap(actions[i], actions[best]);
+        std::swap(scores[i],  scores[best]);
+
+        board.DoAction(actions[i]);
+
+        if(IsInCheck(board, team))
+        {
+            board.UndoAction();
+            continue;
+        }
+
+        const int score = -Quiesce(-beta, -alpha, ply + 1);
+
+        board.UndoAction();
+
+        if(search.stopped.load(std::memory_order_relaxed) && rootDepth > 1)
+        {
+            return 0;
+        }
+
+        if(score > bestScore)
+        {
+            bestScore = score;
+
+            if(score > alpha)
+            {
+                alpha = score;
+
+                if(score >= beta)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    return bestScore;
+}
+
+bool Search::Worker::CountNode()
+{
+    if(++localNodes % kNodeBatch == 0)
+    {
+        search.nodes.fetch_add(kNodeBatch, std::memory_order_relaxed);
+        search.CheckLimits();
+    }
+
+    // always finish the first depth, so there is a move to report
+
+    return rootDepth > 1 && search.stopped.load(std::memory_order_relaxed);
+}
+
+bool Search::Worker::IsRepetition(int ply) const
+{
+    for(int i = ply - 2; i >= 0; i -= 2)
+    {
+        if(hashes[i] == hashes[ply])
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Search::Worker::UpdatePV(int ply, Move move)
+{
+    pv[ply][ply] = move;
+
+    for(int i = ply + 1; i < pvLength[ply + 1]; ++i)
+    {
+        pv[ply][i] = pv[ply + 1][i];
+    }
+
+    pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+}
+
+void Search::Worker::AddHistory(const Piece::Action& action, int bonus)
+{
+    int& entry = history[SquareIndex(action.origin)][SquareIndex(action.destination)];
+
+    entry += bonus;
+
+    // halving the whole table keeps the order of the moves and can't overflow however long the search,
+    // while letting cutoffs from early depths fade
+
+    if(entry > kMaxHistory)
+    {
+        for(auto& row : history)
+        {
+            for(int& value : row)
+            {
+                value /= 2;
+            }
+        }
+    }
+}
+
+void Search::Worker::OrderActions(const Piece::ActionCollection& actions, Move ttMove, int ply, std::vector<int>& scores) const
+{
+    scores.resize(actions.size());
+
+    for(std::size_t i = 0; i < actions.size(); ++i)
+    {
+        const Piece::Action& action = actions[i];
+        const Move move = Move::FromAction(action);
+
+        int score;
+
+        if(move == ttMove)
+        {
+            score = 1 << 30;
+        }
+        else if(!IsQuiet(action))
+        {
+            // most valuable victim, least valuable attacker
+
+            score = (1 << 24) + ActionVictimValue(action) * 16 - int(action.piece.GetType());
+
+            if(action.type & Piece::Action::TypeBit_upgrade)
+            {
+                score += 1 << 8;
+            }
+        }
+        else if(move == killers[ply][0] || move == killers[ply][1])
+        {
+            score = 1 << 22;
+        }
+        else
+        {
+            score = std::min(history[SquareIndex(action.origin)][SquareIndex(action.destination)], (1 << 22) - 1);
+        }
+
+        scores[i] = score;
+    }
+}
+
+SearchInfo Search::Run(const Board& board, const SearchLimits& limits, const Callback& callback)
+{
+    this->limits = limits;
+    this->start  = Clock::now();
+
+    stopped.store(false, std::memory_order_relaxed);
+    nodes.store(0, std::memory_order_relaxed);
+
+    if(limits.newSearch)
+    {
+        table.NewSearch();
+    }
+
+    const int numThreads = std::max(limits.threads, 1);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread>             threads;
+
+    for(int i = 0; i < numThreads; ++i)
+    {
+        workers.emplace_back(new Worker(*this, board, i));
+    }
+
+    for(int i = 1; i < numThreads; ++i)
+    {
+        threads.emplace_back([&worker = *workers[i]]() { worker.Run(Callback()); });
+    }
+
+    workers[0]->Run(callback);
+
+    Stop();
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    SearchInfo info = workers[0]->GetResult();
+
+    info.nodes = nodes.load(std::memory_order_relaxed);
+
+    for(auto& worker : workers)
+    {
+        info.nodes += worker->GetUncountedNodes();
+    }
+
+    info.milliseconds = ElapsedMilliseconds();
+
+    return info;
+}
+
+void Search::CheckLimits()
+{
+    if(limits.nodes != 0 && nodes.load(std::memory_order_relaxed) >= limits.nodes)
+    {
+        Stop();
+    }
+
+    if(limits.milliseconds != 0 && ElapsedMilliseconds() >= limits.milliseconds)
+    {
+        Stop();
+    }
+}
+
+int Search::ElapsedMilliseconds() const
+{
+    return int(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+}
+
+}
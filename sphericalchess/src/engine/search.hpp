@@ -0,0 +1,107 @@
+#pragma once
+
+#include "move.hpp"
+#include "tablebase.hpp"
+#include "transpositiontable.hpp"
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace Engine
+{
+
+constexpr int kMaxPly = 128;
+
+//! @brief Pruning, reductions and extensions on top of the full width search, each can be turned off to measure it.
+struct SearchSelectivity
+{
+    bool nullMove           = true;     //!< A pass that still fails high cuts off, never with only pawns left where zugzwang is likely.
+    bool lateMoveReductions = true;     //!< Quiet moves late in the ordering are searched shallower first.
+    bool reverseFutility    = true;     //!< Evaluation far above beta near the leaves fails high without searching.
+    bool futility           = true;     //!< Quiet moves near the leaves are skipped when the evaluation is far below alpha.
+    bool checkExtensions    = true;     //!< Positions in check are searched one ply deeper.
+};
+
+struct SearchLimits
+{
+    int depth        = kMaxPly - 1;
+    u64 nodes        = 0;   //!< Total nodes of all threads, zero for no limit.
+    int milliseconds = 0;   //!< Zero for no limit.
+    int multiPV      = 1;   //!< Number of best lines to find, each line starts with a different move.
+    int threads      = 1;
+
+    bool newSearch = true;  //!< Ages the table's entries first, off when the caller calls TranspositionTable::NewSearch() itself.
+
+    SearchSelectivity selectivity;
+};
+
+//! @brief A principal variation and its score, relative to the team to move at the root.
+struct SearchLine
+{
+    int score = 0;
+    std::vector<Move> moves;
+};
+
+struct SearchInfo
+{
+    int depth        = 0;   //!< Last completed depth.
+    u64 nodes        = 0;
+    int milliseconds = 0;
+
+    std::vector<SearchLine> lines;  //!< Ranked best first, empty if there is no legal move.
+
+    u64 NodesPerSecond() const { return milliseconds > 0 ? nodes * 1000 / milliseconds : nodes * 1000; }
+};
+
+//! @brief Iterative deepening alpha-beta search of a Board.
+//!
+//! Each thread searches its own copy of the board, sharing results through the TranspositionTable.
+//! With SearchLimits::multiPV greater than one every depth is searched once per line, excluding
+//! the first move of the lines already found, all sharing the same table.
+class Search
+{
+public:
+
+    //! @brief Called by the main thread after each completed depth, with all of the lines of that depth.
+    using Callback = std::function<void(const SearchInfo&)>;
+
+    explicit Search(TranspositionTable& table) : table(table)
+    {
+    }
+
+    Search(const Search&) = delete;
+
+    //! @brief Searches @p board until one of the @p limits is reached or Stop() is called.
+    //! @returns The result of the last completed depth. At least a depth of one is always completed.
+    SearchInfo Run(const Board& board, const SearchLimits& limits, const Callback& callback = Callback());
+
+    //! @brief Stops a search running on another thread, can be called at any time.
+    void Stop() { stopped.store(true, std::memory_order_relaxed); }
+
+    //! @brief Endgame tables to probe during the search, or nullptr for none.
+    void SetTablebases(const Tablebases* tablebases) { this->tablebases = tablebases; }
+
+private:
+
+    class Worker;
+
+    using Clock = std::chrono::steady_clock;
+
+    TranspositionTable& table;
+    const Tablebases*   tablebases = nullptr;
+    SearchLimits        limits;
+    Clock::time_point   start;
+
+    std::atomic<bool> stopped { false };
+    std::atomic<u64>  nodes   { 0 };
+
+    void CheckLimits();
+    int  ElapsedMilliseconds() const;
+};
+
+}
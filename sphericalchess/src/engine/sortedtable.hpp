@@ -0,0 +1,334 @@
+#pragma once
+
+#include "../mappedfile.hpp"
+#include "../core.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Engine
+{
+
+//! @brief Read only table of entries sorted by their u64 key, memory mapped and searched in place.
+//!
+//! | Part    | Contents                                                                             |
+//! |---------|--------------------------------------------------------------------------------------|
+//! | Header  | Header of the table's owner, with at least magic, version, count and bucketBits.     |
+//! | Buckets | (1 << bucketBits) + 1 entry indices, bucket i has the keys starting with the bits i. |
+//! | Entries | count Entry, sorted by key.                                                          |
+//!
+//! The buckets narrow a lookup to a few pages of entries, so a query only touches those pages and the table
+//! can be larger than the available memory. Tables are written by a SortedTableBuilder.
+template<typename Entry>
+class SortedTable
+{
+public:
+
+    static constexpr u64 kBucketEntries = 64;   //!< Entries per bucket aimed for.
+    static constexpr int kMaxBucketBits = 26;
+
+    //! @returns The bucket bits of a table of @p count entries.
+    static int BucketBits(u64 count)
+    {
+        int bits = 0;
+
+        while(bits < kMaxBucketBits && (count >> bits) > kBucketEntries)
+        {
+            ++bits;
+        }
+
+        return bits;
+    }
+
+    static std::size_t Bucket(u64 key, int bits)
+    {
+        return bits > 0 ? std::size_t(key >> (64 - bits)) : 0;
+    }
+
+    //! @brief Maps @p filename and checks that it is a table with @p magic and @p version.
+    //! @param [in] name Of the kind of table, for errors.
+    //! @returns The header of the file.
+    //! @throws std::runtime_error When the file can't be opened or isn't a valid table.
+    template<typename Header>
+    Header Open(const char* filename, const char* name, const char (&magic)[4], u32 version)
+    {
+        Close();
+
+        file.Open(filename);
+
+        Header header;
+
+        if(file.GetSize() < sizeof(Header))
+        {
+            Close();
+            throw std::runtime_error(std::string(name) + " is too small: " + filename);
+        }
+
+        std::memcpy(&header, file.GetData(), sizeof(Header));
+
+        if(std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || header.bucketBits > u32(kMaxBucketBits))
+        {
+            Close();
+            throw std::runtime_error(std::string(name) + " is not supported: " + filename);
+        }
+
+        const std::size_t numBuckets = (std::size_t(1) << header.bucketBits) + 1;
+        const std::size_t available  = file.GetSize() - sizeof(Header);
+
+        if(available < numBuckets * sizeof(u64) || header.count > (available - numBuckets * sizeof(u64)) / sizeof(Entry))
+        {
+            Close();
+            throw std::runtime_error(std::string(name) + " is truncated: " + filename);
+        }
+
+        buckets    = reinterpret_cast<const u64*>(file.GetData() + sizeof(Header));
+        entries    = reinterpret_cast<const Entry*>(buckets + numBuckets);
+        count      = std::size_t(header.count);
+        bucketBits = int(header.bucketBits);
+
+        if(buckets[numBuckets - 1] != header.count)
+        {
+            Close();
+            throw std::runtime_error(std::string(name) + " is corrupt: " + filename);
+        }
+
+        return header;
+    }
+
+    void Close()
+    {
+        file.Close();
+
+        buckets    = nullptr;
+        entries    = nullptr;
+        count      = 0;
+        bucketBits = 0;
+    }
+
+    bool IsOpen() const { return file.IsOpen(); }
+
+    std::size_t GetNumEntries() const { return count; }
+
+    //! @returns Every entry with @p key, as a [first, last) range that is empty when there is none.
+    std::pair<const Entry*, const Entry*> Find(u64 key) const
+    {
+        if(!IsOpen())
+        {
+            return std::make_pair(entries, entries);
+        }
+
+        const std::size_t bucket = Bucket(key, bucketBits);
+
+        const Entry* first = entries + buckets[bucket];
+        const Entry* last  = entries + buckets[bucket + 1];
+
+        first = std::lower_bound(first, last, key, [](const Entry& e, u64 k) { return e.key < k; });
+        last  = std::upper_bound(first, last, key, [](u64 k, const Entry& e) { return k < e.key; });
+
+        return std::make_pair(first, last);
+    }
+
+private:
+
+    MappedFile   file;
+    const u64*   buckets    = nullptr;
+    const Entry* entries    = nullptr;
+    std::size_t  count      = 0;
+    int          bucketBits = 0;
+};
+
+//! @brief Sorts entries of any number into a SortedTable file.
+//!
+//! Entries are added in runs, each sorted into a temporary file next to the table, so only a run has to be held
+//! in memory at a time. The runs are merged into the table at the end and removed when the builder is destroyed.
+//! Policy has static functions
+//!
+//!     bool Less(const Entry& a, const Entry& b)           order of the entries, by key first
+//!     bool Combine(Entry& last, const Entry& next)        adds next into last when they are the same entry
+//!     void Finish(Entry* first, Entry* last)              reorders the entries of one key once they are merged
+template<typename Entry, typename Policy>
+class SortedTableBuilder
+{
+public:
+
+    static constexpr std::size_t kWriteEntries = 1 << 16;  //!< Entries merged before they are written.
+
+    explicit SortedTableBuilder(const char* filename) : filename(filename)
+    {
+    }
+
+    ~SortedTableBuilder()
+    {
+        for(auto& run : runs)
+        {
+            std::remove(run.c_str());
+        }
+    }
+
+    SortedTableBuilder(const SortedTableBuilder&) = delete;
+
+    std::size_t GetNumRuns()    const { return runs.size(); }
+    u64         GetNumEntries() const { return numEntries; }   //!< Added, before any are combined.
+
+    //! @brief Writes @p entries as a run, sorting them first unless they already are, then clears them.
+    //! Called from any thread.
+    //! @throws std::runtime_error When the run fails to be written.
+    void AddRun(std::vector<Entry>& entries)
+    {
+        if(entries.empty())
+        {
+            return;
+        }
+
+        if(!std::is_sorted(entries.begin(), entries.end(), Policy::Less))
+        {
+            std::sort(entries.begin(), entries.end(), Policy::Less);
+        }
+
+        std::string run;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            run = filename + ".run" + std::to_string(runs.size());
+            runs.push_back(run);
+
+            numEntries += entries.size();
+        }
+
+        std::ofstream file(run, std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char*>(entries.data()), std::streamsize(entries.size() * sizeof(Entry)));
+        file.close();
+
+        if(!file) throw std::runtime_error("Failed to write file: " + run);
+
+        entries.clear();
+    }
+
+    //! @brief Merges the runs into the table, after @p header with its count and bucketBits filled in.
+    //! @returns The number of entries in the table.
+    //! @throws std::runtime_error When a file fails to open or be written.
+    template<typename Header>
+    u64 Merge(Header header)
+    {
+        struct Cursor
+        {
+            const Entry* next;
+            const Entry* end;
+        };
+
+        std::vector<MappedFile> files(runs.size());
+        std::vector<Cursor>     cursors(runs.size());
+
+        auto Greater = [&](std::size_t a, std::size_t b) { return Policy::Less(*cursors[b].next, *cursors[a].next); };
+
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(Greater)> heap(Greater);
+
+        for(std::size_t i = 0; i < runs.size(); ++i)
+        {
+            files[i].Open(runs[i].c_str());
+
+            cursors[i].next = reinterpret_cast<const Entry*>(files[i].GetData());
+            cursors[i].end  = cursors[i].next + files[i].GetSize() / sizeof(Entry);
+
+            heap.push(i);
+        }
+
+        // sized for every entry added, as the number left once they are combined isn't known yet
+
+        header.count      = 0;
+        header.bucketBits = u32(SortedTable<Entry>::BucketBits(numEntries));
+
+        std::vector<u64> buckets((std::size_t(1) << header.bucketBits) + 1, 0);
+
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+        if(!file) throw std::runtime_error("Failed to open file: " + filename);
+
+        // the count and buckets are only known once every entry has been through, they are written again at the end
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(buckets.data()), std::streamsize(buckets.size() * sizeof(u64)));
+
+        std::vector<Entry> buffer;
+        buffer.reserve(kWriteEntries);
+
+        std::size_t key = 0;    //!< Start in the buffer of the entries of the key being merged.
+
+        auto FinishKey = [&]()
+        {
+            Policy::Finish(buffer.data() + key, buffer.data() + buffer.size());
+
+            if(buffer.size() >= kWriteEntries)
+            {
+                file.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size() * sizeof(Entry)));
+                buffer.clear();
+            }
+
+            key = buffer.size();
+        };
+
+        while(!heap.empty())
+        {
+            const std::size_t run = heap.top();
+            heap.pop();
+
+            const Entry& entry = *cursors[run].next++;
+
+            if(buffer.size() > key && buffer[key].key != entry.key)
+            {
+                FinishKey();
+            }
+
+            if(buffer.size() == key || !Policy::Combine(buffer.back(), entry))
+            {
+                buffer.push_back(entry);
+
+                ++header.count;
+                ++buckets[SortedTable<Entry>::Bucket(entry.key, int(header.bucketBits)) + 1];
+            }
+
+            if(cursors[run].next != cursors[run].end)
+            {
+                heap.push(run);
+            }
+        }
+
+        FinishKey();
+
+        file.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size() * sizeof(Entry)));
+
+        for(std::size_t i = 1; i < buckets.size(); ++i)
+        {
+            buckets[i] += buckets[i - 1];
+        }
+
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(buckets.data()), std::streamsize(buckets.size() * sizeof(u64)));
+        file.close();
+
+        if(!file) throw std::runtime_error("Failed to write file: " + filename);
+
+        return header.count;
+    }
+
+private:
+
+    std::string              filename;
+    std::mutex               mutex;
+    std::vector<std::string> runs;
+    u64                      numEntries = 0;
+};
+
+}
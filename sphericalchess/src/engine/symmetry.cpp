@@ -0,0 +1,155 @@
+#include "symmetry.hpp"
+
+#include "zobrist.hpp"
+
+namespace Engine
+{
+
+namespace
+{
+    bool IsDoublePawnPush(const Piece::Action& action)
+    {
+        return action.piece.GetType() == Piece::Type::Pawn && !action.piece.HasMoved() && std::abs(action.destination.y - action.origin.y) == 2;
+    }
+
+    //! @brief The representative with the smallest of @p hashes, indexed by Symmetry::GetIndex().
+    //! @param [in] rotate False while castling is possible, as only the mirror keeps the rules the same then.
+    CanonicalKey Smallest(const u64 hashes[Symmetry::kCount], bool rotate)
+    {
+        CanonicalKey key;
+
+        key.hash = hashes[0];
+
+        for(int i = 1; i < Symmetry::kCount; ++i)
+        {
+            const Symmetry symmetry = Symmetry::FromIndex(i);
+
+            if((rotate || symmetry.rotation == 0) && hashes[i] < key.hash)
+            {
+                key.hash     = hashes[i];
+                key.symmetry = symmetry;
+            }
+        }
+
+        return key;
+    }
+}
+
+Move Symmetry::Apply(Move move) const
+{
+    const u16 flags = move.GetData() & ~u16(0xFFF);
+
+    return Move(u16(Apply(SquareIndex(move.Origin())) | (Apply(SquareIndex(move.Destination())) << 6) | flags));
+}
+
+bool CanCastle(const Board& board)
+{
+    const int kingX = Board::kDimension / 2;
+
+    for(int y = 0; y < Board::kDimension; ++y)
+    {
+        auto& king = board.PieceAt(kingX, y);
+
+        if(king.GetType() != Piece::Type::King || king.HasMoved())
+        {
+            continue;
+        }
+
+        for(int x : { 0, Board::kDimension - 1 })
+        {
+            auto& rook = board.PieceAt(x, y);
+
+            if(rook.GetType() == Piece::Type::Rook && !rook.HasMoved() && rook.GetTeam() == king.GetTeam())
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool CanCastle(const BitboardPosition& position)
+{
+    const int kingX = Board::kDimension / 2;
+
+    for(int team = 0; team < 2; ++team)
+    {
+        const u64 king = position.pieces[team][int(Piece::Type::King)] & position.unmoved;
+
+        for(u64 bits = king; bits; bits &= bits - 1)
+        {
+            const int square = LowestBit(bits);
+
+            if(square % Board::kDimension != kingX)
+            {
+                continue;
+            }
+
+            const int row   = square - kingX;
+            const u64 rooks = (u64(1) << row) | (u64(1) << (row + Board::kDimension - 1));
+
+            if(position.pieces[team][int(Piece::Type::Rook)] & position.unmoved & rooks)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+CanonicalKey Canonicalize(const Board& board)
+{
+    u64 hashes[Symmetry::kCount];
+
+    Zobrist::HashSymmetries(board, hashes);
+
+    return Smallest(hashes, !CanCastle(board));
+}
+
+CanonicalKey Canonicalize(const BitboardPosition& position)
+{
+    u64 hashes[Symmetry::kCount];
+
+    Zobrist::HashSymmetries(position, hashes);
+
+    return Smallest(hashes, !CanCastle(position));
+}
+
+void Transform(const Board& board, Symmetry symmetry, Board& output)
+{
+    const bool enPassant = board.HasActions() && IsDoublePawnPush(board.GetLastAction());
+    const Piece::Team team = symmetry.Apply(board.GetCurrentTeamTurn());
+
+    // a pawn that can be captured en passant is put back and pushed again, so it is the last action
+
+    output.Clear(enPassant ? Piece::Opposite(team) : team);
+
+    for(int i = 0; i < Board::kDimension; ++i)
+    {
+        for(int j = 0; j < Board::kDimension; ++j)
+        {
+            if(auto& piece = board.PieceAt(i, j))
+            {
+                output.PieceAt(symmetry.Apply(Vec2i(i, j))) = Piece(symmetry.Apply(piece.GetTeam()), piece.GetType(), piece.HasMoved());
+            }
+        }
+    }
+
+    if(enPassant)
+    {
+        auto& last = board.GetLastAction();
+
+        const Piece pawn(symmetry.Apply(last.piece.GetTeam()), Piece::Type::Pawn);
+        const Vec2i origin      = symmetry.Apply(last.origin);
+        const Vec2i destination = symmetry.Apply(last.destination);
+
+        output.PieceAt(destination) = Piece();
+        output.PieceAt(origin)      = pawn;
+
+        output.DoAction(Piece::Action::MakeMove(pawn, std::make_pair(origin, destination)));
+    }
+}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include "move.hpp"
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+namespace Engine
+{
+
+//! @brief A symmetry of the rules on the sphere.
+//!
+//! Every column can be rotated by the same amount as the columns wrap around, and the rows can be
+//! mirrored while swapping the teams, as pawns and castling only depend on the rows relative to their team.
+//! Rotating is only valid while castling is still possible for neither team, as castling needs the
+//! king and rooks on their starting columns.
+struct Symmetry
+{
+    static constexpr int kCount = 2 * Board::kDimension;
+
+    int  rotation = 0;      //!< Columns added to x.
+    bool mirror   = false;  //!< Rows mirrored and teams swapped.
+
+    Symmetry() = default;
+    Symmetry(int rotation, bool mirror) : rotation(rotation), mirror(mirror)
+    {
+    }
+
+    //! @brief Unique index in the range [0, kCount), zero is the identity.
+    int GetIndex() const { return rotation + (mirror ? Board::kDimension : 0); }
+
+    static Symmetry FromIndex(int index) { return Symmetry(index % Board::kDimension, index >= Board::kDimension); }
+
+    Symmetry Inverse() const { return Symmetry((Board::kDimension - rotation) % Board::kDimension, mirror); }
+
+    Vec2i Apply(Vec2i position) const
+    {
+        return Vec2i((position.x + rotation) % Board::kDimension, mirror ? Board::kDimension - 1 - position.y : position.y);
+    }
+
+    int Apply(int square) const { return SquareIndex(Apply(SquarePosition(square))); }
+
+    Piece::Team Apply(Piece::Team team) const { return mirror ? Piece::Opposite(team) : team; }
+
+    //! @remarks Castles are only valid with no rotation, which keeps the rook's column.
+    Move Apply(Move move) const;
+
+    bool operator == (Symmetry symmetry) const { return GetIndex() == symmetry.GetIndex(); }
+    bool operator != (Symmetry symmetry) const { return GetIndex() != symmetry.GetIndex(); }
+};
+
+//! @brief Key of the class of positions equal to a board under every valid Symmetry.
+struct CanonicalKey
+{
+    u64      hash = 0;  //!< Smallest Zobrist hash over the valid symmetries.
+    Symmetry symmetry;  //!< Maps the board to the representative with that hash.
+};
+
+//! @brief Whether either team still has a king and rook on their starting squares that have never moved.
+bool CanCastle(const Board& board);
+bool CanCastle(const BitboardPosition& position);
+
+//! @brief Finds the representative of @p board with the smallest hash.
+//!
+//! Moves and positions from the board are mapped to the representative with CanonicalKey::symmetry,
+//! and back with its inverse. Scores relative to the team to move are the same for every representative.
+CanonicalKey Canonicalize(const Board& board);
+CanonicalKey Canonicalize(const BitboardPosition& position);
+
+inline u64 CanonicalHash(const Board& board)
+{
+    return Canonicalize(board).hash;
+}
+
+//! @brief Sets @p output to @p board with @p symmetry applied.
+//!
+//! Only the last action is kept, so a pawn can still be captured en passant,
+//! earlier actions are not needed for the rules and are dropped.
+void Transform(const Board& board, Symmetry symmetry, Board& output);
+
+}
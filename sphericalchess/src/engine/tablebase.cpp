@@ -0,0 +1,325 @@
+#include "tablebase.hpp"
+
+#include "move.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace Engine
+{
+
+constexpr char Tablebases::kMagic[4];
+
+namespace
+{
+    constexpr int kNumSquares = Board::kDimension * Board::kDimension;
+
+    const Piece::Type kTablePieces[] =
+    {
+        Piece::Type::Queen,
+        Piece::Type::Rook,
+        Piece::Type::Knight,
+        Piece::Type::Bishop,
+    };
+
+    char PieceLetter(Piece::Type type)
+    {
+        switch(type)
+        {
+        case Piece::Type::Queen:  return 'Q';
+        case Piece::Type::Rook:   return 'R';
+        case Piece::Type::Knight: return 'N';
+        case Piece::Type::Bishop: return 'B';
+        default:                  return '?';
+        }
+    }
+
+    //! @brief Order pieces are stored in a table, the same as kTablePieces.
+    bool TableOrder(Piece::Type a, Piece::Type b)
+    {
+        return int(a) > int(b);
+    }
+}
+
+std::vector<std::vector<Piece::Type>> Tablebases::AllTables()
+{
+    std::vector<std::vector<Piece::Type>> output;
+
+    for(auto a : kTablePieces)
+    {
+        output.push_back({ a });
+    }
+
+    for(std::size_t i = 0; i < std::size(kTablePieces); ++i)
+    {
+        for(std::size_t j = i; j < std::size(kTablePieces); ++j)
+        {
+            output.push_back({ kTablePieces[i], kTablePieces[j] });
+        }
+    }
+
+    return output;
+}
+
+std::string Tablebases::TableName(const std::vector<Piece::Type>& pieces)
+{
+    std::string name = "K";
+
+    for(auto type : pieces)
+    {
+        name.push_back(PieceLetter(type));
+    }
+
+    return name + "K";
+}
+
+u64 Tablebases::TableSize(int numPieces)
+{
+    u64 size = kKingSquares;
+
+    for(int i = 1; i < numPieces; ++i)
+    {
+        size *= kNumSquares;
+    }
+
+    return size;
+}
+
+u64 Tablebases::Index(const int squares[], int numPieces)
+{
+    // rotate every column so the king is on the first column,
+    // then flip the rows so it is in the lower half of the board
+
+    const Vec2i king = SquarePosition(squares[0]);
+    const bool  flip = king.y >= Board::kDimension / 2;
+
+    auto Transform = [&](int square)
+    {
+        Vec2i p = SquarePosition(square);
+
+        p.x = (p.x - king.x + Board::kDimension) % Board::kDimension;
+
+        if(flip)
+        {
+            p.y = Board::kDimension - 1 - p.y;
+        }
+
+        return p;
+    };
+
+    u64 index = u64(Transform(squares[0]).y);
+
+    for(int i = 1; i < numPieces; ++i)
+    {
+        index = index * kNumSquares + u64(SquareIndex(Transform(squares[i])));
+    }
+
+    return index;
+}
+
+void Tablebases::Squares(u64 index, int numPieces, int squares[])
+{
+    for(int i = numPieces - 1; i > 0; --i)
+    {
+        squares[i] = int(index % kNumSquares);
+        index /= kNumSquares;
+    }
+
+    squares[0] = SquareIndex(Vec2i(0, int(index)));
+}
+
+auto Tablebases::ValueResult(Value value) -> Result
+{
+    Result result;
+
+    if(value != 0)
+    {
+        result.distance = value - 1;
+        result.outcome  = (result.distance % 2) ? Outcome::Win : Outcome::Loss;
+    }
+
+    return result;
+}
+
+int Tablebases::Open(const std::string& directory)
+{
+    Close();
+
+    for(auto& pieces : AllTables())
+    {
+        const std::string filename = directory + "/" + TableName(pieces) + ".sctb";
+
+        if(!std::ifstream(filename))
+        {
+            continue;
+        }
+
+        std::unique_ptr<Table> table(new Table);
+
+        table->pieces = pieces;
+        table->file.Open(filename.c_str());
+
+        Header header;
+
+        if(table->file.GetSize() < sizeof(Header))
+        {
+            throw std::runtime_error("Tablebase is too small: " + filename);
+        }
+
+        std::memcpy(&header, table->file.GetData(), sizeof(Header));
+
+        const int numPieces = int(pieces.size()) + 2;
+
+        if(std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+           header.numPieces != u32(numPieces) || header.size != TableSize(numPieces) || header.blockSize != kBlockSize)
+        {
+            throw std::runtime_error("Not a supported tablebase: " + filename);
+        }
+
+        const u64 numBlocks   = (header.size + kBlockSize - 1) / kBlockSize;
+        const u64 offsetsSize = 2 * (numBlocks + 1) * sizeof(u32);
+
+        if(table->file.GetSize() < sizeof(Header) + offsetsSize)
+        {
+            throw std::runtime_error("Tablebase is truncated: " + filename);
+        }
+
+        auto offsets = reinterpret_cast<const u32*>(table->file.GetData() + sizeof(Header));
+
+        table->size       = header.size;
+        table->offsets[0] = offsets;
+        table->offsets[1] = offsets + numBlocks + 1;
+        table->runs       = table->file.GetData() + sizeof(Header) + offsetsSize;
+
+        if(sizeof(Header) + offsetsSize + table->offsets[1][numBlocks] > table->file.GetSize())
+        {
+            throw std::runtime_error("Tablebase is truncated: " + filename);
+        }
+
+        tables.push_back(std::move(table));
+    }
+
+    return GetNumTables();
+}
+
+void Tablebases::Close()
+{
+    tables.clear();
+}
+
+bool Tablebases::Probe(const Board& board, Result& result) const
+{
+    int squares[2][kMaxPieces];         // per team, king first
+    int count[2] = { 1, 1 };
+
+    Piece::Type pieces[2][kMaxPieces - 2];
+
+    bool kings[2]         = {};
+    bool unmovedKings[2]  = {};
+    bool unmovedRooks[2]  = {};
+
+    for(int i = 0; i < Board::kDimension; ++i)
+    {
+        for(int j = 0; j < Board::kDimension; ++j)
+        {
+            if(auto& piece = board.PieceAt(i, j))
+            {
+                const int team = int(piece.GetTeam());
+
+                switch(piece.GetType())
+                {
+                case Piece::Type::Pawn:
+                {
+                    return false;
+                }
+                case Piece::Type::King:
+                {
+                    squares[team][0] = SquareIndex(Vec2i(i, j));
+                    kings[team]        = true;
+                    unmovedKings[team] = !piece.HasMoved();
+                    break;
+                }
+                default:
+                {
+                    if(count[team] == kMaxPieces - 1)
+                    {
+                        return false;
+                    }
+
+                    pieces[team][count[team] - 1] = piece.GetType();
+                    squares[team][count[team]++]  = SquareIndex(Vec2i(i, j));
+
+                    unmovedRooks[team] |= piece.GetType() == Piece::Type::Rook && !piece.HasMoved();
+                    break;
+                }
+                }
+            }
+        }
+    }
+
+    if(!kings[0] || !kings[1] || (count[0] > 1 && count[1] > 1))
+    {
+        return false;
+    }
+
+    const int strong = count[0] > 1 ? 0 : 1;
+    const int weak   = 1 - strong;
+
+    if(count[strong] == 1)
+    {
+        result = Result(); // only the kings are left
+        return true;
+    }
+
+    if(unmovedKings[strong] && unmovedRooks[strong])
+    {
+        return false; // could still castle, which the tables don't allow
+    }
+
+    // sort the pieces into table order, keeping their squares alongside
+
+    const int numPieces = count[strong] + 1;
+
+    if(numPieces == kMaxPieces && TableOrder(pieces[strong][1], pieces[strong][0]))
+    {
+        std::swap(pieces[strong][0], pieces[strong][1]);
+        std::swap(squares[strong][1], squares[strong][2]);
+    }
+
+    squares[strong][numPieces - 1] = squares[weak][0];
+
+    for(auto& table : tables)
+    {
+        if(std::equal(table->pieces.begin(), table->pieces.end(), pieces[strong], pieces[strong] + numPieces - 2))
+        {
+            const int side = int(board.GetCurrentTeamTurn()) == strong ? 0 : 1;
+
+            result = ValueResult(table->Read(side, Index(squares[strong], numPieces)));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+auto Tablebases::Table::Read(int side, u64 index) const -> Value
+{
+    const u64 block = index / kBlockSize;
+
+    u32 position  = u32(index % kBlockSize);
+    const u8* run = runs + offsets[side][block];
+
+    // each run is a count followed by the value
+
+    while(position >= run[0])
+    {
+        position -= run[0];
+        run += 2;
+    }
+
+    return run[1];
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../game/board.hpp"
+#include "../mappedfile.hpp"
+#include "../core.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+//! @brief Endgame tables of a king with one or two pieces (no pawns) against a lone king.
+//!
+//! Every position stores its distance to mate in plies, or that it is a draw. Positions are indexed
+//! relative to the sphere's symmetries: rotating every column, and flipping the rows as there are no pawns,
+//! so the stronger team's king only needs 4 squares instead of 64. Castling is not possible in the tables.
+//!
+//! Tables are memory mapped and compressed as runs of equal values in fixed size blocks,
+//! a probe scans the runs of a single block.
+class Tablebases
+{
+public:
+
+    enum class Outcome
+    {
+        Draw,
+        Win,    //!< The team to move delivers checkmate.
+        Loss,   //!< The team to move is checkmated.
+    };
+
+    struct Result
+    {
+        Outcome outcome  = Outcome::Draw;
+        int     distance = 0;   //!< Plies until checkmate with best play, zero for a draw.
+    };
+
+    static constexpr int kMinPieces = 3;
+    static constexpr int kMaxPieces = 4;
+
+    static constexpr int kKingSquares = Board::kDimension / 2; //!< King is always on the first column, in the lower half of the rows.
+
+    //! @brief Value stored per position, zero for a draw, otherwise distance to mate plus one.
+    using Value = u8;
+
+    struct Header
+    {
+        char magic[4];
+        u32  version;
+        u32  numPieces;
+        u32  blockSize;     //!< Positions per compressed block.
+        u64  size;          //!< Positions per team to move.
+    };
+
+    static constexpr char kMagic[4]  = { 'S', 'C', 'T', 'B' };
+    static constexpr u32  kVersion   = 1;
+    static constexpr u32  kBlockSize = 4096;
+
+    //! @brief Opens every table that exists in @p directory, missing tables are skipped.
+    //! @returns The number of tables opened.
+    int Open(const std::string& directory);
+    void Close();
+
+    int GetNumTables() const { return int(tables.size()); }
+
+    //! @brief Looks up @p board, including positions with only the two kings left.
+    //! @returns False if the position isn't covered by an open table.
+    bool Probe(const Board& board, Result& result) const;
+
+
+    // Indexing shared with TablebaseGenerator, squares are ordered as
+    // the stronger team's king, its pieces in table order and then the lone king.
+
+    //! @brief Every table that can exist, pieces of the stronger team excluding its king, three piece tables first.
+    static std::vector<std::vector<Piece::Type>> AllTables();
+
+    static std::string TableName(const std::vector<Piece::Type>& pieces);
+
+    static u64  TableSize(int numPieces);
+    static u64  Index(const int squares[], int numPieces);
+    static void Squares(u64 index, int numPieces, int squares[]);
+
+    static Result ValueResult(Value value);
+
+private:
+
+    struct Table
+    {
+        std::vector<Piece::Type> pieces;
+        MappedFile               file;
+
+        u64        size   = 0;
+        const u32* offsets[2];  //!< Block offsets per team to move, zero for the stronger team.
+        const u8*  runs   = nullptr;
+
+        Value Read(int side, u64 index) const;
+    };
+
+    std::vector<std::unique_ptr<Table>> tables;
+};
+
+}
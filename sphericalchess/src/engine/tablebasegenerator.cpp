@@ -0,0 +1,394 @@
+#include "tablebasegenerator.hpp"
+
+#include "move.hpp"
+#include "movegen.hpp"
+#include "threads.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr u64 kChunkSize = 1024;
+
+    constexpr Piece::Team kStrong = Piece::Team::White;
+    constexpr Piece::Team kWeak   = Piece::Team::Black;
+}
+
+TablebaseGenerator::TablebaseGenerator(const std::vector<Piece::Type>& pieces, const Tablebases& smaller, int threads)
+    : pieces(pieces)
+    , smaller(smaller)
+    , numPieces(int(pieces.size()) + 2)
+    , numThreads(std::max(threads, 1))
+    , size(Tablebases::TableSize(numPieces))
+{
+    assert(numPieces >= Tablebases::kMinPieces && numPieces <= Tablebases::kMaxPieces);
+}
+
+template<typename F>
+void TablebaseGenerator::ParallelFor(u64 count, F function)
+{
+    std::atomic<u64> next { 0 };
+
+    RunOnThreads(numThreads, [&](int)
+    {
+        for(u64 begin; (begin = next.fetch_add(kChunkSize)) < count; )
+        {
+            function(begin, std::min(begin + kChunkSize, count));
+        }
+    },
+    [&] { next = count; });
+}
+
+void TablebaseGenerator::Generate()
+{
+    for(auto& side : values)
+    {
+        side.reset(new std::atomic<Value>[size]);
+    }
+
+    remaining.reset(new std::atomic<s16>[size]);
+
+    maxDistance = 0;
+    numWins     = 0;
+
+    std::mutex mutex;
+
+    std::vector<u64>              frontier;  // positions resolved at the current distance
+    std::vector<std::vector<u64>> captures;  // lone king positions per distance, with a capture that loses in that many plies
+
+    // find every checkmate, and count the moves of the lone king that still need to be resolved
+
+    ParallelFor(size, [&](u64 begin, u64 end)
+    {
+        Board board;
+        Piece::ActionCollection actions;
+
+        std::vector<u64>                   localFrontier;
+        std::vector<std::pair<int, u64>>   localCaptures;
+
+        for(u64 index = begin; index < end; ++index)
+        {
+            values[0][index].store(0, std::memory_order_relaxed);
+            values[1][index].store(0, std::memory_order_relaxed);
+            remaining[index].store(-1, std::memory_order_relaxed);
+
+            if(!MakeBoard(index, kWeak, board))
+            {
+                continue;
+            }
+
+            actions.clear();
+            GenerateLegalActions(board, actions);
+
+            if(actions.empty())
+            {
+                if(IsInCheck(board, kWeak))
+                {
+                    values[1][index].store(1, std::memory_order_relaxed);
+                    remaining[index].store(0, std::memory_order_relaxed);
+                    localFrontier.push_back(index);
+                }
+
+                continue;
+            }
+
+            s16  count = 0;
+            bool draw  = false;
+
+            for(auto& action : actions)
+            {
+                if(action.type & Piece::Action::TypeBit_capture)
+                {
+                    Tablebases::Result result;
+
+                    board.DoAction(action);
+
+                    bool found = smaller.Probe(board, result);
+
+                    board.UndoAction();
+
+                    if(!found)
+                    {
+                        throw std::runtime_error("Missing smaller tablebase for " + Tablebases::TableName(pieces));
+                    }
+
+                    if(result.outcome != Tablebases::Outcome::Win)
+                    {
+                        draw = true;
+                        break;
+                    }
+
+                    localCaptures.emplace_back(result.distance, index);
+                }
+
+                ++count;
+            }
+
+            remaining[index].store(draw ? -1 : count, std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        frontier.insert(frontier.end(), localFrontier.begin(), localFrontier.end());
+
+        for(auto& capture : localCaptures)
+        {
+            if(capture.first >= int(captures.size()))
+            {
+                captures.resize(capture.first + 1);
+            }
+
+            captures[capture.first].push_back(capture.second);
+        }
+    });
+
+    // resolve one ply further each iteration, from the positions resolved in the previous one
+
+    for(int distance = 0; !frontier.empty() || distance < int(captures.size()); ++distance)
+    {
+        if(distance + 2 > 0xFF)
+        {
+            throw std::runtime_error("Tablebase distance to mate is too large to store: " + Tablebases::TableName(pieces));
+        }
+
+        const Value value = Value(distance + 2);
+
+        std::vector<u64> next;
+
+        if(distance % 2 == 0)
+        {
+            // the lone king is checkmated in distance plies, any move of
+            // the stronger team into one of these positions wins
+
+            ParallelFor(frontier.size(), [&](u64 begin, u64 end)
+            {
+                Board board;
+                std::vector<u64> localNext;
+
+                for(u64 i = begin; i < end; ++i)
+                {
+                    int squares[Tablebases::kMaxPieces];
+
+                    Tablebases::Squares(frontier[i], numPieces, squares);
+                    MakeBoard(frontier[i], kWeak, board);
+
+                    for(int slot = 0; slot < numPieces - 1; ++slot)
+                    {
+                        const Vec2i position = SquarePosition(squares[slot]);
+
+                        for(auto& action : board.PieceAt(position).CalculatePossibleActions(board, position))
+                        {
+                            if(action.type & Piece::Action::TypeBit_capture)
+                            {
+                                continue;
+                            }
+
+                            board.DoAction(action);
+
+                            const bool legal = !IsInCheck(board, kWeak);
+
+                            board.UndoAction();
+
+                            if(!legal)
+                            {
+                                continue;
+                            }
+
+                            int previous[Tablebases::kMaxPieces];
+
+                            std::copy(squares, squares + numPieces, previous);
+                            previous[slot] = SquareIndex(action.destination);
+
+                            const u64 index = Tablebases::Index(previous, numPieces);
+
+                            Value expected = 0;
+
+                            if(values[0][index].compare_exchange_strong(expected, value, std::memory_order_relaxed))
+                            {
+                                localNext.push_back(index);
+                            }
+                        }
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                next.insert(next.end(), localNext.begin(), localNext.end());
+            });
+
+            numWins += next.size();
+        }
+        else
+        {
+            // the stronger team checkmates in distance plies, the lone king
+            // loses once every one of its moves leads to such a position
+
+            auto Resolve = [&](u64 index, std::vector<u64>& localNext)
+            {
+                if(remaining[index].load(std::memory_order_relaxed) > 0 && remaining[index].fetch_sub(1, std::memory_order_relaxed) == 1)
+                {
+                    values[1][index].store(value, std::memory_order_relaxed);
+                    localNext.push_back(index);
+                }
+            };
+
+            ParallelFor(frontier.size(), [&](u64 begin, u64 end)
+            {
+                Board board;
+                std::vector<u64> localNext;
+
+                for(u64 i = begin; i < end; ++i)
+                {
+                    int squares[Tablebases::kMaxPieces];
+
+                    Tablebases::Squares(frontier[i], numPieces, squares);
+                    MakeBoard(frontier[i], kStrong, board);
+
+                    const Vec2i position = SquarePosition(squares[numPieces - 1]);
+
+                    for(auto& action : board.PieceAt(position).CalculatePossibleActions(board, position))
+                    {
+                        if(action.type & Piece::Action::TypeBit_capture)
+                        {
+                            continue;
+                        }
+
+                        int previous[Tablebases::kMaxPieces];
+
+                        std::copy(squares, squares + numPieces, previous);
+                        previous[numPieces - 1] = SquareIndex(action.destination);
+
+                        Resolve(Tablebases::Index(previous, numPieces), localNext);
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                next.insert(next.end(), localNext.begin(), localNext.end());
+            });
+
+            if(distance < int(captures.size()))
+            {
+                auto& list = captures[distance];
+
+                ParallelFor(list.size(), [&](u64 begin, u64 end)
+                {
+                    std::vector<u64> localNext;
+
+                    for(u64 i = begin; i < end; ++i)
+                    {
+                        Resolve(list[i], localNext);
+                    }
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    next.insert(next.end(), localNext.begin(), localNext.end());
+                });
+            }
+        }
+
+        if(!next.empty())
+        {
+            maxDistance = distance + 1;
+        }
+
+        frontier = std::move(next);
+    }
+}
+
+void TablebaseGenerator::Write(const char* filename) const
+{
+    const u64 numBlocks = (size + Tablebases::kBlockSize - 1) / Tablebases::kBlockSize;
+
+    std::vector<u32> offsets;
+    std::vector<u8>  runs;
+
+    offsets.reserve(2 * (numBlocks + 1));
+
+    for(auto& side : values)
+    {
+        for(u64 block = 0; block < numBlocks; ++block)
+        {
+            offsets.push_back(u32(runs.size()));
+
+            const u64 end = std::min(size, (block + 1) * Tablebases::kBlockSize);
+
+            for(u64 index = block * Tablebases::kBlockSize; index < end; )
+            {
+                const Value value = side[index].load(std::memory_order_relaxed);
+
+                u8 count = 0;
+
+                while(index < end && count < 0xFF && side[index].load(std::memory_order_relaxed) == value)
+                {
+                    ++count;
+                    ++index;
+                }
+
+                runs.push_back(count);
+                runs.push_back(value);
+            }
+        }
+
+        offsets.push_back(u32(runs.size()));
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+
+    if(!file) throw std::runtime_error("Failed to open file: " + std::string(filename));
+
+    Tablebases::Header header;
+
+    std::copy(std::begin(Tablebases::kMagic), std::end(Tablebases::kMagic), header.magic);
+    header.version   = Tablebases::kVersion;
+    header.numPieces = u32(numPieces);
+    header.blockSize = Tablebases::kBlockSize;
+    header.size      = size;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(u32));
+    file.write(reinterpret_cast<const char*>(runs.data()), runs.size());
+    file.close();
+
+    if(!file) throw std::runtime_error("Failed to write file: " + std::string(filename));
+}
+
+bool TablebaseGenerator::MakeBoard(u64 index, Piece::Team team, Board& board) const
+{
+    int squares[Tablebases::kMaxPieces];
+
+    Tablebases::Squares(index, numPieces, squares);
+
+    for(int i = 0; i < numPieces; ++i)
+    {
+        for(int j = i + 1; j < numPieces; ++j)
+        {
+            if(squares[i] == squares[j])
+            {
+                return false;
+            }
+        }
+    }
+
+    // every piece has moved so castling is never possible
+
+    board.Clear(team);
+
+    board.PieceAt(SquarePosition(squares[0])) = Piece(kStrong, Piece::Type::King, true);
+
+    for(int i = 0; i < int(pieces.size()); ++i)
+    {
+        board.PieceAt(SquarePosition(squares[i + 1])) = Piece(kStrong, pieces[i], true);
+    }
+
+    board.PieceAt(SquarePosition(squares[numPieces - 1])) = Piece(kWeak, Piece::Type::King, true);
+
+    return !IsInCheck(board, Piece::Opposite(team));
+}
+
+}
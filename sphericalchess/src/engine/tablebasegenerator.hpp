@@ -0,0 +1,60 @@
+#pragma once
+
+#include "tablebase.hpp"
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace Engine
+{
+
+//! @brief Solves a single table for Tablebases by retrograde analysis.
+//!
+//! Starting from every checkmate, positions are resolved one ply at a time by unmaking moves,
+//! which are the same as the moves of the pieces as every move on the sphere can be reversed.
+//! Each ply is spread over all of the threads. Captures of the lone king lead into smaller tables,
+//! which must already be open in the Tablebases given to the generator.
+class TablebaseGenerator
+{
+public:
+
+    TablebaseGenerator(const std::vector<Piece::Type>& pieces, const Tablebases& smaller, int threads);
+
+    void Generate();
+
+    //! @throws std::runtime_error When the file fails to open or be written, such as when the disk is full.
+    void Write(const char* filename) const;
+
+    int GetMaxDistance() const { return maxDistance; }
+    u64 GetNumWins()     const { return numWins; }
+
+private:
+
+    using Value = Tablebases::Value;
+
+    std::vector<Piece::Type> pieces;    //!< Of the stronger team, excluding its king.
+    const Tablebases&        smaller;
+
+    int numPieces;
+    int numThreads;
+    u64 size;
+
+    std::unique_ptr<std::atomic<Value>[]> values[2];   //!< Per team to move, zero for the stronger team.
+    std::unique_ptr<std::atomic<s16>[]>   remaining;   //!< Moves of the lone king not yet known to lose, or negative if it can draw.
+
+    int maxDistance = 0;
+    u64 numWins     = 0;
+
+    //! @brief Sets up the position at @p index with @p team to move, the stronger team is always white.
+    //! @returns False if the position isn't legal.
+    bool MakeBoard(u64 index, Piece::Team team, Board& board) const;
+
+    template<typename F>
+    void ParallelFor(u64 count, F function);
+};
+
+}
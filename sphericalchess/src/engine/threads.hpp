@@ -0,0 +1,66 @@
+#pragma once
+
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+
+//! @brief Calls @p function(thread) on @p numThreads threads, thread 0 being the calling one, and waits for them all.
+//!
+//! The first exception thrown calls @p stop so the other threads can return early, and is rethrown once they
+//! all have, any later ones are dropped.
+template<typename F, typename S>
+void RunOnThreads(int numThreads, F function, S stop)
+{
+    std::mutex         mutex;
+    std::exception_ptr error;
+
+    auto Work = [&](int thread)
+    {
+        try
+        {
+            function(thread);
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if(!error)
+            {
+                error = std::current_exception();
+                stop();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for(int thread = 1; thread < numThreads; ++thread)
+    {
+        threads.emplace_back(Work, thread);
+    }
+
+    Work(0);
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+//! @brief RunOnThreads() for work that has nothing to stop early.
+template<typename F>
+void RunOnThreads(int numThreads, F function)
+{
+    RunOnThreads(numThreads, function, [] {});
+}
+
+}
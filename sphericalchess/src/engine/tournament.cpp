@@ -0,0 +1,249 @@
+#include "tournament.hpp"
+
+#include "gamerecord.hpp"
+#include "movegen.hpp"
+#include "threads.hpp"
+#include "transpositiontable.hpp"
+#include "zobrist.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace Engine
+{
+
+namespace
+{
+    //! @brief Expected score of the stronger player for an Elo difference.
+    double EloToScore(double elo)
+    {
+        return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+    }
+
+    double ScoreToElo(double score)
+    {
+        score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+        return -400.0 * std::log10(1.0 / score - 1.0);
+    }
+
+    //! @brief Engine of one player, reused by every game played on the same thread.
+    struct Player
+    {
+        TranspositionTable table;
+        Search             search;
+
+        explicit Player(const TournamentPlayer& player) : table(player.tableMegabytes), search(table)
+        {
+        }
+    };
+}
+
+double TournamentStats::GetScore() const
+{
+    const int games = GetGames();
+
+    return games > 0 ? (wins + 0.5 * draws) / games : 0.5;
+}
+
+double TournamentStats::GetElo() const
+{
+    return ScoreToElo(GetScore());
+}
+
+double TournamentStats::GetEloError() const
+{
+    const int games = GetGames();
+
+    if(games == 0)
+    {
+        return 0.0;
+    }
+
+    const double score    = GetScore();
+    const double variance = (wins + 0.25 * draws) / games - score * score;
+    const double margin   = 1.96 * std::sqrt(variance / games);
+
+    return (ScoreToElo(score + margin) - ScoreToElo(score - margin)) / 2.0;
+}
+
+double TournamentStats::LogLikelihoodRatio(double elo0, double elo1) const
+{
+    const int games = GetGames();
+
+    if(wins == 0 || losses == 0)
+    {
+        return 0.0; // the variance is meaningless until both have happened at least once
+    }
+
+    const double score    = GetScore();
+    const double variance = (wins + 0.25 * draws) / games - score * score;
+
+    const double score0 = EloToScore(elo0);
+    const double score1 = EloToScore(elo1);
+
+    return games * (score1 - score0) * (2.0 * score - score0 - score1) / (2.0 * variance);
+}
+
+Tournament::Tournament(const TournamentSettings& settings, const std::vector<std::vector<Move>>& openings)
+    : settings(settings)
+    , openings(openings)
+{
+    if(this->openings.empty())
+    {
+        this->openings.emplace_back();
+    }
+}
+
+TournamentStats Tournament::Run(const char* filename, const Callback& callback)
+{
+    GameRecordWriter file(filename);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const double lowerBound = std::log(settings.beta / (1.0 - settings.alpha));
+    const double upperBound = std::log((1.0 - settings.beta) / settings.alpha);
+
+    stopped.store(false, std::memory_order_relaxed);
+
+    TournamentStats stats;
+
+    std::atomic<int> next { 0 };
+    std::mutex       mutex;
+
+    RunOnThreads(settings.concurrency, [&](int)
+    {
+        std::unique_ptr<Player> players[2] =
+        {
+            std::unique_ptr<Player>(new Player(settings.players[0])),
+            std::unique_ptr<Player>(new Player(settings.players[1])),
+        };
+
+        Board board;
+        Piece::ActionCollection actions;
+        std::vector<u64>        hashes;
+        std::vector<Move>       played;
+
+        for(int game; !stopped.load(std::memory_order_relaxed) && (game = next.fetch_add(1)) < settings.games; )
+        {
+            // each opening is played twice, the first player taking white then black
+
+            const auto& opening = openings[(game / 2) % openings.size()];
+            const int   white   = game % 2;
+
+            board = Board();
+            hashes.clear();
+            played.clear();
+
+            for(Move move : opening)
+            {
+                actions.clear();
+                GenerateLegalActions(board, actions);
+
+                auto action = Move::FindAction(move, actions);
+
+                if(!action) throw std::runtime_error("Illegal move in opening: " + move.ToString());
+
+                board.DoAction(*action);
+                hashes.push_back(Zobrist::Hash(board));
+                played.push_back(move);
+            }
+
+            for(auto& player : players)
+            {
+                player->table.Clear();
+            }
+
+            Board::Result result = Board::Result::Draw;
+            int plies = int(opening.size());
+
+            for(; plies < settings.maxPlies; ++plies)
+            {
+                actions.clear();
+                GenerateLegalActions(board, actions);
+
+                const Piece::Team team = board.GetCurrentTeamTurn();
+
+                if(actions.empty())
+                {
+                    if(IsInCheck(board, team))
+                    {
+                        result = team == Piece::Team::White ? Board::Result::BlackWins : Board::Result::WhiteWins;
+                    }
+
+                    break;
+                }
+
+                if(!hashes.empty() && std::count(hashes.begin(), hashes.end(), hashes.back()) >= 3)
+                {
+                    break;
+                }
+
+                const int index = (team == Piece::Team::White) == (white == 0) ? 0 : 1;
+                const SearchInfo info = players[index]->search.Run(board, settings.players[index].limits);
+
+                const Move move = info.lines.front().moves.front();
+
+                board.DoAction(*Move::FindAction(move, actions));
+                hashes.push_back(Zobrist::Hash(board));
+                played.push_back(move);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            file.Begin();
+            file.AddTag("White", settings.players[white].name);
+            file.AddTag("Black", settings.players[white ^ 1].name);
+            file.AddTag("Round", std::to_string(game + 1));
+
+            for(Move move : played)
+            {
+                file.AddMove(move);
+            }
+
+            file.End(result);
+
+            if(result == Board::Result::Draw)
+            {
+                ++stats.draws;
+            }
+            else if((result == Board::Result::WhiteWins) == (white == 0))
+            {
+                ++stats.wins;
+            }
+            else
+            {
+                ++stats.losses;
+            }
+
+            stats.plies       += plies;
+            stats.milliseconds = u64(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+            if(settings.sprt)
+            {
+                stats.llr = stats.LogLikelihoodRatio(settings.elo0, settings.elo1);
+
+                if     (stats.llr <= lowerBound) stats.decision = TournamentStats::Decision::H0;
+                else if(stats.llr >= upperBound) stats.decision = TournamentStats::Decision::H1;
+
+                if(stats.decision != TournamentStats::Decision::None)
+                {
+                    Stop();
+                }
+            }
+
+            if(callback)
+            {
+                callback(stats);
+            }
+        }
+    },
+    [&] { Stop(); });
+
+    return stats;
+}
+
+}
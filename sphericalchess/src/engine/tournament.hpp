@@ -0,0 +1,102 @@
+#pragma once
+
+#include "move.hpp"
+#include "search.hpp"
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+struct TournamentPlayer
+{
+    std::string  name;
+    SearchLimits limits;                //!< Per move, SearchLimits::threads are used on top of the concurrent games.
+    int          tableMegabytes = 16;   //!< Size of the TranspositionTable each concurrent game uses for this player.
+};
+
+struct TournamentSettings
+{
+    TournamentPlayer players[2];
+
+    int games       = 1000;     //!< Played in pairs from the same opening with the colours swapped.
+    int concurrency = 1;        //!< Games played at the same time, each on its own thread.
+    int maxPlies    = 400;      //!< Games still going after this many plies are a draw.
+
+    //! Sequential probability ratio test of the first player being elo0 (H0) or elo1 (H1) stronger,
+    //! the tournament ends as soon as either is accepted.
+    bool   sprt  = false;
+    double elo0  = 0.0;
+    double elo1  = 5.0;
+    double alpha = 0.05;        //!< Chance of accepting H1 when H0 is true.
+    double beta  = 0.05;        //!< Chance of accepting H0 when H1 is true.
+};
+
+//! @brief Results so far, from the first player's point of view.
+struct TournamentStats
+{
+    enum class Decision
+    {
+        None,
+        H0,     //!< Accepted that the first player is elo0 stronger.
+        H1,     //!< Accepted that the first player is elo1 stronger.
+    };
+
+    int wins   = 0;
+    int draws  = 0;
+    int losses = 0;
+
+    u64 plies        = 0;
+    u64 milliseconds = 0;
+
+    double   llr      = 0.0;    //!< Log likelihood ratio of the SPRT.
+    Decision decision = Decision::None;
+
+    int    GetGames() const { return wins + draws + losses; }
+    double GetScore() const;    //!< In the range [0, 1], draws count half.
+
+    double GetElo() const;
+    double GetEloError() const; //!< Half the width of the 95% confidence interval.
+
+    double GetGamesPerHour() const { return milliseconds > 0 ? GetGames() * 3600000.0 / milliseconds : 0.0; }
+
+    //! @brief Generalized SPRT using the normal approximation of the win/draw/loss distribution.
+    double LogLikelihoodRatio(double elo0, double elo1) const;
+};
+
+//! @brief Plays engine against engine games on a pool of threads.
+//!
+//! Games are streamed to a GameRecordWriter file as they finish, in the order they finish, with the opening
+//! included and tagged with the "White" and "Black" player names and the "Round", the game's number.
+class Tournament
+{
+public:
+
+    //! @brief Called after every game finishes, from the thread that played it, one at a time.
+    using Callback = std::function<void(const TournamentStats&)>;
+
+    //! @param [in] openings Moves from the start position, every game starts with no moves if empty.
+    Tournament(const TournamentSettings& settings, const std::vector<std::vector<Move>>& openings);
+
+    //! @brief Plays every game, or until the SPRT is decided or Stop() is called.
+    //! @throws std::runtime_error When the file fails to open or an opening has an illegal move.
+    TournamentStats Run(const char* filename, const Callback& callback = Callback());
+
+    //! @brief Lets the games being played finish, without starting any more.
+    void Stop() { stopped.store(true, std::memory_order_relaxed); }
+
+private:
+
+    TournamentSettings             settings;
+    std::vector<std::vector<Move>> openings;
+
+    std::atomic<bool> stopped { false };
+};
+
+}
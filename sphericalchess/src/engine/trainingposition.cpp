@@ -0,0 +1,125 @@
+#include "trainingposition.hpp"
+
+#include "move.hpp"
+
+#include <cassert>
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr u8 kUnmovedRook = 6;
+    constexpr u8 kUnmovedKing = 7;
+    constexpr u8 kBlackBit    = 8;
+
+    u8 PieceCode(const Piece& piece)
+    {
+        u8 code = u8(piece.GetType());
+
+        if(!piece.HasMoved())
+        {
+            if     (piece.GetType() == Piece::Type::Rook) code = kUnmovedRook;
+            else if(piece.GetType() == Piece::Type::King) code = kUnmovedKing;
+        }
+
+        return piece.GetTeam() == Piece::Team::Black ? code | kBlackBit : code;
+    }
+
+    Piece CodePiece(u8 code, int row)
+    {
+        const Piece::Team team = (code & kBlackBit) ? Piece::Team::Black : Piece::Team::White;
+
+        code &= ~kBlackBit;
+
+        switch(code)
+        {
+        case kUnmovedRook: return Piece(team, Piece::Type::Rook);
+        case kUnmovedKing: return Piece(team, Piece::Type::King);
+        default: break;
+        }
+
+        // pawns only move forward, so a pawn on its starting row has never moved
+        const Piece::Type type = Piece::Type(code);
+        const int startingRow  = team == Piece::Team::White ? 1 : Board::kDimension - 2;
+
+        return Piece(team, type, type != Piece::Type::Pawn || row != startingRow);
+    }
+}
+
+TrainingPosition TrainingPosition::Pack(const Board& board)
+{
+    TrainingPosition output;
+
+    int count = 0;
+
+    for(int square = 0; square < Board::kDimension * Board::kDimension; ++square)
+    {
+        if(auto& piece = board.PieceAt(SquarePosition(square)))
+        {
+            assert(count < 32);
+
+            output.occupancy |= u64(1) << square;
+            output.pieces[count / 2] |= PieceCode(piece) << ((count % 2) * 4);
+            ++count;
+        }
+    }
+
+    if(board.GetCurrentTeamTurn() == Piece::Team::Black)
+    {
+        output.flags |= 1;
+    }
+
+    if(board.HasActions())
+    {
+        auto& last = board.GetLastAction();
+
+        if(last.piece.GetType() == Piece::Type::Pawn && !last.piece.HasMoved() && std::abs(last.destination.y - last.origin.y) == 2)
+        {
+            output.flags |= u8((last.destination.x + 1) << 1);
+        }
+    }
+
+    return output;
+}
+
+void TrainingPosition::Unpack(Board& board) const
+{
+    const Piece::Team team      = (flags & 1) ? Piece::Team::Black : Piece::Team::White;
+    const int         enPassant = (flags >> 1) & 15;
+
+    // a pawn that can be captured en passant is put back and pushed again, so it is the last action
+
+    board.Clear(enPassant ? Piece::Opposite(team) : team);
+
+    int count = 0;
+
+    for(int square = 0; square < Board::kDimension * Board::kDimension; ++square)
+    {
+        if(occupancy & (u64(1) << square))
+        {
+            const u8    code     = (pieces[count / 2] >> ((count % 2) * 4)) & 15;
+            const Vec2i position = SquarePosition(square);
+
+            board.PieceAt(position) = CodePiece(code, position.y);
+            ++count;
+        }
+    }
+
+    if(enPassant)
+    {
+        // the pawn that moved belongs to the team that isn't to move
+        const int   direction   = Piece::Opposite(team) == Piece::Team::White ? 1 : -1;
+        const int   row         = Piece::Opposite(team) == Piece::Team::White ? 3 : Board::kDimension - 4;
+        const Vec2i destination = Vec2i(enPassant - 1, row);
+        const Vec2i origin      = Vec2i(enPassant - 1, row - 2 * direction);
+        const Piece pawn(Piece::Opposite(team), Piece::Type::Pawn);
+
+        board.PieceAt(destination) = Piece();
+        board.PieceAt(origin)      = pawn;
+
+        board.DoAction(Piece::Action::MakeMove(pawn, std::make_pair(origin, destination)));
+    }
+}
+
+}
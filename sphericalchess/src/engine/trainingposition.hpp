@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+namespace Engine
+{
+
+//! @brief Fixed size record of a position labelled with the result of its game, to tune and train the evaluation.
+//!
+//! Files are plain arrays of records with no header, so they can be concatenated, shuffled and memory mapped.
+//! Pieces are stored as a 4 bit code per occupied square in square index order: the low 3 bits are the
+//! Piece::Type, or 6 and 7 for a rook and king that have never moved, and the high bit is set for black.
+//! All values are stored little endian.
+struct TrainingPosition
+{
+    u64 occupancy   = 0;    //!< Bit per square index with a piece on it.
+    u8  pieces[16]  = {};   //!< Two pieces per byte, low nibble first.
+    u8  flags       = 0;    //!< Bit 0 is set when black is to move, bits 1-4 are the column of a pawn that can be captured en passant plus one.
+    u8  result      = 0;    //!< Board::Result of the game the position is from.
+    s16 score       = 0;    //!< Search score relative to the team to move, in centipawns.
+    u16 ply         = 0;    //!< Plies played in the game before the position.
+    u16 reserved    = 0;
+
+    //! @brief Packs the pieces, team to move and en passant state of @p board, the labels are left at zero.
+    //! @remarks Boards with more than 32 pieces can't be packed, which is never the case for a board from a game.
+    static TrainingPosition Pack(const Board& board);
+
+    //! @brief Sets @p board to the packed position, the only previous action kept is a pawn that can be captured en passant.
+    void Unpack(Board& board) const;
+};
+
+static_assert(sizeof(TrainingPosition) == 32, "TrainingPosition must match the file layout.");
+
+}
@@ -0,0 +1,124 @@
+#include "transpositiontable.hpp"
+
+#include "evaluation.hpp"
+
+namespace Engine
+{
+
+TranspositionTable::TranspositionTable(std::size_t megabytes)
+{
+    Resize(megabytes);
+}
+
+void TranspositionTable::Resize(std::size_t megabytes)
+{
+    std::size_t count = 1;
+
+    // round down to a power of two so the index can be masked from the key
+
+    while(count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024)
+    {
+        count *= 2;
+    }
+
+    slots.reset(new Slot[count]);
+    mask = count - 1;
+
+    Clear();
+}
+
+void TranspositionTable::Clear()
+{
+    for(std::size_t i = 0; i <= mask; ++i)
+    {
+        slots[i].key.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+
+    generation.store(0, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::Probe(u64 key, Entry& output) const
+{
+    const Slot& slot = slots[key & mask];
+
+    u64 data = slot.data.load(std::memory_order_relaxed);
+
+    if((slot.key.load(std::memory_order_relaxed) ^ data) != key)
+    {
+        return false;
+    }
+
+    output = Unpack(data);
+
+    return output.bound != Bound::None;
+}
+
+void TranspositionTable::Store(u64 key, const Entry& entry)
+{
+    Slot& slot = slots[key & mask];
+
+    u64 oldData = slot.data.load(std::memory_order_relaxed);
+    u64 oldKey  = slot.key.load(std::memory_order_relaxed) ^ oldData;
+
+    Entry old = Unpack(oldData);
+
+    const u8   current        = generation.load(std::memory_order_relaxed);
+    const bool sameGeneration = u8(oldData >> 48) == current;
+
+    // prefer keeping deeper results of the current search, anything else is replaced
+
+    if(oldKey == key || !sameGeneration || entry.depth >= old.depth || entry.bound == Bound::Exact)
+    {
+        Entry replacement = entry;
+
+        if(oldKey == key && !replacement.move)
+        {
+            replacement.move = old.move; // keep the best move around for ordering
+        }
+
+        u64 data = Pack(replacement, current);
+
+        slot.key.store(key ^ data, std::memory_order_relaxed);
+        slot.data.store(data, std::memory_order_relaxed);
+    }
+}
+
+int TranspositionTable::ScoreToTable(int score, int ply)
+{
+    if(score >  kScoreMateMin) return score + ply;
+    if(score < -kScoreMateMin) return score - ply;
+
+    return score;
+}
+
+int TranspositionTable::ScoreFromTable(int score, int ply)
+{
+    if(score >  kScoreMateMin) return score - ply;
+    if(score < -kScoreMateMin) return score + ply;
+
+    return score;
+}
+
+u64 TranspositionTable::Pack(const Entry& entry, u8 generation)
+{
+    return u64(entry.move.GetData())
+         | u64(u16(entry.score))  << 16
+         | u64(u8(entry.depth))   << 32
+         | u64(u8(entry.bound))   << 40
+         | u64(generation)        << 48;
+}
+
+auto TranspositionTable::Unpack(u64 data) -> Entry
+{
+    Entry entry;
+
+    entry.move  = Move(u16(data));
+    entry.score = s16(u16(data >> 16));
+    entry.depth = s8(u8(data >> 32));
+    entry.bound = Bound(u8(data >> 40));
+
+    return entry;
+}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "move.hpp"
+#include "../core.hpp"
+
+#include <atomic>
+#include <memory>
+
+namespace Engine
+{
+
+//! @brief Hash table of previously searched positions, shared between all search threads.
+//!
+//! Entries are written without locking, the key is stored xor'd with the data so a torn
+//! write from two threads racing on the same slot is detected as a miss when probed.
+class TranspositionTable
+{
+public:
+
+    enum class Bound : u8
+    {
+        None,
+        Upper,      //!< Score is at most #Entry::score, search failed low.
+        Lower,      //!< Score is at least #Entry::score, search failed high.
+        Exact,
+    };
+
+    struct Entry
+    {
+        Move  move;
+        s16   score = 0;
+        s8    depth = 0;
+        Bound bound = Bound::None;
+    };
+
+    explicit TranspositionTable(std::size_t megabytes);
+    TranspositionTable(const TranspositionTable&) = delete;
+
+    void Resize(std::size_t megabytes);
+    void Clear();
+
+    //! @brief Marks entries of previous searches as stale, so they are replaced first.
+    //! @remarks Safe while other searches are using the table, as when several games are analysed at once.
+    void NewSearch() { generation.fetch_add(1, std::memory_order_relaxed); }
+
+    bool Probe(u64 key, Entry& output) const;
+    void Store(u64 key, const Entry& entry);
+
+    //! @brief Converts a mate score relative to the root into one relative to the position at @p ply, for storing.
+    static int ScoreToTable(int score, int ply);
+    static int ScoreFromTable(int score, int ply);
+
+private:
+
+    struct Slot
+    {
+        std::atomic<u64> key;
+        std::atomic<u64> data;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t             mask = 0;
+    std::atomic<u8>         generation { 0 };
+
+    static u64 Pack(const Entry& entry, u8 generation);
+    static Entry Unpack(u64 data);
+};
+
+}
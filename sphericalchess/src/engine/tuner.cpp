@@ -0,0 +1,426 @@
+#include "tuner.hpp"
+
+#include "evaluation.hpp"
+#include "evaluationparameters.hpp"
+#include "movegen.hpp"
+#include "threads.hpp"
+
+#include "../mappedfile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace Engine
+{
+
+namespace
+{
+    constexpr int kMaxQuiescePly = 16;
+    constexpr int kNumSquares    = Board::kDimension * Board::kDimension;
+
+    constexpr double kLog10 = 2.302585092994046;
+
+    const char* const kTypeNames[Tuner::kNumTypes] = { "Pawn", "Bishop", "Knight", "Rook", "Queen", "King" };
+
+    int ValueIndex(int type)           { return type; }
+    int BonusIndex(int type, int rank) { return Tuner::kNumTypes + type * Board::kDimension + rank; }
+
+    double Target(const TrainingPosition& position)
+    {
+        switch(Board::Result(position.result))
+        {
+        case Board::Result::WhiteWins: return 1.0;
+        case Board::Result::BlackWins: return 0.0;
+        default:                       return 0.5;
+        }
+    }
+
+    //! @brief Calls @p function(weightIndex, coefficient) for every feature of @p position, relative to white.
+    template<typename F>
+    void ForEachFeature(const TrainingPosition& position, F function)
+    {
+        int count = 0;
+
+        for(int square = 0; square < kNumSquares && (position.occupancy >> square) != 0; ++square)
+        {
+            if(!(position.occupancy & (u64(1) << square)))
+            {
+                continue;
+            }
+
+            const int code  = (position.pieces[count / 2] >> ((count % 2) * 4)) & 15;
+            const bool black = (code & 8) != 0;
+
+            // unmoved rooks and kings have their own codes
+            const int type = (code & 7) == 6 ? int(Piece::Type::Rook) : (code & 7) == 7 ? int(Piece::Type::King) : (code & 7);
+            const int row  = square / Board::kDimension;
+            const int rank = black ? Board::kDimension - 1 - row : row;
+            const int sign = black ? -1 : 1;
+
+            function(ValueIndex(type), sign);
+            function(BonusIndex(type, rank), sign);
+
+            ++count;
+        }
+    }
+
+    double Predict(double evaluation, double scale)
+    {
+        return 1.0 / (1.0 + std::pow(10.0, -scale * evaluation / 400.0));
+    }
+
+    //! @brief Quiescence search that also returns the position its score comes from.
+    int Resolve(Board& board, int alpha, int beta, int ply, TrainingPosition& leaf)
+    {
+        const int standPat = Evaluate(board);
+
+        leaf = TrainingPosition::Pack(board);
+
+        if(standPat >= beta || ply >= kMaxQuiescePly)
+        {
+            return standPat;
+        }
+
+        alpha = std::max(alpha, standPat);
+
+        const Piece::Team team = board.GetCurrentTeamTurn();
+
+        Piece::ActionCollection actions;
+        GeneratePseudoLegalActions(board, actions);
+
+        actions.erase(std::remove_if(actions.begin(), actions.end(), [](const Piece::Action& action)
+        {
+            return (action.type & (Piece::Action::TypeBit_capture | Piece::Action::TypeBit_upgrade)) == 0;
+        }), actions.end());
+
+        // most valuable victim first
+        std::sort(actions.begin(), actions.end(), [](const Piece::Action& a, const Piece::Action& b)
+        {
+            const int victimA = (a.type & Piece::Action::TypeBit_capture) ? int(a.additional.piece.GetType()) : -1;
+            const int victimB = (b.type & Piece::Action::TypeBit_capture) ? int(b.additional.piece.GetType()) : -1;
+            return victimA > victimB;
+        });
+
+        int bestScore = standPat;
+
+        TrainingPosition childLeaf;
+
+        for(auto& action : actions)
+        {
+            board.DoAction(action);
+
+            if(IsInCheck(board, team))
+            {
+                board.UndoAction();
+                continue;
+            }
+
+            const int score = -Resolve(board, -beta, -alpha, ply + 1, childLeaf);
+
+            board.UndoAction();
+
+            if(score > bestScore)
+            {
+                bestScore = score;
+                leaf      = childLeaf;
+
+                if(score > alpha)
+                {
+                    alpha = score;
+
+                    if(score >= beta)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+
+        return bestScore;
+    }
+}
+
+Tuner::Tuner(int threads) : numThreads(std::max(threads, 1))
+{
+    for(int type = 0; type < kNumTypes; ++type)
+    {
+        weights[ValueIndex(type)] = Parameters::kPieceValue[type];
+
+        for(int rank = 0; rank < Board::kDimension; ++rank)
+        {
+            weights[BonusIndex(type, rank)] = Parameters::kRankBonus[type][rank];
+        }
+    }
+}
+
+template<typename F>
+void Tuner::ParallelFor(u64 count, F function) const
+{
+    RunOnThreads(numThreads, [&](int thread)
+    {
+        function(thread, count * thread / numThreads, count * (thread + 1) / numThreads);
+    });
+}
+
+u64 Tuner::Load(const char* filename, u64 maxPositions)
+{
+    MappedFile file;
+    file.Open(filename);
+
+    const auto records = reinterpret_cast<const TrainingPosition*>(file.GetData());
+
+    u64 count = file.GetSize() / sizeof(TrainingPosition);
+
+    if(maxPositions > 0)
+    {
+        count = std::min(count, maxPositions);
+    }
+
+    // each thread resolves its share in place, then the positions without a result are removed
+
+    const std::size_t first = positions.size();
+
+    positions.resize(first + count);
+
+    std::vector<u64> kept(numThreads);
+
+    ParallelFor(count, [&](int thread, u64 begin, u64 end)
+    {
+        Board board;
+        u64 output = begin;
+
+        for(u64 i = begin; i < end; ++i)
+        {
+            const TrainingPosition& record = records[i];
+
+            if(Board::Result(record.result) == Board::Result::Undecided)
+            {
+                continue;
+            }
+
+            TrainingPosition leaf;
+
+            record.Unpack(board);
+            Resolve(board, -kScoreInfinite, kScoreInfinite, 0, leaf);
+
+            leaf.result = record.result;
+            leaf.ply    = record.ply;
+
+            positions[first + output++] = leaf;
+        }
+
+        kept[thread] = output - begin;
+    });
+
+    std::size_t size = first;
+
+    for(int thread = 0; thread < numThreads; ++thread)
+    {
+        const auto begin = positions.begin() + first + std::ptrdiff_t(count * thread / numThreads);
+
+        size = std::move(begin, begin + std::ptrdiff_t(kept[thread]), positions.begin() + size) - positions.begin();
+    }
+
+    positions.resize(size);
+
+    return u64(size - first);
+}
+
+double Tuner::CalculateError() const
+{
+    std::vector<double> errors(numThreads);
+
+    ParallelFor(positions.size(), [&](int thread, u64 begin, u64 end)
+    {
+        double error = 0.0;
+
+        for(u64 i = begin; i < end; ++i)
+        {
+            double evaluation = 0.0;
+
+            ForEachFeature(positions[i], [&](int index, int coefficient) { evaluation += coefficient * weights[index]; });
+
+            const double difference = Target(positions[i]) - Predict(evaluation, scale);
+
+            error += difference * difference;
+        }
+
+        errors[thread] = error;
+    });
+
+    double error = 0.0;
+
+    for(double e : errors)
+    {
+        error += e;
+    }
+
+    return positions.empty() ? 0.0 : error / double(positions.size());
+}
+
+double Tuner::FitScale()
+{
+    // the error is convex in the scale, narrow it down with a ternary search
+
+    double low  = 0.1;
+    double high = 5.0;
+
+    for(int i = 0; i < 30; ++i)
+    {
+        const double a = low  + (high - low) / 3.0;
+        const double b = high - (high - low) / 3.0;
+
+        scale = a;
+        const double errorA = CalculateError();
+
+        scale = b;
+        const double errorB = CalculateError();
+
+        if(errorA < errorB) high = b;
+        else                low  = a;
+    }
+
+    scale = (low + high) / 2.0;
+
+    return scale;
+}
+
+double Tuner::Epoch(double learningRate)
+{
+    constexpr double kBeta1   = 0.9;
+    constexpr double kBeta2   = 0.999;
+    constexpr double kEpsilon = 1e-8;
+
+    std::vector<std::vector<double>> gradients(numThreads, std::vector<double>(kNumWeights));
+    std::vector<double>              errors(numThreads);
+
+    ParallelFor(positions.size(), [&](int thread, u64 begin, u64 end)
+    {
+        auto&  gradient = gradients[thread];
+        double error    = 0.0;
+
+        for(u64 i = begin; i < end; ++i)
+        {
+            double evaluation = 0.0;
+
+            ForEachFeature(positions[i], [&](int index, int coefficient) { evaluation += coefficient * weights[index]; });
+
+            const double prediction = Predict(evaluation, scale);
+            const double difference = Target(positions[i]) - prediction;
+
+            error += difference * difference;
+
+            // derivative of the squared error with respect to the evaluation
+            const double derivative = -2.0 * difference * prediction * (1.0 - prediction) * scale * kLog10 / 400.0;
+
+            ForEachFeature(positions[i], [&](int index, int coefficient) { gradient[index] += derivative * coefficient; });
+        }
+
+        errors[thread] = error;
+    });
+
+    double error = 0.0;
+    double gradient[kNumWeights] = {};
+
+    for(int thread = 0; thread < numThreads; ++thread)
+    {
+        error += errors[thread];
+
+        for(int i = 0; i < kNumWeights; ++i)
+        {
+            gradient[i] += gradients[thread][i];
+        }
+    }
+
+    if(positions.empty())
+    {
+        return 0.0;
+    }
+
+    // Adam, so weights with rare features move as fast as common ones
+
+    ++step;
+
+    const double correction1 = 1.0 - std::pow(kBeta1, step);
+    const double correction2 = 1.0 - std::pow(kBeta2, step);
+
+    for(int i = 0; i < kNumWeights; ++i)
+    {
+        const double g = gradient[i] / double(positions.size());
+
+        moment[i]   = kBeta1 * moment[i]   + (1.0 - kBeta1) * g;
+        velocity[i] = kBeta2 * velocity[i] + (1.0 - kBeta2) * g * g;
+
+        weights[i] -= learningRate * (moment[i] / correction1) / (std::sqrt(velocity[i] / correction2) + kEpsilon);
+    }
+
+    return error / double(positions.size());
+}
+
+void Tuner::WriteHeader(const char* filename) const
+{
+    std::ofstream file(filename);
+
+    if(!file) throw std::runtime_error("Failed to open file: " + std::string(filename));
+
+    auto Weight = [this](int index)
+    {
+        return int(std::lround(weights[index]));
+    };
+
+    file << "#pragma once\n"
+            "\n"
+            "//! @file\n"
+            "//! Weights used by Engine::Evaluate(), indexed by Piece::Type.\n"
+            "//! Ranks are counted from the owning team's side of the board, the board has no edges\n"
+            "//! along the x axis so there is no bonus per column.\n"
+            "//! Generated by Engine::Tuner from " << positions.size() << " positions.\n"
+            "\n"
+            "namespace Engine\n"
+            "{\n"
+            "namespace Parameters\n"
+            "{\n"
+            "\n"
+            "constexpr int kPieceValue[" << kNumTypes << "] =\n"
+            "{\n";
+
+    for(int type = 0; type < kNumTypes; ++type)
+    {
+        const std::string value = std::to_string(Weight(ValueIndex(type))) + ",";
+
+        file << "    " << value << std::string(8 - std::min<std::size_t>(value.size(), 7), ' ') << "// " << kTypeNames[type] << "\n";
+    }
+
+    file << "};\n"
+            "\n"
+            "constexpr int kRankBonus[" << kNumTypes << "][" << Board::kDimension << "] =\n"
+            "{\n";
+
+    for(int type = 0; type < kNumTypes; ++type)
+    {
+        file << "    {";
+
+        for(int rank = 0; rank < Board::kDimension; ++rank)
+        {
+            const std::string value = std::to_string(Weight(BonusIndex(type, rank)));
+
+            file << std::string(4 - std::min<std::size_t>(value.size(), 4), ' ') << value << (rank + 1 < Board::kDimension ? "," : " ");
+        }
+
+        file << "},   // " << kTypeNames[type] << "\n";
+    }
+
+    file << "};\n"
+            "\n"
+            "}\n"
+            "}\n";
+
+    file.close();
+
+    if(!file) throw std::runtime_error("Failed to write file: " + std::string(filename));
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "trainingposition.hpp"
+
+#include "../core.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+//! @brief Tunes the weights of Evaluate() to predict game results, writing them back as evaluationparameters.hpp.
+//!
+//! Every position is first resolved to the end of its quiescence search with the current weights, so the
+//! evaluation that is tuned is of a quiet position. Weights are then optimised by gradient descent on the mean
+//! squared error between the game result and a logistic function of the evaluation, with every epoch spread over all threads.
+//! Resolved positions are kept packed in memory, 32 bytes each, and their features recalculated every epoch.
+class Tuner
+{
+public:
+
+    static constexpr int kNumTypes   = 6;
+    static constexpr int kNumWeights = kNumTypes + kNumTypes * Board::kDimension; //!< Piece values followed by the rank bonuses.
+
+    explicit Tuner(int threads);
+
+    //! @brief Streams TrainingPosition records from @p filename and resolves them, skipping any without a result.
+    //! @param [in] maxPositions Zero to load every position.
+    //! @returns Number of positions loaded.
+    //! @throws std::runtime_error When the file can't be opened.
+    u64 Load(const char* filename, u64 maxPositions = 0);
+
+    //! @brief Finds the logistic scale that best fits the results with the current weights, before tuning.
+    double FitScale();
+
+    //! @brief One pass of gradient descent over every position.
+    //! @returns Error before the update.
+    double Epoch(double learningRate);
+
+    double CalculateError() const;
+
+    //! @throws std::runtime_error When the file fails to open or be written, such as when the disk is full.
+    void WriteHeader(const char* filename) const;
+
+    u64    GetNumPositions() const { return u64(positions.size()); }
+    double GetScale()        const { return scale; }
+
+private:
+
+    int numThreads;
+
+    std::vector<TrainingPosition> positions;   //!< Resolved quiet positions, TrainingPosition::score is unused.
+
+    double weights[kNumWeights];
+    double scale = 1.0;
+
+    // Adam moments per weight
+    double moment[kNumWeights]   = {};
+    double velocity[kNumWeights] = {};
+    int    step = 0;
+
+    //! @brief Calls @p function(thread, begin, end) with the positions split evenly over the threads.
+    template<typename F>
+    void ParallelFor(u64 count, F function) const;
+};
+
+}
@@ -0,0 +1,279 @@
+#include "variationtree.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Engine
+{
+
+namespace
+{
+    void Apply(BitboardPosition& position, u16 move)
+    {
+        position.Apply(move & 63, (move >> 6) & 63);
+    }
+}
+
+const char* VariationTree::GlyphToString(Glyph glyph)
+{
+    static const char* const kText[Glyph_count] = { "", "!", "?", "!!", "??", "!?", "?!" };
+
+    return glyph < Glyph_count ? kText[glyph] : "";
+}
+
+VariationTree::VariationTree()
+{
+    BitboardPosition start;
+    start.SetStart();
+
+    Reset(start);
+}
+
+VariationTree::VariationTree(const BitboardPosition& start)
+{
+    Reset(start);
+}
+
+void VariationTree::Reset(const BitboardPosition& start)
+{
+    nodes.clear();
+    snapshots.clear();
+    comments.clear();
+    positions.clear();
+
+    nodes.push_back({ kNone, kNone, kNone, 0, Glyph_none, Flag_snapshot });
+    snapshots.push_back({ kRoot, 0, start });
+    positions.push_back(start);
+
+    current = kRoot;
+    ply     = 0;
+}
+
+u32 VariationTree::AddMove(Move move)
+{
+    if(Forward(move))
+    {
+        return current;
+    }
+
+    const u32 node = u32(nodes.size());
+
+    Node added = { current, kNone, kNone, move.GetData(), Glyph_none, 0 };
+
+    BitboardPosition next = positions.back();
+    Apply(next, added.move);
+
+    if((ply + 1) % kSnapshotInterval == 0)
+    {
+        added.flags |= Flag_snapshot;
+        snapshots.push_back({ node, ply + 1, next });
+    }
+
+    // appended after the existing moves, so the main line stays the first child
+
+    u32* link = &nodes[current].child;
+
+    while(*link != kNone)
+    {
+        link = &nodes[*link].sibling;
+    }
+
+    *link = node;
+
+    nodes.push_back(added);
+    positions.push_back(next);
+
+    current = node;
+    ++ply;
+
+    return node;
+}
+
+bool VariationTree::Forward()
+{
+    const u32 child = nodes[current].child;
+
+    if(child == kNone)
+    {
+        return false;
+    }
+
+    Enter(child);
+    return true;
+}
+
+bool VariationTree::Forward(Move move)
+{
+    for(u32 child = nodes[current].child; child != kNone; child = nodes[child].sibling)
+    {
+        if(nodes[child].move == move.GetData())
+        {
+            Enter(child);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool VariationTree::Back()
+{
+    const u32 parent = nodes[current].parent;
+
+    if(parent == kNone)
+    {
+        return false;
+    }
+
+    if(positions.size() > 1)
+    {
+        positions.pop_back();
+
+        current = parent;
+        --ply;
+    }
+    else
+    {
+        Jump(parent);
+    }
+
+    return true;
+}
+
+void VariationTree::Jump(u32 node)
+{
+    assert(node < nodes.size());
+
+    // the moves back to the nearest snapshot, there is one every kSnapshotInterval plies
+
+    u16 moves[kSnapshotInterval];
+    int count = 0;
+    u32 base  = node;
+
+    while((nodes[base].flags & Flag_snapshot) == 0)
+    {
+        assert(count < kSnapshotInterval);
+
+        moves[count++] = nodes[base].move;
+        base           = nodes[base].parent;
+    }
+
+    const Snapshot& snapshot = snapshots[FindSnapshot(base)];
+
+    positions.clear();
+    positions.push_back(snapshot.position);
+
+    for(int i = count - 1; i >= 0; --i)
+    {
+        BitboardPosition next = positions.back();
+        Apply(next, moves[i]);
+
+        positions.push_back(next);
+    }
+
+    current = node;
+    ply     = snapshot.ply + count;
+}
+
+void VariationTree::Promote(u32 node)
+{
+    const u32 parent = nodes[node].parent;
+
+    if(parent == kNone || nodes[parent].child == node)
+    {
+        return;
+    }
+
+    u32 previous = nodes[parent].child;
+
+    while(nodes[previous].sibling != node)
+    {
+        previous = nodes[previous].sibling;
+    }
+
+    nodes[previous].sibling = nodes[node].sibling;
+    nodes[node].sibling     = nodes[parent].child;
+    nodes[parent].child     = node;
+}
+
+void VariationTree::SetComment(u32 node, const std::string& comment)
+{
+    if(comment.empty())
+    {
+        comments.erase(node);
+        nodes[node].flags &= u8(~Flag_comment);
+    }
+    else
+    {
+        comments[node] = comment;
+        nodes[node].flags |= Flag_comment;
+    }
+}
+
+const std::string& VariationTree::GetComment(u32 node) const
+{
+    static const std::string kEmpty;
+
+    if((nodes[node].flags & Flag_comment) == 0)
+    {
+        return kEmpty;
+    }
+
+    return comments.find(node)->second;
+}
+
+std::vector<Move> VariationTree::GetLine(u32 node) const
+{
+    std::vector<Move> line;
+
+    for(; node != kRoot; node = nodes[node].parent)
+    {
+        line.push_back(nodes[node].GetMove());
+    }
+
+    std::reverse(line.begin(), line.end());
+
+    return line;
+}
+
+std::size_t VariationTree::GetMemoryUsage() const
+{
+    std::size_t bytes = nodes.capacity()     * sizeof(Node)
+                      + snapshots.capacity() * sizeof(Snapshot)
+                      + positions.capacity() * sizeof(BitboardPosition)
+                      + comments.bucket_count() * sizeof(void*);
+
+    // each comment is a list node of the map with the text allocated separately when it is long
+
+    for(const auto& comment : comments)
+    {
+        bytes += sizeof(comment) + sizeof(void*) + comment.second.capacity();
+    }
+
+    return bytes;
+}
+
+void VariationTree::Enter(u32 node)
+{
+    BitboardPosition next = positions.back();
+    Apply(next, nodes[node].move);
+
+    positions.push_back(next);
+
+    current = node;
+    ++ply;
+}
+
+std::size_t VariationTree::FindSnapshot(u32 node) const
+{
+    const auto snapshot = std::lower_bound(snapshots.begin(), snapshots.end(), node, [](const Snapshot& snapshot, u32 node)
+    {
+        return snapshot.node < node;
+    });
+
+    assert(snapshot != snapshots.end() && snapshot->node == node);
+
+    return std::size_t(snapshot - snapshots.begin());
+}
+
+}
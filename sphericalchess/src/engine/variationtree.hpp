@@ -0,0 +1,157 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include "move.hpp"
+
+#include "../core.hpp"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+
+//! @brief Tree of the variations of a game, with a cursor at one of its positions.
+//!
+//! Nodes live in one array and link to each other by index, every node is a move from its parent's position
+//! and the first child of a node is its main line. Variations sharing moves share their nodes, so a tree only
+//! grows by a node for each new move.
+//!
+//! | Member  | Bytes | Contents                                                                   |
+//! |---------|-------|----------------------------------------------------------------------------|
+//! | parent  | 4     | Node the move is made from, kNone for the root.                            |
+//! | child   | 4     | First move made from the node, the main line, or kNone.                    |
+//! | sibling | 4     | Next move made from the parent, or kNone.                                  |
+//! | move    | 2     | Move::GetData(), zero for the root.                                        |
+//! | glyph   | 1     | Glyph annotating the move.                                                 |
+//! | flags   | 1     | Flag bits.                                                                 |
+//!
+//! The cursor keeps the positions from the nearest snapshot down to the current node, so stepping forward is a
+//! copy and BitboardPosition::Apply() and stepping back drops the last position. A snapshot of the position is
+//! kept for every node kSnapshotInterval plies from the root, so jumping to any node replays at most that many
+//! moves, which is also what stepping back past the first kept position costs.
+class VariationTree
+{
+public:
+
+    static constexpr u32 kNone             = ~u32(0);
+    static constexpr u32 kRoot             = 0;
+    static constexpr int kSnapshotInterval = 16;
+
+    //! @brief Annotation of a move, numbered as the first numeric annotation glyphs of PGN.
+    enum Glyph : u8
+    {
+        Glyph_none,
+        Glyph_good,         //!< !
+        Glyph_mistake,      //!< ?
+        Glyph_brilliant,    //!< !!
+        Glyph_blunder,      //!< ??
+        Glyph_interesting,  //!< !?
+        Glyph_dubious,      //!< ?!
+        Glyph_count,
+    };
+
+    enum Flag : u8
+    {
+        Flag_snapshot = 1 << 0,     //!< The position after the move is kept.
+        Flag_comment  = 1 << 1,     //!< The move has a comment.
+    };
+
+    struct Node
+    {
+        u32 parent;
+        u32 child;
+        u32 sibling;
+        u16 move;
+        u8  glyph;
+        u8  flags;
+
+        Move GetMove() const { return Move(move); }
+    };
+
+    static_assert(sizeof(Node) == 16, "Node must stay packed.");
+
+    //! @returns Text of @p glyph as written after a move, empty for Glyph_none.
+    static const char* GlyphToString(Glyph glyph);
+
+    VariationTree();
+    explicit VariationTree(const BitboardPosition& start);
+
+    //! @brief Removes every move, leaving only the root at @p start with the cursor on it.
+    void Reset(const BitboardPosition& start);
+
+    //! @brief Makes @p move from the current position, moving the cursor to its node.
+    //!
+    //! The move is added as the last variation unless it was already made from the position.
+    //! @param [in] move A legal move in the current position, it isn't checked.
+    //! @returns Node of the move.
+    u32 AddMove(Move move);
+
+    //! @brief Moves the cursor to the main line move of the current node.
+    //! @returns False at the end of the line.
+    bool Forward();
+
+    //! @brief Moves the cursor to the child of the current node making @p move.
+    //! @returns False if the move hasn't been made from the current position.
+    bool Forward(Move move);
+
+    //! @brief Moves the cursor to the parent of the current node.
+    //! @returns False at the root.
+    bool Back();
+
+    //! @brief Moves the cursor to @p node, replaying at most kSnapshotInterval moves.
+    void Jump(u32 node);
+
+    //! @brief Makes @p node the main line of its parent, moving it before its siblings.
+    void Promote(u32 node);
+
+    void SetGlyph(u32 node, Glyph glyph) { nodes[node].glyph = glyph; }
+
+    //! @brief Sets the comment after the move of @p node, an empty comment removes it.
+    void SetComment(u32 node, const std::string& comment);
+
+    //! @returns Comment of @p node, or an empty string if it has none.
+    const std::string& GetComment(u32 node) const;
+
+    const Node& GetNode(u32 node) const { return nodes[node]; }
+    std::size_t GetNumNodes() const     { return nodes.size(); }
+
+    u32                     GetCurrent()  const { return current; }
+    int                     GetPly()      const { return ply; }
+    const BitboardPosition& GetPosition() const { return positions.back(); }
+    const BitboardPosition& GetStart()    const { return snapshots.front().position; }
+
+    //! @brief Moves from the root to @p node.
+    std::vector<Move> GetLine(u32 node) const;
+
+    //! @returns Bytes held by the nodes, snapshots and comments of the tree.
+    std::size_t GetMemoryUsage() const;
+
+private:
+
+    struct Snapshot
+    {
+        u32              node;
+        int              ply;
+        BitboardPosition position;
+    };
+
+    //! @brief Moves the cursor to @p node, a child of the current node.
+    void Enter(u32 node);
+
+    //! @brief Index of the snapshot of @p node, which must have Flag_snapshot.
+    std::size_t FindSnapshot(u32 node) const;
+
+    std::vector<Node>     nodes;
+    std::vector<Snapshot> snapshots;    //!< Sorted by node, as nodes are only ever appended.
+
+    std::unordered_map<u32, std::string> comments;
+
+    std::vector<BitboardPosition> positions;    //!< From a snapshot on the path down to the current node.
+    u32                           current = kRoot;
+    int                           ply     = 0;
+};
+
+}
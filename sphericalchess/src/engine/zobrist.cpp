@@ -0,0 +1,265 @@
+#include "zobrist.hpp"
+
+#include "move.hpp"
+
+#include <array>
+
+namespace Engine
+{
+namespace Zobrist
+{
+
+namespace
+{
+    struct Keys
+    {
+        u64 pieces[2][kNumTypes][Board::kDimension * Board::kDimension];
+        u64 moved[2][kNumTypes][Board::kDimension * Board::kDimension];
+        u64 enPassant[Board::kDimension];
+        u64 blackTurn;
+
+        Keys()
+        {
+            u64 state = 0x5350484552494341ull; // fixed seed, hashes must be identical between runs for any saved data
+
+            auto Next = [&state]()
+            {
+                // splitmix64
+                u64 z = (state += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                return z ^ (z >> 31);
+            };
+
+            for(auto& team : pieces) for(auto& type : team) for(auto& key : type) key = Next();
+            for(auto& team : moved)  for(auto& type : team) for(auto& key : type) key = Next();
+            for(auto& key : enPassant) key = Next();
+
+            blackTurn = Next();
+        }
+    };
+
+    const Keys& GetKeys()
+    {
+        static const Keys keys;
+        return keys;
+    }
+
+    //! @brief Whether the key for moving applies to the piece, only kings and rooks lose
+    //! the ability to castle when moved, a pawn that has moved can never be back on its starting row.
+    bool UsesMovedKey(const Piece& piece)
+    {
+        return piece.HasMoved() && (piece.GetType() == Piece::Type::King || piece.GetType() == Piece::Type::Rook);
+    }
+
+    bool IsEnPassantPossible(const Board& board)
+    {
+        if(!board.HasActions())
+        {
+            return false;
+        }
+
+        auto& last = board.GetLastAction();
+
+        return last.piece.GetType() == Piece::Type::Pawn && !last.piece.HasMoved() && std::abs(last.destination.y - last.origin.y) == 2;
+    }
+}
+
+u64 Hash(const Board& board)
+{
+    const Keys& keys = GetKeys();
+
+    u64 hash = 0;
+
+    for(int i = 0; i < Board::kDimension; ++i)
+    {
+        for(int j = 0; j < Board::kDimension; ++j)
+        {
+            if(auto& piece = board.PieceAt(i, j))
+            {
+                const int team   = int(piece.GetTeam());
+                const int type   = int(piece.GetType());
+                const int square = SquareIndex(Vec2i(i, j));
+
+                hash ^= keys.pieces[team][type][square];
+
+                if(UsesMovedKey(piece))
+                {
+                    hash ^= keys.moved[team][type][square];
+                }
+            }
+        }
+    }
+
+    if(board.GetCurrentTeamTurn() == Piece::Team::Black)
+    {
+        hash ^= keys.blackTurn;
+    }
+
+    if(IsEnPassantPossible(board))
+    {
+        hash ^= keys.enPassant[board.GetLastAction().destination.x];
+    }
+
+    return hash;
+}
+
+u64 Hash(const BitboardPosition& position)
+{
+    const Keys& keys = GetKeys();
+
+    u64 hash = 0;
+
+    for(int team = 0; team < 2; ++team)
+    {
+        for(int type = 0; type < kNumTypes; ++type)
+        {
+            for(u64 bits = position.pieces[team][type]; bits; bits &= bits - 1)
+            {
+                const int square = LowestBit(bits);
+
+                hash ^= keys.pieces[team][type][square];
+
+                if((type == int(Piece::Type::King) || type == int(Piece::Type::Rook)) && !(position.unmoved & (u64(1) << square)))
+                {
+                    hash ^= keys.moved[team][type][square];
+                }
+            }
+        }
+    }
+
+    if(position.turn == u8(Piece::Team::Black))
+    {
+        hash ^= keys.blackTurn;
+    }
+
+    if(position.enPassant >= 0)
+    {
+        hash ^= keys.enPassant[position.enPassant % Board::kDimension];
+    }
+
+    return hash;
+}
+
+void HashSymmetries(const Board& board, u64 hashes[Symmetry::kCount])
+{
+    const Keys& keys = GetKeys();
+
+    Symmetry symmetries[Symmetry::kCount];
+
+    for(int s = 0; s < Symmetry::kCount; ++s)
+    {
+        symmetries[s] = Symmetry::FromIndex(s);
+        hashes[s]     = 0;
+    }
+
+    for(int i = 0; i < Board::kDimension; ++i)
+    {
+        for(int j = 0; j < Board::kDimension; ++j)
+        {
+            if(auto& piece = board.PieceAt(i, j))
+            {
+                const int  type   = int(piece.GetType());
+                const bool moved  = UsesMovedKey(piece);
+
+                for(int s = 0; s < Symmetry::kCount; ++s)
+                {
+                    const int team   = int(symmetries[s].Apply(piece.GetTeam()));
+                    const int square = SquareIndex(symmetries[s].Apply(Vec2i(i, j)));
+
+                    hashes[s] ^= keys.pieces[team][type][square];
+
+                    if(moved)
+                    {
+                        hashes[s] ^= keys.moved[team][type][square];
+                    }
+                }
+            }
+        }
+    }
+
+    const bool enPassant = IsEnPassantPossible(board);
+
+    for(int s = 0; s < Symmetry::kCount; ++s)
+    {
+        if(symmetries[s].Apply(board.GetCurrentTeamTurn()) == Piece::Team::Black)
+        {
+            hashes[s] ^= keys.blackTurn;
+        }
+
+        if(enPassant)
+        {
+            hashes[s] ^= keys.enPassant[symmetries[s].Apply(board.GetLastAction().destination).x];
+        }
+    }
+}
+
+void HashSymmetries(const BitboardPosition& position, u64 hashes[Symmetry::kCount])
+{
+    const Keys& keys = GetKeys();
+
+    static const auto squares = []()
+    {
+        std::array<std::array<u8, kNumSquares>, Symmetry::kCount> squares;
+
+        for(int s = 0; s < Symmetry::kCount; ++s)
+        {
+            for(int square = 0; square < kNumSquares; ++square)
+            {
+                squares[s][square] = u8(Symmetry::FromIndex(s).Apply(square));
+            }
+        }
+
+        return squares;
+    }();
+
+    for(int s = 0; s < Symmetry::kCount; ++s)
+    {
+        hashes[s] = 0;
+    }
+
+    for(int team = 0; team < 2; ++team)
+    {
+        for(int type = 0; type < kNumTypes; ++type)
+        {
+            const bool castler = type == int(Piece::Type::King) || type == int(Piece::Type::Rook);
+
+            for(u64 bits = position.pieces[team][type]; bits; bits &= bits - 1)
+            {
+                const int  square = LowestBit(bits);
+                const bool moved  = castler && !(position.unmoved & (u64(1) << square));
+
+                for(int s = 0; s < Symmetry::kCount; ++s)
+                {
+                    const int mapped = squares[s][square];
+                    const int other  = Symmetry::FromIndex(s).mirror ? team ^ 1 : team;
+
+                    hashes[s] ^= keys.pieces[other][type][mapped];
+
+                    if(moved)
+                    {
+                        hashes[s] ^= keys.moved[other][type][mapped];
+                    }
+                }
+            }
+        }
+    }
+
+    for(int s = 0; s < Symmetry::kCount; ++s)
+    {
+        const bool mirror = Symmetry::FromIndex(s).mirror;
+
+        if((position.turn == u8(Piece::Team::Black)) != mirror)
+        {
+            hashes[s] ^= keys.blackTurn;
+        }
+
+        if(position.enPassant >= 0)
+        {
+            hashes[s] ^= keys.enPassant[squares[s][position.enPassant] % Board::kDimension];
+        }
+    }
+}
+
+}
+}
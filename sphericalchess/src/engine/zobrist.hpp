@@ -0,0 +1,35 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include "symmetry.hpp"
+
+#include "../game/board.hpp"
+#include "../core.hpp"
+
+namespace Engine
+{
+
+//! @brief Zobrist hashing of a Board, used to key the TranspositionTable.
+namespace Zobrist
+{
+
+//! @brief Calculates the hash of @p board from scratch.
+//!
+//! Includes the pieces, the team to move, whether kings and rooks have moved (castling rights)
+//! and a pawn that can be captured en passant.
+u64 Hash(const Board& board);
+
+//! @brief Same as Hash(const Board&) for a BitboardPosition.
+u64 Hash(const BitboardPosition& position);
+
+//! @brief Calculates the hash of @p board with every Symmetry applied in a single pass,
+//! @p hashes is indexed by Symmetry::GetIndex and the identity is the same as Hash().
+//! @remarks Doesn't check the symmetries are valid for the board, see Canonicalize().
+void HashSymmetries(const Board& board, u64 hashes[Symmetry::kCount]);
+
+//! @brief Same as HashSymmetries(const Board&, u64*) for a BitboardPosition.
+void HashSymmetries(const BitboardPosition& position, u64 hashes[Symmetry::kCount]);
+
+}
+
+}
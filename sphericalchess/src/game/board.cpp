@@ -7,6 +7,8 @@
 
 
 
+const int Board::kDimension; // odr-used when bound to references, e.g. std::min
+
 Board::Board()
 {
 
@@ -35,6 +37,23 @@ Board::Board()
     
 }
 
+void Board::Clear(Piece::Team team)
+{
+    for(auto& column : board)
+    {
+        for(auto& piece : column)
+        {
+            piece = Piece();
+        }
+    }
+
+    whiteActions.clear();
+    blackActions.clear();
+
+    firstTeam        = team;
+    currentTeamState = State::Playing;
+}
+
 bool Board::FindAnyPiece(Piece::Type type, Piece::Team team, Vec2i& outPosition) const
 {
     for(int i = 0; i < kDimension; ++i)
@@ -85,6 +104,30 @@ auto Board::ApplyActionIfValid(const Piece::Action& action) -> State
     return state;
 }
 
+void Board::DoAction(const Piece::Action& action)
+{
+    action.Apply(*this);
+
+    if(GetCurrentTeamTurn() == Piece::Team::White)
+    {
+        whiteActions.push_back(action);
+    }
+    else
+    {
+        blackActions.push_back(action);
+    }
+}
+
+void Board::UndoAction()
+{
+    auto& actions = GetCurrentTeamTurn() == Piece::Team::White ? blackActions : whiteActions;
+
+    assert(!actions.empty());
+
+    actions.back().Reverse(*this);
+    actions.pop_back();
+}
+
 Board::State Board::CheckState(Piece::Team team)
 {
     Vec2i kingPosition;
@@ -213,5 +256,5 @@ bool Board::CheckStalemate(Piece::Team team)
 
 const Piece::Action& Board::GetLastAction() const
 {
-    return whiteActions.size() != blackActions.size() ? whiteActions.back() : blackActions.back();
+    return GetCurrentTeamTurn() == Piece::Team::White ? blackActions.back() : whiteActions.back();
 }
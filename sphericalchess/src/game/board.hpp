@@ -22,10 +22,22 @@ public:
         Stalemate,      //!< Game has resulted in a draw.
     };
 
+    //! @brief Final outcome of a game, used by game records and the engine's tools.
+    enum class Result
+    {
+        Undecided,
+        WhiteWins,
+        BlackWins,
+        Draw,
+    };
+
     static const int kDimension = 8; //!< The length of x and y axis of the board.
 
     Board();
 
+    //! @brief Removes every piece and all previous actions, leaving an empty board with @p team to move first.
+    void Clear(Piece::Team team);
+
     Piece&       PieceAt(const Vec2i& position)       { return At(position); }
     const Piece& PieceAt(const Vec2i& position) const { return At(position); }
     Piece&       PieceAt(int x, int y)                { return board[x][y]; }
@@ -40,13 +52,22 @@ public:
     State ApplyActionIfValid(const Piece::Action& action);
     State CheckState(Piece::Team team);
 
+    //! @brief Applies @p action without any validation and records it as the current team's move.
+    //! @remarks Intended for searching, the current team state is not updated. Must be paired with UndoAction().
+    void DoAction(const Piece::Action& action);
+
+    //! @brief Reverses the last action made, restoring the board to the state before it was made.
+    void UndoAction();
+
     State GetCurrentTeamState() const { return currentTeamState; }
 
     bool CheckStalemate(Piece::Team team); // todo remove or implement ?
 
     const Piece::Action& GetLastAction() const;
 
-    Piece::Team GetCurrentTeamTurn() const { return whiteActions.size() == blackActions.size() ? Piece::Team::White : Piece::Team::Black; }
+    Piece::Team GetCurrentTeamTurn() const { return whiteActions.size() == blackActions.size() ? firstTeam : Piece::Opposite(firstTeam); }
+
+    bool HasActions() const { return !whiteActions.empty() || !blackActions.empty(); }
 
     const std::vector<Piece::Action>& GetWhiteActions() const { return whiteActions; }
     const std::vector<Piece::Action>& GetBlackActions() const { return blackActions; }
@@ -54,6 +75,7 @@ public:
 private:
 
     State currentTeamState = State::Playing;
+    Piece::Team firstTeam  = Piece::Team::White;
 
     std::vector<Piece::Action> whiteActions;
     std::vector<Piece::Action> blackActions;
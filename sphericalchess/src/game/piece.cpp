@@ -322,7 +322,7 @@ Piece::ActionCollection Piece::CalculatePossibleActionsPawn(const Board& board,
 
     // En Passant //
 
-    if(position.y == enPassantRow)
+    if(position.y == enPassantRow && board.HasActions())
     {
         auto& lastAction = board.GetLastAction();
         auto& lastPiece  = lastAction.piece;
@@ -39,14 +39,17 @@ public:
 
 
     Piece() = default;
-    Piece(Team team, Type type) : team(team), type(type)
+    Piece(Team team, Type type, bool moved = false) : team(team), type(type), moved(moved)
     {
     }
 
+    static Team Opposite(Team team) { return team == Team::White ? Team::Black : Team::White; }
+
     operator bool() const { return type != Type::None; }
 
     Type GetType() const { return type; }
     Team GetTeam() const { return team; }
+    bool HasMoved() const { return moved; }
 
     const ActionCollection CalculatePossibleActions(const Board& board, Vec2i position) const;
     bool CanCaptureDestination(const Board& board, Vec2i position, Vec2i destination) const;
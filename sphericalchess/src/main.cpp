@@ -77,7 +77,16 @@ int main(int argc, char* argv[]) try
 
     StateManager stateManager;
 
-    stateManager.AddState(std::make_unique<MainState>(stateManager, resource));
+    auto mainState = std::make_unique<MainState>(stateManager, resource);
+
+    // "--connect <address> [game]" plays through a game server, creating a game if none is given
+
+    if(argc > 2 && std::string(argv[1]) == "--connect")
+    {
+        mainState->Connect(argv[2], argc > 3 ? u32(std::stoul(argv[3])) : 0);
+    }
+
+    stateManager.AddState(std::move(mainState));
     stateManager.UpdateStateChange();
 
     bool running = true;
@@ -0,0 +1,111 @@
+#include "mappedfile.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void MappedFile::Open(const char* filename)
+{
+    Close();
+
+#ifdef _WIN32
+
+    file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        file = nullptr;
+        throw std::runtime_error("Failed to open file: " + std::string(filename));
+    }
+
+    LARGE_INTEGER fileSize;
+
+    if(!GetFileSizeEx(file, &fileSize))
+    {
+        Close();
+        throw std::runtime_error("Failed to get size of file: " + std::string(filename));
+    }
+
+    size = std::size_t(fileSize.QuadPart);
+
+    if(size == 0)
+    {
+        return; // can't map an empty file, nothing to read anyways
+    }
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    data    = mapping ? static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+#else
+
+    int descriptor = open(filename, O_RDONLY);
+
+    if(descriptor == -1)
+    {
+        throw std::runtime_error("Failed to open file: " + std::string(filename));
+    }
+
+    struct stat status;
+
+    if(fstat(descriptor, &status) != 0)
+    {
+        close(descriptor);
+        throw std::runtime_error("Failed to get size of file: " + std::string(filename));
+    }
+
+    size = std::size_t(status.st_size);
+
+    if(size == 0)
+    {
+        close(descriptor);
+        return;
+    }
+
+    void* address = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+    close(descriptor); // the mapping keeps its own reference to the file
+
+    if(address != MAP_FAILED)
+    {
+        data = static_cast<const u8*>(address);
+    }
+
+#endif
+
+    if(data == nullptr)
+    {
+        Close();
+        throw std::runtime_error("Failed to map file: " + std::string(filename));
+    }
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+
+    if(data)    UnmapViewOfFile(data);
+    if(mapping) CloseHandle(mapping);
+    if(file)    CloseHandle(file);
+
+    mapping = nullptr;
+    file    = nullptr;
+
+#else
+
+    if(data) munmap(const_cast<u8*>(data), size);
+
+#endif
+
+    data = nullptr;
+    size = 0;
+}
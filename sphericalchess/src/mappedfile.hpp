@@ -0,0 +1,39 @@
+#pragma once
+
+#include "core.hpp"
+
+#include <cstddef>
+
+//! @brief Read only view of an entire file mapped into memory.
+//!
+//! Pages are only loaded by the operating system when they are accessed,
+//! so files larger than the available memory can be used.
+class MappedFile
+{
+public:
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    ~MappedFile() { Close(); }
+
+    //! @throws std::runtime_error When the file fails to open or be mapped.
+    void Open(const char* filename);
+    void Close();
+
+    const u8*   GetData() const { return data; }
+    std::size_t GetSize() const { return size; }
+
+    bool IsOpen() const { return data != nullptr; }
+
+private:
+
+    const u8*   data = nullptr;
+    std::size_t size = 0;
+
+#ifdef _WIN32
+    void* file    = nullptr;
+    void* mapping = nullptr;
+#endif
+};
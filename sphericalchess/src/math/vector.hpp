@@ -34,18 +34,18 @@ struct Vector<C, 2>
     {
     }
 
-    template<typename T, int S, typename = std::enable_if<(S >= NumComponents)>::type>
+    template<typename T, int S, typename = typename std::enable_if<(S >= NumComponents)>::type>
     explicit Vector(const Vector<T, S>& a) : x(a.x), y(a.y)
     {
     }
 
-    template<typename = std::enable_if<std::is_integral<Component>::value>::type>
+    template<typename U = Component, typename = typename std::enable_if<std::is_integral<U>::value>::type>
     bool operator == (const Vector& a) const
     {
         return x == a.x && y == a.y;
     }
 
-    template<typename = std::enable_if<std::is_integral<Component>::value>::type>
+    template<typename U = Component, typename = typename std::enable_if<std::is_integral<U>::value>::type>
     bool operator != (const Vector& a) const
     {
         return x != a.x || y != a.y;
@@ -109,19 +109,19 @@ struct Vector<C, 3>
     {
     }
 
-    template<typename T, int S, typename = std::enable_if<(S >= NumComponents)>::type>
+    template<typename T, int S, typename = typename std::enable_if<(S >= NumComponents)>::type>
     explicit Vector(const Vector<T, S>& a) : x(a.x), y(a.y), z(a.z)
     {
     }
 
     
-    template<typename = std::enable_if<std::is_integral<Component>::value>::type>
+    template<typename U = Component, typename = typename std::enable_if<std::is_integral<U>::value>::type>
     bool operator == (const Vector& a) const
     {
         return x == a.x && y == a.y && z == a.z;
     }
 
-    template<typename = std::enable_if<std::is_integral<Component>::value>::type>
+    template<typename U = Component, typename = typename std::enable_if<std::is_integral<U>::value>::type>
     bool operator != (const Vector& a) const
     {
         return x != a.x || y != a.y || z != a.z;
@@ -195,13 +195,13 @@ struct Vector<C, 4>
     {
     }
 
-    template<typename = std::enable_if<std::is_integral<Component>::value>::type>
+    template<typename U = Component, typename = typename std::enable_if<std::is_integral<U>::value>::type>
     bool operator == (const Vector& a) const
     {
         return x == a.x && y == a.y && z == a.z && w == a.w;
     }
 
-    template<typename = std::enable_if<std::is_integral<Component>::value>::type>
+    template<typename U = Component, typename = typename std::enable_if<std::is_integral<U>::value>::type>
     bool operator != (const Vector& a) const
     {
         return x != a.x || y != a.y || z != a.z || w != a.w;
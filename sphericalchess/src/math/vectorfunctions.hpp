@@ -114,7 +114,7 @@ auto LengthSqr(const Vector<T, S>& v)
 }
 
 //! @brief Calculates the length of a vector.
-template<typename T, int S, typename = std::enable_if<std::is_floating_point<T>::value>::type>
+template<typename T, int S, typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
 auto Length(const Vector<T, S>& v)
 {
     return std::sqrt(Dot(v, v));
@@ -123,7 +123,7 @@ auto Length(const Vector<T, S>& v)
 //! @brief Normalizes a vector to a unit vector.
 //! @param [in,out] v The vector that will be normalized, not modified if length of vector nears zero.
 //! @returns The length of the vector @p v, but if vector length nears zero (within 0.0001f) then returns zero.
-template<typename T, int S, typename = std::enable_if<std::is_floating_point<T>::value>::type>
+template<typename T, int S, typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
 auto Normalize(Vector<T, S>& v)
 {
     T length = Length(v);
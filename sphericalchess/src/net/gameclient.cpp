@@ -0,0 +1,125 @@
+#include "gameclient.hpp"
+
+#include "socket.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace Net
+{
+
+GameClient::~GameClient()
+{
+    Stop();
+}
+
+void GameClient::Start(const std::string& address, u32 game)
+{
+    Stop();
+
+    stopped = false;
+    thread  = std::thread(&GameClient::Run, this, address, game);
+}
+
+void GameClient::Stop()
+{
+    if(thread.joinable())
+    {
+        stopped = true;
+        thread.join();
+    }
+}
+
+std::string GameClient::GetError() const
+{
+    std::lock_guard<std::mutex> lock(errorMutex);
+
+    return error;
+}
+
+void GameClient::Run(const std::string& address, u32 game)
+{
+    try
+    {
+        Socket socket = Socket::Connect(address);
+        socket.SetNonBlocking();
+
+        u8          input[1024];
+        std::size_t inputSize = 0;
+
+        // written here rather than queued, only the user of the client pushes to outgoing
+
+        Message request;
+
+        request.type = game != 0 ? MessageType::Join : MessageType::Create;
+        request.game = game;
+
+        std::vector<u8> output(kMaxMessageSize);
+        output.resize(Encode(request, output.data()));
+
+        while(!stopped)
+        {
+            for(Message message; outgoing.Pop(message);)
+            {
+                u8 buffer[kMaxMessageSize];
+                output.insert(output.end(), buffer, buffer + Encode(message, buffer));
+            }
+
+            if(!output.empty())
+            {
+                output.erase(output.begin(), output.begin() + socket.Send(output.data(), output.size()));
+            }
+
+            if(!socket.Wait(!output.empty(), kWaitMilliseconds))
+            {
+                continue;
+            }
+
+            const std::ptrdiff_t received = socket.Receive(input + inputSize, sizeof(input) - inputSize);
+
+            if(received < 0)
+            {
+                throw std::runtime_error("Connection closed by the server");
+            }
+
+            inputSize += std::size_t(received);
+
+            std::size_t offset = 0;
+            ClientEvent event;
+
+            while(std::size_t bytes = Decode(input + offset, inputSize - offset, event.message))
+            {
+                offset += bytes;
+                Deliver(event);
+            }
+
+            std::memmove(input, input + offset, inputSize - offset);
+            inputSize -= offset;
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            error = ex.what();
+        }
+
+        ClientEvent event;
+        event.type = ClientEvent::Type::Disconnected;
+
+        Deliver(event);
+    }
+}
+
+void GameClient::Deliver(const ClientEvent& event)
+{
+    // the user of the client is behind, it catches up within a frame or two
+
+    while(!incoming.Push(event) && !stopped)
+    {
+        std::this_thread::yield();
+    }
+}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "message.hpp"
+#include "spscqueue.hpp"
+
+#include "../core.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Net
+{
+
+struct ClientEvent
+{
+    enum class Type
+    {
+        Message,        //!< From the server.
+        Disconnected,   //!< Failed to connect or lost the connection, see GameClient::GetError().
+    };
+
+    Type    type = Type::Message;
+    Message message;
+};
+
+//! @brief Connection to a GameServer with its socket on a background thread.
+//!
+//! Messages to send and events received are passed through lock free queues, so the thread using the client,
+//! such as the render thread, never waits on the network.
+class GameClient
+{
+public:
+
+    GameClient() = default;
+    ~GameClient();
+
+    GameClient(const GameClient&) = delete;
+
+    //! @brief Connects on the background thread, then creates a game if @p game is zero, or joins it.
+    void Start(const std::string& address, u32 game);
+    void Stop();
+
+    //! @returns False if too many messages are waiting to be sent.
+    bool Send(const Message& message) { return outgoing.Push(message); }
+
+    //! @returns False if there is no event waiting.
+    bool Poll(ClientEvent& event) { return incoming.Pop(event); }
+
+    std::string GetError() const;
+
+private:
+
+    //! Longest the thread waits for the socket before checking for messages to send.
+    static constexpr int kWaitMilliseconds = 2;
+
+    SpscQueue<Message, 256>     outgoing;
+    SpscQueue<ClientEvent, 256> incoming;
+
+    std::thread       thread;
+    std::atomic<bool> stopped { false };
+
+    mutable std::mutex errorMutex;
+    std::string        error;
+
+    void Run(const std::string& address, u32 game);
+
+    //! @brief Keeps trying to add @p event until it fits or the client is stopped.
+    void Deliver(const ClientEvent& event);
+};
+
+}
@@ -0,0 +1,1136 @@
+#include "gameserver.hpp"
+
+#include "../engine/bitboard.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Net
+{
+
+namespace
+{
+    constexpr int         kMaxEvents = 256;
+    constexpr std::size_t kInputSize = 4096;
+    constexpr int         kMaxParts  = 64;     //!< Queued messages sent by one call.
+
+    //! Plies between the snapshots new spectators start from, they are sent at most this many moves after it.
+    constexpr u16 kSnapshotInterval = 16;
+
+    //! @brief A message encoded once, shared by the queues of every connection it is sent to.
+    struct Packet
+    {
+        u8          data[kMaxMessageSize];
+        std::size_t size = 0;
+    };
+
+    using PacketPtr = std::shared_ptr<const Packet>;
+
+    PacketPtr MakePacket(const Message& message)
+    {
+        auto packet = std::make_shared<Packet>();
+        packet->size = Encode(message, packet->data);
+
+        return packet;
+    }
+}
+
+struct GameServer::Connection
+{
+    Socket  socket;
+    Worker* worker = nullptr;   //!< That owns the connection.
+    int     epoll  = -1;        //!< Of the worker.
+
+    u8          input[kInputSize];
+    std::size_t inputSize = 0;
+
+    std::vector<u32> games;     //!< Playing, only used by the owning worker.
+    std::vector<u32> watching;  //!< Only used by the owning worker.
+
+    //! @brief The part of a packet not yet sent.
+    struct Pending
+    {
+        PacketPtr   packet;
+        std::size_t offset = 0;
+    };
+
+    std::mutex          outputMutex;
+    std::deque<Pending> output;             //!< Waiting to be sent, guarded by outputMutex.
+    bool                writing   = false;  //!< Waiting for room in the socket.
+    bool                scheduled = false;  //!< In the ready list of the worker.
+    bool                closed    = false;
+
+    //! @brief Sends now if the socket has room, otherwise queues it for the owning worker to send.
+    //!        Called from any thread.
+    void Send(const PacketPtr& packet)
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+
+        if(closed)
+        {
+            return;
+        }
+
+        std::size_t sent = 0;
+
+        if(output.empty())
+        {
+            try
+            {
+                sent = socket.Send(packet->data, packet->size);
+            }
+            catch(const std::exception&)
+            {
+                return; // the owner is told by epoll and closes it
+            }
+        }
+
+        if(sent < packet->size)
+        {
+            output.push_back({ packet, sent });
+            Watch(true);
+        }
+    }
+
+    //! @brief Queues without sending, for the owning worker to send along with whatever else is queued.
+    //!        Called from any thread.
+    //! @returns True if the caller has to schedule the connection with its worker.
+    bool Queue(const PacketPtr& packet)
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+
+        if(closed)
+        {
+            return false;
+        }
+
+        output.push_back({ packet, 0 });
+
+        // already on its way either from the ready list or when the socket has room
+
+        if(scheduled || writing)
+        {
+            return false;
+        }
+
+        scheduled = true;
+
+        return true;
+    }
+
+    //! @brief Sends what is queued, on the owning worker.
+    //! @returns False if the connection has failed.
+    bool Flush()
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+
+        scheduled = false;
+
+        if(closed)
+        {
+            return true;
+        }
+
+        while(!output.empty())
+        {
+            iovec       parts[kMaxParts];
+            int         count = 0;
+            std::size_t size  = 0;
+
+            for(auto it = output.begin(); it != output.end() && count < kMaxParts; ++it, ++count)
+            {
+                parts[count].iov_base = const_cast<u8*>(it->packet->data + it->offset);
+                parts[count].iov_len  = it->packet->size - it->offset;
+
+                size += parts[count].iov_len;
+            }
+
+            msghdr header;
+            std::memset(&header, 0, sizeof(header));
+
+            header.msg_iov    = parts;
+            header.msg_iovlen = std::size_t(count);
+
+            const ssize_t sent = sendmsg(socket.GetHandle(), &header, MSG_NOSIGNAL);
+
+            if(sent < 0)
+            {
+                if(errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    break;
+                }
+
+                return false;
+            }
+
+            Consume(std::size_t(sent));
+
+            if(std::size_t(sent) < size)
+            {
+                break;
+            }
+        }
+
+        Watch(!output.empty());
+
+        return true;
+    }
+
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+
+        epoll_ctl(epoll, EPOLL_CTL_DEL, socket.GetHandle(), nullptr);
+        socket.Close();
+
+        closed = true;
+        output.clear();
+    }
+
+private:
+
+    //! @brief Removes @p bytes sent from the front of the queue, outputMutex must be held.
+    void Consume(std::size_t bytes)
+    {
+        while(bytes > 0)
+        {
+            Pending& front = output.front();
+
+            const std::size_t part = std::min(bytes, front.packet->size - front.offset);
+
+            front.offset += part;
+            bytes        -= part;
+
+            if(front.offset == front.packet->size)
+            {
+                output.pop_front();
+            }
+        }
+    }
+
+    //! @brief Waits for room in the socket or stops waiting, outputMutex must be held.
+    void Watch(bool write)
+    {
+        if(writing == write)
+        {
+            return;
+        }
+
+        epoll_event event;
+
+        event.events   = EPOLLIN | EPOLLRDHUP | (write ? u32(EPOLLOUT) : 0u);
+        event.data.ptr = this;
+
+        epoll_ctl(epoll, EPOLL_CTL_MOD, socket.GetHandle(), &event);
+
+        writing = write;
+    }
+};
+
+struct GameServer::Game
+{
+    std::mutex mutex;
+
+    u32 id = 0;
+
+    Engine::BitboardPosition position;
+    u64                      masks[Engine::kNumSquares];   //!< Legal moves of the position.
+
+    u16     ply = 0;
+    GameEnd end = GameEnd::None;
+
+    std::shared_ptr<Connection> players[2];
+
+    std::vector<std::shared_ptr<Connection>> spectators;
+
+    PacketPtr              snapshot;    //!< Of the position every kSnapshotInterval plies.
+    std::vector<PacketPtr> recent;      //!< Moves made since the snapshot.
+
+    bool closed = false;    //!< Removed from its shard, the spectators are dropped after the last message.
+
+    void TakeSnapshot()
+    {
+        snapshot = MakePacket(MakeSnapshot(id, ply, end, position));
+        recent.clear();
+    }
+
+    //! @brief Sends @p packet to the players and queues it for the spectators.
+    void SendAll(const PacketPtr& packet);
+};
+
+//! @brief Thread running an epoll loop over the connections it has accepted.
+class GameServer::Worker
+{
+public:
+
+    explicit Worker(GameServer& server) : server(server)
+    {
+        epoll = epoll_create1(0);
+        wake  = eventfd(0, EFD_NONBLOCK);
+
+        if(epoll < 0 || wake < 0)
+        {
+            Cleanup();
+            throw std::runtime_error("Failed to create epoll for the game server");
+        }
+
+        epoll_event event;
+
+        // only one worker is woken per connection, which then belongs to it
+
+        event.events   = EPOLLIN | EPOLLEXCLUSIVE;
+        event.data.ptr = nullptr;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, server.listener.GetHandle(), &event);
+
+        event.events   = EPOLLIN;
+        event.data.ptr = this;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, wake, &event);
+    }
+
+    ~Worker()
+    {
+        for(auto& entry : connections)
+        {
+            entry.second->Close();
+        }
+
+        Cleanup();
+    }
+
+    void Run()
+    {
+        epoll_event events[kMaxEvents];
+
+        while(!stopped)
+        {
+            const int count = epoll_wait(epoll, events, kMaxEvents, -1);
+
+            for(int i = 0; i < count; ++i)
+            {
+                void* const target = events[i].data.ptr;
+
+                if(target == nullptr)
+                {
+                    Accept();
+                }
+                else if(target == this)
+                {
+                    Woken();
+                }
+                else
+                {
+                    Service(*static_cast<Connection*>(target), events[i].events);
+                }
+            }
+
+            // later events of the same wait may still point at them
+
+            closing.clear();
+        }
+    }
+
+    void Stop()
+    {
+        stopping = true;
+        Wake();
+    }
+
+    //! @brief Has the worker send what is queued for @p connection, called from any thread.
+    void Schedule(std::shared_ptr<Connection> connection)
+    {
+        bool wasEmpty = false;
+
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+
+            wasEmpty = ready.empty();
+            ready.push_back(std::move(connection));
+        }
+
+        // a list that wasn't empty has a wake pending already
+
+        if(wasEmpty)
+        {
+            Wake();
+        }
+    }
+
+private:
+
+    GameServer& server;
+
+    int  epoll   = -1;
+    int  wake    = -1;
+    bool stopped = false;
+
+    std::atomic<bool> stopping { false };
+
+    std::unordered_map<Connection*, std::shared_ptr<Connection>> connections;
+    std::vector<std::shared_ptr<Connection>>                     closing;
+
+    std::mutex                               readyMutex;
+    std::vector<std::shared_ptr<Connection>> ready;     //!< Scheduled by other threads, guarded by readyMutex.
+    std::vector<std::shared_ptr<Connection>> flushing;  //!< Swapped with ready to send outside the lock.
+
+    void Wake()
+    {
+        const u64 value = 1;
+
+        if(write(wake, &value, sizeof(value)) < 0)
+        {
+            // the counter can't overflow from one write, nothing to handle
+        }
+    }
+
+    void Woken()
+    {
+        u64 value = 0;
+
+        // cleared before taking the list, a connection scheduled after this wakes the worker again
+
+        if(read(wake, &value, sizeof(value)) < 0)
+        {
+            // already cleared, the list is taken anyway
+        }
+
+        if(stopping)
+        {
+            stopped = true;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            flushing.swap(ready);
+        }
+
+        for(const auto& connection : flushing)
+        {
+            if(!connection->Flush() && connections.count(connection.get()))
+            {
+                Close(connection);
+            }
+        }
+
+        flushing.clear();
+    }
+
+    void Accept()
+    {
+        while(true)
+        {
+            Socket socket = server.listener.Accept();
+
+            if(!socket.IsOpen())
+            {
+                return;
+            }
+
+            socket.SetNonBlocking();
+
+            auto connection = std::make_shared<Connection>();
+
+            connection->socket = std::move(socket);
+            connection->worker = this;
+            connection->epoll  = epoll;
+
+            epoll_event event;
+
+            event.events   = EPOLLIN | EPOLLRDHUP;
+            event.data.ptr = connection.get();
+
+            if(epoll_ctl(epoll, EPOLL_CTL_ADD, connection->socket.GetHandle(), &event) != 0)
+            {
+                continue;
+            }
+
+            connections.emplace(connection.get(), connection);
+            ++server.connections;
+        }
+    }
+
+    void Service(Connection& target, u32 events)
+    {
+        auto found = connections.find(&target);
+
+        if(found == connections.end())
+        {
+            return; // closed earlier in this wait
+        }
+
+        const std::shared_ptr<Connection> connection = found->second;
+
+        bool open = (events & EPOLLERR) == 0;
+
+        if(open && (events & EPOLLOUT))
+        {
+            open = connection->Flush();
+        }
+
+        if(open && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+        {
+            open = Read(connection);
+        }
+
+        if(!open)
+        {
+            Close(connection);
+        }
+    }
+
+    //! @returns False if the connection has closed or sent something that isn't a message.
+    bool Read(const std::shared_ptr<Connection>& connection)
+    {
+        Connection& c = *connection;
+
+        try
+        {
+            const std::ptrdiff_t received = c.socket.Receive(c.input + c.inputSize, kInputSize - c.inputSize);
+
+            if(received < 0)
+            {
+                return false;
+            }
+
+            c.inputSize += std::size_t(received);
+
+            std::size_t offset = 0;
+            Message     message;
+
+            while(std::size_t bytes = Decode(c.input + offset, c.inputSize - offset, message))
+            {
+                offset += bytes;
+                server.Handle(connection, message);
+            }
+
+            std::memmove(c.input, c.input + offset, c.inputSize - offset);
+            c.inputSize -= offset;
+        }
+        catch(const std::exception&)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    void Close(const std::shared_ptr<Connection>& connection)
+    {
+        connection->Close();
+
+        // copied as leaving removes the game from the list
+
+        const std::vector<u32> games = connection->games;
+
+        for(u32 id : games)
+        {
+            server.Leave(connection, id, false);
+        }
+
+        const std::vector<u32> watching = connection->watching;
+
+        for(u32 id : watching)
+        {
+            server.Unwatch(connection, id, false);
+        }
+
+        connections.erase(connection.get());
+        closing.push_back(connection);
+
+        --server.connections;
+    }
+
+    void Cleanup()
+    {
+        if(epoll >= 0) close(epoll);
+        if(wake  >= 0) close(wake);
+    }
+};
+
+void GameServer::Game::SendAll(const PacketPtr& packet)
+{
+    for(auto& player : players)
+    {
+        if(player)
+        {
+            player->Send(packet);
+        }
+    }
+
+    for(auto& spectator : spectators)
+    {
+        if(spectator->Queue(packet))
+        {
+            spectator->worker->Schedule(spectator);
+        }
+    }
+}
+
+GameServer::GameServer(const GameServerSettings& settings)
+    : settings(settings)
+    , listener(Socket::Listen(settings.address))
+{
+    listener.SetNonBlocking();
+
+    if(!settings.journal.empty())
+    {
+        Recover();
+    }
+}
+
+GameServer::~GameServer()
+{
+    Stop();
+}
+
+void GameServer::Start()
+{
+    // stopping clears the games, including those recovered from the journal
+
+    if(!workers.empty())
+    {
+        Stop();
+    }
+
+    for(int i = 0; i < std::max(settings.threads, 1); ++i)
+    {
+        workers.emplace_back(new Worker(*this));
+    }
+
+    for(auto& worker : workers)
+    {
+        threads.emplace_back(&Worker::Run, worker.get());
+    }
+}
+
+void GameServer::Stop()
+{
+    for(auto& worker : workers)
+    {
+        worker->Stop();
+    }
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // the journals send the last moves through the workers
+
+    for(auto& journal : journals)
+    {
+        journal->Sync();
+    }
+
+    threads.clear();
+    workers.clear();
+
+    for(auto& shard : shards)
+    {
+        shard.games.clear();
+    }
+
+    games = 0;
+}
+
+GameServerStats GameServer::GetStats() const
+{
+    GameServerStats stats;
+
+    stats.connections = connections;
+    stats.games       = games;
+    stats.spectators  = spectators;
+    stats.moves       = moves;
+    stats.rejected    = rejected;
+
+    for(auto& journal : journals)
+    {
+        stats.commits += journal->GetCommits();
+    }
+
+    return stats;
+}
+
+void GameServer::Handle(const std::shared_ptr<Connection>& connection, const Message& message)
+{
+    switch(message.type)
+    {
+    case MessageType::Create:  Create(connection);                                 break;
+    case MessageType::Join:    Join(connection, message.game);                     break;
+    case MessageType::Move:    MakeMove(connection, message.game, message.move);   break;
+    case MessageType::Leave:   Leave(connection, message.game, true);              break;
+    case MessageType::Watch:   Watch(connection, message.game);                    break;
+    case MessageType::Unwatch: Unwatch(connection, message.game, true);            break;
+
+    default:
+        throw std::runtime_error("Message can only be sent by the server");
+    }
+}
+
+void GameServer::Create(const std::shared_ptr<Connection>& connection)
+{
+    auto game = std::make_shared<Game>();
+
+    game->id = nextGame++;
+    game->position.SetStart();
+    game->position.GenerateLegal(game->masks);
+    game->players[int(Piece::Team::White)] = connection;
+    game->TakeSnapshot();
+
+    std::lock_guard<std::mutex> lock(game->mutex);
+
+    {
+        Shard& shard = GetShard(game->id);
+        std::lock_guard<std::mutex> shardLock(shard.mutex);
+
+        shard.games.emplace(game->id, game);
+    }
+
+    ++games;
+
+    connection->games.push_back(game->id);
+
+    Message joined;
+
+    joined.type = MessageType::Joined;
+    joined.game = game->id;
+    joined.team = u8(Piece::Team::White);
+
+    JournalRecord record;
+
+    record.type = JournalRecord::Type::Create;
+    record.game = game->id;
+
+    Commit(game, record, joined, true);
+}
+
+void GameServer::Join(const std::shared_ptr<Connection>& connection, u32 id)
+{
+    const std::shared_ptr<Game> game = FindGame(id);
+
+    if(!game)
+    {
+        Reject(*connection, id, 0, RejectReason::NoGame);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(game->mutex);
+
+    if(game->end != GameEnd::None)
+    {
+        Reject(*connection, id, 0, RejectReason::Ended);
+        return;
+    }
+
+    auto seat = std::find(std::begin(game->players), std::end(game->players), nullptr);
+
+    if(seat == std::end(game->players) || std::find(std::begin(game->players), std::end(game->players), connection) != std::end(game->players))
+    {
+        Reject(*connection, id, 0, RejectReason::Full);
+        return;
+    }
+
+    *seat = connection;
+    connection->games.push_back(id);
+
+    Message joined;
+
+    joined.type = MessageType::Joined;
+    joined.game = id;
+    joined.team = u8(seat - std::begin(game->players));
+
+    game->SendAll(MakePacket(joined));
+
+    // the joiner starts from the position like a spectator does, under the lock so no move can come before it
+
+    connection->Send(game->snapshot);
+
+    for(const PacketPtr& packet : game->recent)
+    {
+        connection->Send(packet);
+    }
+}
+
+void GameServer::MakeMove(const std::shared_ptr<Connection>& connection, u32 id, u16 move)
+{
+    const std::shared_ptr<Game> game = FindGame(id);
+
+    if(!game)
+    {
+        Reject(*connection, id, move, RejectReason::NoGame);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(game->mutex);
+
+    Engine::BitboardPosition& position = game->position;
+
+    const int origin      = move & 63;
+    const int destination = (move >> 6) & 63;
+
+    if(game->players[position.turn] != connection)
+    {
+        Reject(*connection, id, move, game->players[position.turn ^ 1] == connection ? RejectReason::NotTurn : RejectReason::NotPlayer);
+    }
+    else if(game->end != GameEnd::None)
+    {
+        Reject(*connection, id, move, RejectReason::Ended);
+    }
+    else if(!game->players[position.turn ^ 1])
+    {
+        Reject(*connection, id, move, RejectReason::NotTurn); // nothing is played until the other player has joined
+    }
+    else if((game->masks[origin] & (u64(1) << destination)) == 0)
+    {
+        Reject(*connection, id, move, RejectReason::Illegal);
+    }
+    else
+    {
+        Message moved;
+
+        moved.type = MessageType::Moved;
+        moved.game = id;
+        moved.move = position.ToMove(origin, destination).GetData();
+
+        position.Apply(origin, destination);
+
+        moved.ply = ++game->ply;
+
+        if(position.GenerateLegal(game->masks) == 0)
+        {
+            game->end = position.IsInCheck(position.turn) ? GameEnd::Checkmate : GameEnd::Stalemate;
+        }
+
+        moved.end = game->end;
+
+        ++moves;
+
+        JournalRecord record;
+
+        record.type = JournalRecord::Type::Move;
+        record.game = id;
+        record.move = moved.move;
+
+        Commit(game, record, moved, game->ply % kSnapshotInterval == 0 || game->end != GameEnd::None);
+    }
+}
+
+void GameServer::Leave(const std::shared_ptr<Connection>& connection, u32 id, bool reply)
+{
+    const std::shared_ptr<Game> game = FindGame(id);
+
+    if(!game)
+    {
+        if(reply)
+        {
+            Reject(*connection, id, 0, RejectReason::NoGame);
+        }
+
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(game->mutex);
+
+    auto seat = std::find(std::begin(game->players), std::end(game->players), connection);
+
+    if(seat == std::end(game->players))
+    {
+        if(reply)
+        {
+            Reject(*connection, id, 0, RejectReason::NotPlayer);
+        }
+
+        return;
+    }
+
+    seat->reset();
+    connection->games.erase(std::find(connection->games.begin(), connection->games.end(), id));
+
+    // a game with a player missing can't go on, nor be joined again
+
+    if(game->end == GameEnd::None)
+    {
+        game->end = GameEnd::Abandoned;
+    }
+
+    Message left;
+
+    left.type = MessageType::Left;
+    left.game = id;
+    left.team = u8(seat - std::begin(game->players));
+
+    if(std::count(std::begin(game->players), std::end(game->players), nullptr) == 2)
+    {
+        Shard& shard = GetShard(id);
+        std::lock_guard<std::mutex> shardLock(shard.mutex);
+
+        shard.games.erase(id);
+        --games;
+
+        game->closed = true;
+    }
+
+    JournalRecord record;
+
+    record.type = JournalRecord::Type::Leave;
+    record.game = id;
+
+    Commit(game, record, left, true);
+}
+
+void GameServer::Watch(const std::shared_ptr<Connection>& connection, u32 id)
+{
+    const std::shared_ptr<Game> game = FindGame(id);
+
+    if(!game)
+    {
+        Reject(*connection, id, 0, RejectReason::NoGame);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(game->mutex);
+
+    if(std::find(game->spectators.begin(), game->spectators.end(), connection) != game->spectators.end())
+    {
+        return;
+    }
+
+    game->spectators.push_back(connection);
+    connection->watching.push_back(id);
+
+    ++spectators;
+
+    // sent under the lock of the game, so nothing broadcast since can come before them
+
+    connection->Send(game->snapshot);
+
+    for(const PacketPtr& packet : game->recent)
+    {
+        connection->Send(packet);
+    }
+}
+
+void GameServer::Unwatch(const std::shared_ptr<Connection>& connection, u32 id, bool reply)
+{
+    auto watched = std::find(connection->watching.begin(), connection->watching.end(), id);
+
+    if(watched == connection->watching.end())
+    {
+        if(reply)
+        {
+            Reject(*connection, id, 0, RejectReason::NotWatching);
+        }
+
+        return;
+    }
+
+    connection->watching.erase(watched);
+
+    const std::shared_ptr<Game> game = FindGame(id);
+
+    if(!game)
+    {
+        return; // over, and the spectators already dropped
+    }
+
+    std::lock_guard<std::mutex> lock(game->mutex);
+
+    auto spectator = std::find(game->spectators.begin(), game->spectators.end(), connection);
+
+    if(spectator != game->spectators.end())
+    {
+        // order doesn't matter, swap with the last to not move the rest
+
+        *spectator = std::move(game->spectators.back());
+        game->spectators.pop_back();
+
+        --spectators;
+    }
+}
+
+void GameServer::Recover()
+{
+    const int numJournals = std::max(settings.journalShards, 1);
+
+    auto filename = [&](int index) { return settings.journal + "/games" + std::to_string(index) + ".journal"; };
+
+    // the moves of the games in progress, in the order they were created
+
+    std::unordered_map<u32, std::vector<u16>> played;
+    std::vector<u32>                          order;
+
+    u32 lastGame = 0;
+
+    // a previous server may have had more journals, read until there are no more
+
+    int numFiles = 0;
+
+    for(struct stat status; numFiles < numJournals || stat(filename(numFiles).c_str(), &status) == 0; ++numFiles)
+    {
+        for(const JournalRecord& record : Journal::Read(filename(numFiles)))
+        {
+            lastGame = std::max(lastGame, record.game);
+
+            switch(record.type)
+            {
+            case JournalRecord::Type::Create:
+                played[record.game];
+                order.push_back(record.game);
+                break;
+
+            case JournalRecord::Type::Move:
+                {
+                    auto found = played.find(record.game);
+
+                    if(found != played.end())
+                    {
+                        found->second.push_back(record.move);
+                    }
+                }
+                break;
+
+            case JournalRecord::Type::Leave:
+                played.erase(record.game);
+                break;
+            }
+        }
+    }
+
+    // written back with only the games still in progress, which keeps the journals from growing forever
+
+    std::vector<std::vector<JournalRecord>> compacted(numJournals);
+
+    for(u32 id : order)
+    {
+        auto found = played.find(id);
+
+        if(found == played.end())
+        {
+            continue;
+        }
+
+        auto game = std::make_shared<Game>();
+
+        game->id = id;
+        game->position.SetStart();
+
+        for(u16 move : found->second)
+        {
+            game->position.Apply(move & 63, (move >> 6) & 63);
+        }
+
+        game->ply = u16(found->second.size());
+
+        // ended with both players still in it, there is nothing left to join for
+
+        if(game->position.GenerateLegal(game->masks) == 0)
+        {
+            continue;
+        }
+
+        game->TakeSnapshot();
+
+        std::vector<JournalRecord>& records = compacted[id % numJournals];
+
+        records.push_back({ JournalRecord::Type::Create, id, 0 });
+
+        for(u16 move : found->second)
+        {
+            records.push_back({ JournalRecord::Type::Move, id, move });
+        }
+
+        GetShard(id).games.emplace(id, game);
+        ++games;
+    }
+
+    for(int i = 0; i < numJournals; ++i)
+    {
+        journals.emplace_back(new Journal(filename(i), compacted[i]));
+    }
+
+    for(int i = numJournals; i < numFiles; ++i)
+    {
+        unlink(filename(i).c_str());
+    }
+
+    nextGame = lastGame + 1;
+}
+
+void GameServer::Commit(const std::shared_ptr<Game>& game, const JournalRecord& record, const Message& message, bool snapshot)
+{
+    const PacketPtr packet   = MakePacket(message);
+    const PacketPtr position = snapshot ? MakePacket(MakeSnapshot(game->id, game->ply, game->end, game->position)) : nullptr;
+
+    // only what is durable is sent, including to spectators that start watching before it is
+
+    auto publish = [this, game, packet, position]
+    {
+        game->SendAll(packet);
+
+        if(position)
+        {
+            game->snapshot = position;
+            game->recent.clear();
+        }
+        else
+        {
+            game->recent.push_back(packet);
+        }
+
+        // they have been sent the last message, and drop the game from their lists when they unwatch or disconnect
+
+        if(game->closed)
+        {
+            spectators -= game->spectators.size();
+            game->spectators.clear();
+        }
+    };
+
+    if(journals.empty())
+    {
+        publish();
+        return;
+    }
+
+    journals[game->id % journals.size()]->Append(record, [game, publish]
+    {
+        std::lock_guard<std::mutex> lock(game->mutex);
+        publish();
+    });
+}
+
+void GameServer::Reject(Connection& connection, u32 id, u16 move, RejectReason reason)
+{
+    Message rejected;
+
+    rejected.type   = MessageType::Rejected;
+    rejected.game   = id;
+    rejected.move   = move;
+    rejected.reason = reason;
+
+    connection.Send(MakePacket(rejected));
+
+    ++this->rejected;
+}
+
+std::shared_ptr<GameServer::Game> GameServer::FindGame(u32 id)
+{
+    Shard& shard = GetShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.games.find(id);
+
+    return found != shard.games.end() ? found->second : nullptr;
+}
+
+}
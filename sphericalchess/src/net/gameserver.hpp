@@ -0,0 +1,137 @@
+#pragma once
+
+#include "journal.hpp"
+#include "message.hpp"
+#include "socket.hpp"
+
+#include "../core.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Net
+{
+
+struct GameServerSettings
+{
+    std::string address = ":7531";     //!< See Socket for the formats.
+    int         threads = 1;
+
+    //! Directory for the journals of the moves made, the games in them are rebuilt when the server is
+    //! created. Without one moves are sent as soon as they are made and lost if the server stops.
+    std::string journal;
+    int         journalShards = 4;      //!< Journal files, each with its own thread to write it.
+};
+
+struct GameServerStats
+{
+    u64 connections = 0;    //!< Open now.
+    u64 games       = 0;    //!< With at least one player now.
+    u64 spectators  = 0;    //!< Watching a game now, counted once per game watched.
+    u64 moves       = 0;    //!< Made since the server started.
+    u64 rejected    = 0;    //!< Requests rejected since the server started.
+    u64 commits     = 0;    //!< Writes of the journal made durable since the server started.
+};
+
+//! @brief Hosts games between clients speaking the Message protocol, Linux only.
+//!
+//! Each thread runs its own epoll loop and accepts its own connections from the shared listening socket,
+//! so a connection is only ever read by one thread. The two players of a game can be on different threads,
+//! each game has a lock so its moves are validated and sent to both players one at a time, in order.
+//! Games are BitboardPosition with the legal moves of the current position kept, so checking a move is a
+//! lookup and the moves are generated once per move made, which also finds when the game has ended.
+//!
+//! Each message of a game is encoded once and the same buffer is queued for every spectator, who are sent
+//! their queues by the thread that owns their connection, so a popular game spreads its writes over all the
+//! threads instead of the one that made the move. A game keeps a snapshot of its position every few plies
+//! and the moves since, which is all a new spectator is sent to catch up.
+//!
+//! With a journal, games are spread over its files by id and a move is only sent once its record is on
+//! disk, from the thread writing the journal. Players that get a move back know it survives a crash, after
+//! which the games in progress are rebuilt for their players to join again. A game ends, and is dropped
+//! from the journal, once a player leaves, which is also when a player disconnects.
+class GameServer
+{
+public:
+
+    //! @throws std::runtime_error When the address can't be listened on or the journal can't be written.
+    explicit GameServer(const GameServerSettings& settings);
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+
+    //! @brief Starts the threads and returns, the server runs until Stop() or it is destroyed.
+    void Start();
+    void Stop();
+
+    GameServerStats GetStats() const;
+
+private:
+
+    class Worker;
+    struct Connection;
+    struct Game;
+
+    static constexpr int kNumShards = 64;
+
+    //! Games are spread over shards by id so looking one up rarely waits on another thread.
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<u32, std::shared_ptr<Game>> games;
+    };
+
+    GameServerSettings settings;
+    Socket             listener;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread>             threads;
+
+    Shard shards[kNumShards];
+
+    std::atomic<u32> nextGame    { 1 };
+    std::atomic<u64> connections { 0 };
+    std::atomic<u64> games       { 0 };
+    std::atomic<u64> spectators  { 0 };
+    std::atomic<u64> moves       { 0 };
+    std::atomic<u64> rejected    { 0 };
+
+    //! Destroyed first, it calls back into the server until everything in it is on disk.
+    std::vector<std::unique_ptr<Journal>> journals;
+
+    //! @brief Answers a message from @p connection, on the thread that owns it.
+    void Handle(const std::shared_ptr<Connection>& connection, const Message& message);
+
+    void Create(const std::shared_ptr<Connection>& connection);
+    void Join(const std::shared_ptr<Connection>& connection, u32 id);
+    void MakeMove(const std::shared_ptr<Connection>& connection, u32 id, u16 move);
+
+    //! @param [in] reply Whether to reject leaving a game @p connection isn't playing, false when it disconnects.
+    void Leave(const std::shared_ptr<Connection>& connection, u32 id, bool reply);
+
+    void Watch(const std::shared_ptr<Connection>& connection, u32 id);
+
+    //! @param [in] reply Whether to reject unwatching a game @p connection isn't watching, false when it disconnects.
+    void Unwatch(const std::shared_ptr<Connection>& connection, u32 id, bool reply);
+
+    //! @brief Rebuilds the games of the journal files in the directory of the settings and compacts the files.
+    void Recover();
+
+    //! @brief Sends @p message to the players and spectators of @p game once @p record is durable, at once
+    //!        without a journal. The game's lock must be held.
+    //! @param [in] snapshot Whether new spectators start from the position now, otherwise @p message is
+    //!                      one of the moves they are sent after the last snapshot.
+    void Commit(const std::shared_ptr<Game>& game, const JournalRecord& record, const Message& message, bool snapshot);
+
+    void Reject(Connection& connection, u32 id, u16 move, RejectReason reason);
+
+    std::shared_ptr<Game> FindGame(u32 id);
+    Shard& GetShard(u32 id) { return shards[id % kNumShards]; }
+};
+
+}
@@ -0,0 +1,316 @@
+#include "journal.hpp"
+
+#include "../mappedfile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Net
+{
+
+namespace
+{
+    //! @brief CRC-32 with the polynomial of zlib and PNG, a table lookup per byte.
+    class Crc32
+    {
+    public:
+
+        Crc32()
+        {
+            for(u32 i = 0; i < 256; ++i)
+            {
+                u32 value = i;
+
+                for(int bit = 0; bit < 8; ++bit)
+                {
+                    value = (value >> 1) ^ (value & 1 ? 0xEDB88320u : 0);
+                }
+
+                table[i] = value;
+            }
+        }
+
+        u32 operator () (const u8* data, std::size_t size) const
+        {
+            u32 value = 0xFFFFFFFFu;
+
+            for(std::size_t i = 0; i < size; ++i)
+            {
+                value = table[(value ^ data[i]) & 0xFF] ^ (value >> 8);
+            }
+
+            return value ^ 0xFFFFFFFFu;
+        }
+
+    private:
+
+        u32 table[256];
+    };
+
+    const Crc32 kCrc32;
+
+    constexpr std::size_t kDataSize = Journal::kRecordSize - 4;
+
+    void Write32(u8* output, u32 value)
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            output[i] = u8(value >> (8 * i));
+        }
+    }
+
+    u32 Read32(const u8* data)
+    {
+        return u32(data[0]) | (u32(data[1]) << 8) | (u32(data[2]) << 16) | (u32(data[3]) << 24);
+    }
+
+    void Encode(const JournalRecord& record, u8* output)
+    {
+        output[0] = u8(record.type);
+        Write32(output + 1, record.game);
+        output[5] = u8(record.move);
+        output[6] = u8(record.move >> 8);
+
+        Write32(output + kDataSize, kCrc32(output, kDataSize));
+    }
+
+    //! @returns False if the record is corrupt.
+    bool Decode(const u8* data, JournalRecord& record)
+    {
+        if(Read32(data + kDataSize) != kCrc32(data, kDataSize) || data[0] < u8(JournalRecord::Type::Create) || data[0] > u8(JournalRecord::Type::Leave))
+        {
+            return false;
+        }
+
+        record.type = JournalRecord::Type(data[0]);
+        record.game = Read32(data + 1);
+        record.move = u16(data[5] | (data[6] << 8));
+
+        return true;
+    }
+
+    //! @returns False if the write failed.
+    bool WriteAll(int fd, const u8* data, std::size_t size)
+    {
+        while(size > 0)
+        {
+            const ssize_t written = write(fd, data, size);
+
+            if(written < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+
+                return false;
+            }
+
+            data += written;
+            size -= std::size_t(written);
+        }
+
+        return true;
+    }
+
+    //! @brief Makes a rename in @p filename's directory durable.
+    void SyncDirectory(const std::string& filename)
+    {
+        const std::size_t slash     = filename.rfind('/');
+        const std::string directory = slash == std::string::npos ? "." : filename.substr(0, std::max<std::size_t>(slash, 1));
+
+        const int descriptor = open(directory.c_str(), O_RDONLY);
+
+        if(descriptor >= 0)
+        {
+            fsync(descriptor);
+            close(descriptor);
+        }
+    }
+}
+
+std::vector<JournalRecord> Journal::Read(const std::string& filename)
+{
+    std::vector<JournalRecord> records;
+
+    struct stat status;
+
+    if(stat(filename.c_str(), &status) != 0)
+    {
+        return records;
+    }
+
+    MappedFile file;
+    file.Open(filename.c_str());
+
+    records.reserve(file.GetSize() / kRecordSize);
+
+    JournalRecord record;
+
+    for(std::size_t offset = 0; offset + kRecordSize <= file.GetSize() && Decode(file.GetData() + offset, record); offset += kRecordSize)
+    {
+        records.push_back(record);
+    }
+
+    return records;
+}
+
+Journal::Journal(const std::string& filename, const std::vector<JournalRecord>& records)
+{
+    // written aside and renamed over, so a crash now leaves either the old file or the new one
+
+    const std::string temporary = filename + ".tmp";
+
+    std::vector<u8> data(records.size() * kRecordSize);
+
+    for(std::size_t i = 0; i < records.size(); ++i)
+    {
+        Encode(records[i], data.data() + i * kRecordSize);
+    }
+
+    const int descriptor = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    const bool written = descriptor >= 0 && WriteAll(descriptor, data.data(), data.size()) && fdatasync(descriptor) == 0;
+
+    if(descriptor >= 0)
+    {
+        close(descriptor);
+    }
+
+    if(!written || rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        throw std::runtime_error("Failed to write journal " + filename + ": " + std::strerror(errno));
+    }
+
+    SyncDirectory(filename);
+
+    fd = open(filename.c_str(), O_WRONLY | O_APPEND);
+
+    if(fd < 0)
+    {
+        throw std::runtime_error("Failed to open journal " + filename + ": " + std::strerror(errno));
+    }
+
+    thread = std::thread(&Journal::Run, this);
+}
+
+Journal::~Journal()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+
+    wake.notify_one();
+    thread.join();
+
+    close(fd);
+}
+
+void Journal::Append(const JournalRecord& record, Callback committed)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if(failed)
+        {
+            throw std::runtime_error("Journal failed to write, moves are no longer durable");
+        }
+
+        const std::size_t offset = pending.size();
+
+        pending.resize(offset + kRecordSize);
+        Encode(record, pending.data() + offset);
+
+        callbacks.push_back(std::move(committed));
+
+        ++appended;
+    }
+
+    wake.notify_one();
+}
+
+void Journal::Sync()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    const u64 target = appended;
+
+    synced.wait(lock, [&] { return completed >= target || failed; });
+}
+
+u64 Journal::GetCommits() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return commits;
+}
+
+void Journal::Run()
+{
+    std::vector<u8>       writing;
+    std::vector<Callback> committing;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true)
+    {
+        wake.wait(lock, [&] { return !pending.empty() || stopped; });
+
+        if(pending.empty())
+        {
+            return; // stopped with everything written
+        }
+
+        // whatever is appended while this batch is written goes in the next one
+
+        writing.swap(pending);
+        committing.swap(callbacks);
+
+        lock.unlock();
+
+        const bool written = WriteAll(fd, writing.data(), writing.size()) && fdatasync(fd) == 0;
+
+        if(written)
+        {
+            for(const Callback& callback : committing)
+            {
+                callback();
+            }
+        }
+
+        lock.lock();
+
+        if(written)
+        {
+            completed += committing.size();
+            ++commits;
+        }
+        else
+        {
+            // the file may now end in part of a record, which replaying drops along with what comes after
+
+            failed = true;
+            pending.clear();
+            callbacks.clear();
+        }
+
+        writing.clear();
+        committing.clear();
+
+        synced.notify_all();
+
+        if(failed)
+        {
+            return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../core.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Net
+{
+
+struct JournalRecord
+{
+    enum class Type : u8
+    {
+        Create = 1,
+        Move,
+        Leave,      //!< A player left, which ends the game.
+    };
+
+    Type type = Type::Create;
+    u32  game = 0;
+    u16  move = 0;  //!< Engine::Move data of a Move.
+};
+
+//! @brief Append only file of the moves made in games, for a GameServer to rebuild its games after a crash.
+//!
+//! Records are a fixed 11 bytes, the type, game and move followed by a CRC-32 of them, so the record a crash
+//! tore in half is found and it and anything after it are dropped. Appending only queues the record, a thread
+//! writes everything queued with a single write and fdatasync, so the moves of many games are made durable
+//! together, then calls back for each record to say it is. POSIX only.
+class Journal
+{
+public:
+
+    //! Called on the journal's thread once the record is on disk, in the order appended.
+    using Callback = std::function<void()>;
+
+    static constexpr std::size_t kRecordSize = 11;
+
+    //! @brief Reads the records of @p filename up to the first incomplete or corrupt one.
+    //! @returns Nothing when the file doesn't exist.
+    //! @throws std::runtime_error When the file exists and can't be read.
+    static std::vector<JournalRecord> Read(const std::string& filename);
+
+    //! @brief Replaces @p filename with a file of @p records, then opens it to append to.
+    //! @throws std::runtime_error When the file can't be written.
+    Journal(const std::string& filename, const std::vector<JournalRecord>& records);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+
+    //! @brief Queues @p record to be written, called from any thread.
+    //! @throws std::runtime_error When an earlier write failed, nothing is durable after it.
+    void Append(const JournalRecord& record, Callback committed);
+
+    //! @brief Waits until everything appended so far is on disk and called back.
+    void Sync();
+
+    //! @returns The number of fdatasync calls made, each for one or more records.
+    u64 GetCommits() const;
+
+private:
+
+    int fd = -1;
+
+    mutable std::mutex      mutex;
+    std::condition_variable wake;       //!< Of the thread, when a record is appended or to stop.
+    std::condition_variable synced;     //!< Of Sync(), when a batch has been called back.
+
+    std::vector<u8>       pending;      //!< Encoded records, guarded by mutex.
+    std::vector<Callback> callbacks;    //!< Of the pending records.
+
+    u64  appended  = 0;
+    u64  completed = 0;
+    u64  commits   = 0;
+    bool failed    = false;
+    bool stopped   = false;
+
+    std::thread thread;
+
+    void Run();
+};
+
+}
@@ -0,0 +1,243 @@
+#include "message.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace Net
+{
+
+namespace
+{
+    void Write16(u8*& output, u16 value)
+    {
+        *output++ = u8(value);
+        *output++ = u8(value >> 8);
+    }
+
+    void Write32(u8*& output, u32 value)
+    {
+        Write16(output, u16(value));
+        Write16(output, u16(value >> 16));
+    }
+
+    u16 Read16(const u8*& data)
+    {
+        const u16 value = u16(data[0] | (data[1] << 8));
+        data += 2;
+
+        return value;
+    }
+
+    u32 Read32(const u8*& data)
+    {
+        const u32 low = Read16(data);
+
+        return low | (u32(Read16(data)) << 16);
+    }
+
+    void Write64(u8*& output, u64 value)
+    {
+        Write32(output, u32(value));
+        Write32(output, u32(value >> 32));
+    }
+
+    u64 Read64(const u8*& data)
+    {
+        const u64 low = Read32(data);
+
+        return low | (u64(Read32(data)) << 32);
+    }
+}
+
+std::size_t GetMessageSize(MessageType type)
+{
+    switch(type)
+    {
+    case MessageType::Create:   return 1;
+    case MessageType::Join:     return 5;
+    case MessageType::Move:     return 7;
+    case MessageType::Leave:    return 5;
+    case MessageType::Joined:   return 6;
+    case MessageType::Moved:    return 10;
+    case MessageType::Rejected: return 8;
+    case MessageType::Left:     return 6;
+    case MessageType::Watch:    return 5;
+    case MessageType::Unwatch:  return 5;
+    case MessageType::Snapshot: return 50;
+    }
+
+    return 0;
+}
+
+std::size_t Encode(const Message& message, u8* output)
+{
+    u8* const start = output;
+
+    *output++ = u8(message.type);
+
+    if(message.type != MessageType::Create)
+    {
+        Write32(output, message.game);
+    }
+
+    switch(message.type)
+    {
+    case MessageType::Move:
+        Write16(output, message.move);
+        break;
+
+    case MessageType::Joined:
+    case MessageType::Left:
+        *output++ = message.team;
+        break;
+
+    case MessageType::Moved:
+        Write16(output, message.move);
+        Write16(output, message.ply);
+        *output++ = u8(message.end);
+        break;
+
+    case MessageType::Rejected:
+        Write16(output, message.move);
+        *output++ = u8(message.reason);
+        break;
+
+    case MessageType::Snapshot:
+        Write16(output, message.ply);
+        *output++ = u8(message.end);
+        *output++ = message.team;
+        *output++ = u8(message.enPassant);
+        Write64(output, message.unmoved);
+        std::memcpy(output, message.squares, sizeof(message.squares));
+        output += sizeof(message.squares);
+        break;
+
+    default:
+        break;
+    }
+
+    return std::size_t(output - start);
+}
+
+std::size_t Decode(const u8* data, std::size_t size, Message& message)
+{
+    if(size == 0)
+    {
+        return 0;
+    }
+
+    const MessageType type  = MessageType(data[0]);
+    const std::size_t bytes = GetMessageSize(type);
+
+    if(bytes == 0)
+    {
+        throw std::runtime_error("Unknown message type: " + std::to_string(data[0]));
+    }
+
+    if(size < bytes)
+    {
+        return 0;
+    }
+
+    message      = Message();
+    message.type = type;
+
+    ++data;
+
+    if(type != MessageType::Create)
+    {
+        message.game = Read32(data);
+    }
+
+    switch(type)
+    {
+    case MessageType::Move:
+        message.move = Read16(data);
+        break;
+
+    case MessageType::Joined:
+    case MessageType::Left:
+        message.team = *data++;
+        break;
+
+    case MessageType::Moved:
+        message.move = Read16(data);
+        message.ply  = Read16(data);
+        message.end  = GameEnd(*data++);
+        break;
+
+    case MessageType::Rejected:
+        message.move   = Read16(data);
+        message.reason = RejectReason(*data++);
+        break;
+
+    case MessageType::Snapshot:
+        message.ply       = Read16(data);
+        message.end       = GameEnd(*data++);
+        message.team      = *data++;
+        message.enPassant = s8(*data++);
+        message.unmoved   = Read64(data);
+        std::memcpy(message.squares, data, sizeof(message.squares));
+        break;
+
+    default:
+        break;
+    }
+
+    return bytes;
+}
+
+Message MakeSnapshot(u32 game, u16 ply, GameEnd end, const Engine::BitboardPosition& position)
+{
+    Message snapshot;
+
+    snapshot.type      = MessageType::Snapshot;
+    snapshot.game      = game;
+    snapshot.ply       = ply;
+    snapshot.end       = end;
+    snapshot.team      = position.turn;
+    snapshot.unmoved   = position.unmoved;
+    snapshot.enPassant = position.enPassant;
+
+    for(int team = 0; team < 2; ++team)
+    {
+        for(int type = 0; type < Engine::kNumTypes; ++type)
+        {
+            for(u64 bits = position.pieces[team][type]; bits; bits &= bits - 1)
+            {
+                const int square = Engine::LowestBit(bits);
+
+                snapshot.squares[square / 2] |= u8((1 + type + 8 * team) << (4 * (square % 2)));
+            }
+        }
+    }
+
+    return snapshot;
+}
+
+Engine::BitboardPosition ReadSnapshot(const Message& snapshot)
+{
+    Engine::BitboardPosition position;
+
+    position.unmoved   = snapshot.unmoved;
+    position.enPassant = snapshot.enPassant;
+    position.turn      = snapshot.team;
+
+    for(int square = 0; square < Engine::kNumSquares; ++square)
+    {
+        const int value = (snapshot.squares[square / 2] >> (4 * (square % 2))) & 15;
+        const int type  = (value & 7) - 1;
+
+        // the snapshot comes from the network, a square that isn't a piece is left empty rather than indexed
+
+        if(type >= 0 && type < Engine::kNumTypes)
+        {
+            position.pieces[value >> 3][type] |= u64(1) << square;
+        }
+    }
+
+    return position;
+}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "../engine/bitboard.hpp"
+#include "../core.hpp"
+
+#include <cstddef>
+
+namespace Net
+{
+
+//! @brief Binary messages between the game server and its clients.
+//!
+//! Every message starts with its type in one byte followed by fixed size fields for that type,
+//! little endian, so a move is 7 bytes to the server and 10 back. Moves are Engine::Move data,
+//! the server only reads the origin and destination and replies with the full move. Spectators are sent
+//! the same Joined, Moved and Left messages as the players, after a Snapshot to start from, and so is a
+//! player joining a game.
+//!
+//! | Type     | Direction | Fields                              | Meaning                                          |
+//! |----------|-----------|-------------------------------------|--------------------------------------------------|
+//! | Create   | To server | -                                   | Create a game and join it as white.              |
+//! | Join     | To server | u32 game                            | Join a game as whichever team has no player.     |
+//! | Move     | To server | u32 game, u16 move                  | Make a move as the team to move.                 |
+//! | Leave    | To server | u32 game                            | Leave a game, which ends it if it was ongoing.   |
+//! | Joined   | To client | u32 game, u8 team                   | A player joined, sent to every player.           |
+//! | Moved    | To client | u32 game, u16 move, u16 ply, u8 end | A move was made, sent to every player.           |
+//! | Rejected | To client | u32 game, u16 move, u8 reason       | A request failed, sent to the requester.         |
+//! | Left     | To client | u32 game, u8 team                   | The other player left or disconnected.           |
+//! | Watch    | To server | u32 game                            | Start spectating a game.                         |
+//! | Unwatch  | To server | u32 game                            | Stop spectating a game.                          |
+//! | Snapshot | To client | u32 game, u16 ply, u8 end, u8 team, | A recent position of a game watched or joined,   |
+//! |          |           | s8 en passant, u64 unmoved,         | moves since it follow. Pieces are a nibble per   |
+//! |          |           | u8 squares[32]                      | square, see Message::squares.                    |
+enum class MessageType : u8
+{
+    Create = 1,
+    Join,
+    Move,
+    Leave,
+    Joined,
+    Moved,
+    Rejected,
+    Left,
+    Watch,
+    Unwatch,
+    Snapshot,
+};
+
+enum class GameEnd : u8
+{
+    None,
+    Checkmate,
+    Stalemate,
+    Abandoned,
+};
+
+enum class RejectReason : u8
+{
+    NoGame,
+    Full,
+    NotPlayer,
+    NotTurn,
+    Illegal,
+    Ended,
+    NotWatching,
+};
+
+struct Message
+{
+    MessageType type = MessageType::Create;
+
+    u32 game = 0;
+    u16 move = 0;
+    u16 ply  = 0;                       //!< Of the game after the move.
+    u8  team = 0;                       //!< Piece::Team, the team to move for a snapshot.
+
+    GameEnd      end    = GameEnd::None;
+    RejectReason reason = RejectReason::NoGame;
+
+    //! Snapshot only, a nibble per square index with the lower index in the low bits,
+    //! zero for an empty square, otherwise 1 + Piece::Type plus 8 for black.
+    u8  squares[Engine::kNumSquares / 2] = {};
+    u64 unmoved   = 0;
+    s8  enPassant = -1;
+};
+
+constexpr std::size_t kMaxMessageSize = 50;
+
+Message MakeSnapshot(u32 game, u16 ply, GameEnd end, const Engine::BitboardPosition& position);
+
+//! @returns The position of @p snapshot, squares that don't hold a valid piece are empty.
+Engine::BitboardPosition ReadSnapshot(const Message& snapshot);
+
+//! @returns Bytes the message of @p type takes, zero for an unknown type.
+std::size_t GetMessageSize(MessageType type);
+
+//! @param [out] output At least kMaxMessageSize bytes.
+//! @returns Bytes written.
+std::size_t Encode(const Message& message, u8* output);
+
+//! @brief Decodes the first message in @p data.
+//! @returns Bytes read, zero if @p data doesn't hold all of the message yet.
+//! @throws std::runtime_error When the message type is unknown.
+std::size_t Decode(const u8* data, std::size_t size, Message& message);
+
+}
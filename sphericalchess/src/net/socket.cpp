@@ -0,0 +1,341 @@
+#include "socket.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace Net
+{
+
+namespace
+{
+    const char kUnixPrefix[] = "unix:";
+
+#ifdef _WIN32
+
+    struct WinsockInit
+    {
+        WinsockInit()
+        {
+            WSADATA data;
+
+            if(WSAStartup(MAKEWORD(2, 2), &data) != 0)
+            {
+                throw std::runtime_error("Failed to initialize Winsock");
+            }
+        }
+
+        ~WinsockInit() { WSACleanup(); }
+    };
+
+    void InitializeSockets()
+    {
+        static WinsockInit init;
+    }
+
+    bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+
+    std::string LastError() { return "error " + std::to_string(WSAGetLastError()); }
+
+    void CloseSocket(Socket::Handle handle) { closesocket(SOCKET(handle)); }
+
+#else
+
+    void InitializeSockets()
+    {
+    }
+
+    bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+
+    std::string LastError() { return std::strerror(errno); }
+
+    void CloseSocket(Socket::Handle handle) { close(handle); }
+
+#endif
+
+    bool IsUnix(const std::string& address)
+    {
+        return address.compare(0, sizeof(kUnixPrefix) - 1, kUnixPrefix) == 0;
+    }
+
+    //! @brief Resolves a "host:port" address, the caller frees the result with freeaddrinfo().
+    addrinfo* Resolve(const std::string& address, bool passive)
+    {
+        const std::size_t colon = address.rfind(':');
+
+        if(colon == std::string::npos)
+        {
+            throw std::runtime_error("Address has no port: " + address);
+        }
+
+        const std::string host = address.substr(0, colon);
+        const std::string port = address.substr(colon + 1);
+
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags    = passive ? AI_PASSIVE : 0;
+
+        addrinfo* result = nullptr;
+
+        if(getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0 || !result)
+        {
+            throw std::runtime_error("Failed to resolve address: " + address);
+        }
+
+        return result;
+    }
+
+#ifndef _WIN32
+
+    sockaddr_un UnixAddress(const std::string& address)
+    {
+        const std::string path = address.substr(sizeof(kUnixPrefix) - 1);
+
+        sockaddr_un result;
+        std::memset(&result, 0, sizeof(result));
+
+        if(path.empty() || path.size() >= sizeof(result.sun_path))
+        {
+            throw std::runtime_error("Invalid UNIX socket path: " + address);
+        }
+
+        result.sun_family = AF_UNIX;
+        std::memcpy(result.sun_path, path.c_str(), path.size());
+
+        return result;
+    }
+
+#endif
+
+    //! @brief Moves are a few bytes each way and latency is all that matters, so never wait to fill a packet.
+    void SetNoDelay(Socket::Handle handle)
+    {
+        int enable = 1;
+        setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+    }
+}
+
+Socket::Socket(Socket&& socket) : handle(socket.Release())
+{
+}
+
+Socket& Socket::operator = (Socket&& socket)
+{
+    if(this != &socket)
+    {
+        Close();
+        handle = socket.Release();
+    }
+
+    return *this;
+}
+
+Socket Socket::Listen(const std::string& address, int backlog)
+{
+    InitializeSockets();
+
+    if(IsUnix(address))
+    {
+#ifdef _WIN32
+        throw std::runtime_error("UNIX sockets are not supported: " + address);
+#else
+        const sockaddr_un unixAddress = UnixAddress(address);
+
+        Socket socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+
+        unlink(unixAddress.sun_path); // left behind by a previous server that didn't exit cleanly
+
+        if(!socket.IsOpen() || bind(socket.handle, reinterpret_cast<const sockaddr*>(&unixAddress), sizeof(unixAddress)) != 0 || listen(socket.handle, backlog) != 0)
+        {
+            throw std::runtime_error("Failed to listen on " + address + ": " + LastError());
+        }
+
+        return socket;
+#endif
+    }
+
+    addrinfo* info = Resolve(address, true);
+
+    Socket socket(::socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+
+    int reuse = 1;
+
+    const bool bound = socket.IsOpen()
+                    && setsockopt(socket.handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse)) == 0
+                    && bind(socket.handle, info->ai_addr, int(info->ai_addrlen)) == 0
+                    && listen(socket.handle, backlog) == 0;
+
+    freeaddrinfo(info);
+
+    if(!bound)
+    {
+        throw std::runtime_error("Failed to listen on " + address + ": " + LastError());
+    }
+
+    return socket;
+}
+
+Socket Socket::Connect(const std::string& address)
+{
+    InitializeSockets();
+
+    if(IsUnix(address))
+    {
+#ifdef _WIN32
+        throw std::runtime_error("UNIX sockets are not supported: " + address);
+#else
+        const sockaddr_un unixAddress = UnixAddress(address);
+
+        Socket socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+
+        if(!socket.IsOpen() || connect(socket.handle, reinterpret_cast<const sockaddr*>(&unixAddress), sizeof(unixAddress)) != 0)
+        {
+            throw std::runtime_error("Failed to connect to " + address + ": " + LastError());
+        }
+
+        return socket;
+#endif
+    }
+
+    addrinfo* info = Resolve(address, false);
+
+    Socket socket;
+
+    for(addrinfo* entry = info; entry && !socket.IsOpen(); entry = entry->ai_next)
+    {
+        socket = Socket(::socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol));
+
+        if(socket.IsOpen() && connect(socket.handle, entry->ai_addr, int(entry->ai_addrlen)) != 0)
+        {
+            socket.Close();
+        }
+    }
+
+    freeaddrinfo(info);
+
+    if(!socket.IsOpen())
+    {
+        throw std::runtime_error("Failed to connect to " + address + ": " + LastError());
+    }
+
+    SetNoDelay(socket.handle);
+
+    return socket;
+}
+
+Socket Socket::Accept()
+{
+    Socket socket(::accept(handle, nullptr, nullptr));
+
+    if(socket.IsOpen())
+    {
+        SetNoDelay(socket.handle); // fails harmlessly for UNIX sockets
+    }
+
+    return socket;
+}
+
+void Socket::Close()
+{
+    if(IsOpen())
+    {
+        CloseSocket(handle);
+        handle = kInvalid;
+    }
+}
+
+void Socket::SetNonBlocking()
+{
+#ifdef _WIN32
+    u_long enable = 1;
+    ioctlsocket(SOCKET(handle), FIONBIO, &enable);
+#else
+    fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+bool Socket::Wait(bool write, int milliseconds)
+{
+#ifdef _WIN32
+    WSAPOLLFD entry = { SOCKET(handle), short(POLLIN | (write ? POLLOUT : 0)), 0 };
+
+    return WSAPoll(&entry, 1, milliseconds) > 0;
+#else
+    pollfd entry = { handle, short(POLLIN | (write ? POLLOUT : 0)), 0 };
+
+    return poll(&entry, 1, milliseconds) > 0;
+#endif
+}
+
+std::size_t Socket::Send(const void* data, std::size_t size)
+{
+#ifdef _WIN32
+    const int sent = send(SOCKET(handle), static_cast<const char*>(data), int(size), 0);
+#else
+    const ssize_t sent = send(handle, data, size, MSG_NOSIGNAL);
+#endif
+
+    if(sent < 0)
+    {
+        if(WouldBlock())
+        {
+            return 0;
+        }
+
+        throw std::runtime_error("Failed to send: " + LastError());
+    }
+
+    return std::size_t(sent);
+}
+
+std::ptrdiff_t Socket::Receive(void* data, std::size_t size)
+{
+#ifdef _WIN32
+    const int received = recv(SOCKET(handle), static_cast<char*>(data), int(size), 0);
+#else
+    const ssize_t received = recv(handle, data, size, 0);
+#endif
+
+    if(received < 0)
+    {
+        if(WouldBlock())
+        {
+            return 0;
+        }
+
+        throw std::runtime_error("Failed to receive: " + LastError());
+    }
+
+    return received == 0 ? -1 : std::ptrdiff_t(received);
+}
+
+Socket::Handle Socket::Release()
+{
+    const Handle result = handle;
+    handle = kInvalid;
+
+    return result;
+}
+
+}
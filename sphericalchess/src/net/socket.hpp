@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../core.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//! Networked play, the game server and the messages between it and its clients.
+namespace Net
+{
+
+//! @brief Stream socket connected over TCP or a UNIX socket.
+//!
+//! Addresses are either "host:port" for TCP, where an empty host listens on every interface,
+//! or "unix:path" for a UNIX socket, which is only supported on Linux.
+class Socket
+{
+public:
+
+#ifdef _WIN32
+    using Handle = std::uintptr_t;
+#else
+    using Handle = int;
+#endif
+
+    Socket() = default;
+    Socket(Socket&& socket);
+    Socket& operator = (Socket&& socket);
+
+    Socket(const Socket&) = delete;
+    Socket& operator = (const Socket&) = delete;
+
+    ~Socket() { Close(); }
+
+    //! @throws std::runtime_error When the address can't be resolved or bound.
+    static Socket Listen(const std::string& address, int backlog = 1024);
+
+    //! @throws std::runtime_error When the address can't be resolved or connected to.
+    static Socket Connect(const std::string& address);
+
+    //! @returns The accepted connection, closed if there is none waiting on a non-blocking socket.
+    Socket Accept();
+
+    void Close();
+
+    //! @brief Makes Send() and Receive() return zero instead of waiting.
+    void SetNonBlocking();
+
+    //! @brief Waits until there is something to receive, or room to send as well if @p write.
+    //! @returns False if it timed out.
+    bool Wait(bool write, int milliseconds);
+
+    //! @returns Bytes sent, zero if the socket is non-blocking and its buffer is full.
+    //! @throws std::runtime_error When the connection has failed.
+    std::size_t Send(const void* data, std::size_t size);
+
+    //! @returns Bytes received, zero if the socket is non-blocking and nothing has arrived,
+    //!          or -1 when the other end has closed the connection.
+    //! @throws std::runtime_error When the connection has failed.
+    std::ptrdiff_t Receive(void* data, std::size_t size);
+
+    Handle GetHandle() const { return handle; }
+    bool   IsOpen()    const { return handle != kInvalid; }
+
+    //! @brief Gives up ownership of the handle, it is no longer closed by this socket.
+    Handle Release();
+
+private:
+
+#ifdef _WIN32
+    static constexpr Handle kInvalid = ~Handle(0);
+#else
+    static constexpr Handle kInvalid = -1;
+#endif
+
+    Handle handle = kInvalid;
+
+    explicit Socket(Handle handle) : handle(handle)
+    {
+    }
+};
+
+}
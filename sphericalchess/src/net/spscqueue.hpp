@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace Net
+{
+
+//! @brief Fixed size queue for one thread pushing and one other thread popping, without locks.
+//!
+//! Neither side ever waits on the other, a full queue fails to push and an empty one fails to pop.
+template<typename T, std::size_t Capacity>
+class SpscQueue
+{
+public:
+
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    //! @returns False if the queue is full.
+    bool Push(const T& item)
+    {
+        const std::size_t back = tail.load(std::memory_order_relaxed);
+
+        if(back - head.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+
+        items[back & (Capacity - 1)] = item;
+        tail.store(back + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    //! @returns False if the queue is empty.
+    bool Pop(T& item)
+    {
+        const std::size_t front = head.load(std::memory_order_relaxed);
+
+        if(front == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        item = items[front & (Capacity - 1)];
+        head.store(front + 1, std::memory_order_release);
+
+        return true;
+    }
+
+private:
+
+    T items[Capacity];
+
+    // on separate cache lines so the two threads don't slow each other down
+
+    alignas(64) std::atomic<std::size_t> head { 0 };   //!< Written by the popping thread.
+    alignas(64) std::atomic<std::size_t> tail { 0 };   //!< Written by the pushing thread.
+};
+
+}
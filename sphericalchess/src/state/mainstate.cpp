@@ -2,6 +2,10 @@
 #include "mainstate.hpp"
 
 #include "../game/resources.hpp"
+#include "../engine/move.hpp"
+#include "../engine/movegen.hpp"
+
+#include <algorithm>
 
 namespace
 {
@@ -216,7 +220,41 @@ bool MainState::ProcessEvent(SDL_Event& ev)
                             return a.destination == pos;
                         });
 
-                        if(it != selectedPiece.actions.end())
+                        if(it != selectedPiece.actions.end() && !IsLocalTurn())
+                        {
+                            AddMessage("Waiting for the other player, game " + std::to_string(clientGame) + ".", 100);
+                        }
+                        else if(it != selectedPiece.actions.end() && client)
+                        {
+                            // only made once the server sends it back, so the board never gets ahead of the game
+
+                            const Engine::Move move = Engine::Move::FromAction(*it);
+
+                            Piece::ActionCollection actions;
+                            Engine::GenerateLegalActions(board, actions);
+
+                            selectedPiece.ClearSelected();
+
+                            Net::Message message;
+
+                            message.type = Net::MessageType::Move;
+                            message.game = clientGame;
+                            message.move = move.GetData();
+
+                            if(!Engine::Move::FindAction(move, actions))
+                            {
+                                AddMessage("Invalid move? check.", 100);
+                            }
+                            else if(client->Send(message))
+                            {
+                                clientMoving = true;
+                            }
+                            else
+                            {
+                                AddMessage("Too many moves waiting to be sent.", 100);
+                            }
+                        }
+                        else if(it != selectedPiece.actions.end())
                         {
                             switch(board.ApplyActionIfValid(*it))
                             {
@@ -224,7 +262,6 @@ bool MainState::ProcessEvent(SDL_Event& ev)
                             case Board::State::Stalemate:
                             {
                                 selectedPiece.ClearSelected();
-                                
 
                                 switch(board.GetCurrentTeamState())
                                 {
@@ -321,6 +358,8 @@ void MainState::Render()
 {
     using namespace std::string_literals;
 
+    ProcessNetwork();
+
     resource.vao.Bind();
 
     int width;
@@ -535,7 +574,28 @@ void MainState::Render()
         resource.font.Draw(window, { -10, 10 }, Font::Align::RightTop, "Black's Turn");
     }
 
-    
+    // the id is what the other player needs to join, so it stays up for the whole game
+
+    if(client && clientJoined)
+    {
+        resource.font.Draw(window, { 0, 10 }, Font::Align::Top, "Game " + std::to_string(clientGame));
+    }
+
+    if(!messages.empty())
+    {
+        std::string text;
+
+        for(auto& message : messages)
+        {
+            text += (text.empty() ? "" : "\n") + message.first;
+            --message.second;
+        }
+
+        resource.font.Draw(window, { 0, -10 }, Font::Align::Bot, text);
+
+        messages.erase(std::remove_if(messages.begin(), messages.end(), [](auto& m) { return m.second <= 0; }), messages.end());
+    }
+
 
     glBindVertexArray(0);
 }
@@ -562,5 +622,135 @@ std::pair<Vec3, Vec3> MainState::CalculateMouseWorldLine(const Vec2i& screenPosi
 
 void MainState::AddMessage(const std::string& message, int time)
 {
+    if(messages.size() >= kMaxMessages)
+    {
+        messages.erase(messages.begin());
+    }
+
+    messages.emplace_back(message, time);
+}
+
+void MainState::Connect(const std::string& address, u32 game)
+{
+    client.reset(new Net::GameClient());
+    client->Start(address, game);
+
+    clientJoined = false;
+    clientMoving = false;
+    clientPly    = 0;
+}
+
+void MainState::ProcessNetwork()
+{
+    if(!client)
+    {
+        return;
+    }
+
+    Net::ClientEvent event;
+
+    while(client->Poll(event))
+    {
+        if(event.type == Net::ClientEvent::Type::Disconnected)
+        {
+            AddMessage("Disconnected: " + client->GetError(), 300);
+            clientJoined = false;
+            clientMoving = false;
+            continue;
+        }
+
+        const Net::Message& message = event.message;
+
+        switch(message.type)
+        {
+        case Net::MessageType::Joined:
+        {
+            if(!clientJoined)
+            {
+                clientJoined = true;
+                clientGame   = message.game;
+                clientTeam   = Piece::Team(message.team);
+
+                const std::string text = "Joined game " + std::to_string(clientGame) + (clientTeam == Piece::Team::White ? " as white." : " as black.");
+
+                AddMessage(text, 300);
+            }
+            else
+            {
+                AddMessage("The other player has joined.", 100);
+            }
+            break;
+        }
+        case Net::MessageType::Snapshot:
+        {
+            // a game joined after it started, or rebuilt by a restarted server, the moves since follow
+
+            Net::ReadSnapshot(message).ToBoard(board);
+            selectedPiece.ClearSelected();
+
+            clientPly = message.ply;
+            break;
+        }
+        case Net::MessageType::Moved:
+        {
+            if(message.ply <= clientPly)
+            {
+                break; // already in the snapshot the board started from
+            }
+
+            Piece::ActionCollection actions;
+            Engine::GenerateLegalActions(board, actions);
+
+            const Piece::Action* action = Engine::Move::FindAction(Engine::Move(message.move), actions);
+
+            if(message.ply != clientPly + 1 || !action)
+            {
+                AddMessage("Out of sync with the game server.", 300);
+                break;
+            }
+
+            const bool own = board.GetCurrentTeamTurn() == clientTeam;
+
+            board.ApplyActionIfValid(*action);
+            selectedPiece.ClearSelected();
 
-}
\ No newline at end of file
+            clientPly = message.ply;
+
+            if(own)
+            {
+                clientMoving = false;
+            }
+
+            if(message.end == Net::GameEnd::Checkmate)
+            {
+                AddMessage(own ? "You win, congratulations!" : "Checkmate, you lose.", 300);
+            }
+            else if(!own && board.GetCurrentTeamState() == Board::State::Check)
+            {
+                AddMessage("You are in check!", 100);
+            }
+            break;
+        }
+        case Net::MessageType::Rejected:
+        {
+            AddMessage("The game server rejected the request.", 100);
+            clientMoving = false;
+            break;
+        }
+        case Net::MessageType::Left:
+        {
+            AddMessage("The other player has left.", 300);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+        }
+    }
+}
+
+bool MainState::IsLocalTurn() const
+{
+    return !client || (clientJoined && !clientMoving && board.GetCurrentTeamTurn() == clientTeam);
+}
@@ -4,8 +4,12 @@
 #include "state.hpp"
 
 #include "../game/board.hpp"
+#include "../net/gameclient.hpp"
 #include "../core.hpp"
 
+#include <memory>
+#include <string>
+
 struct Resources;
 
 class MainState : public State
@@ -19,6 +23,10 @@ public:
     bool ProcessEvent(SDL_Event& ev) override;
     void Render() override;
 
+    //! @brief Plays against another player through a game server instead of both players at this machine.
+    //! @param [in] game Id of the game to join, or zero to create one and play as white.
+    void Connect(const std::string& address, u32 game);
+
 
 // private: // todo re-add private
 
@@ -114,11 +122,28 @@ public:
 
     Piece::Team teamTurn = Piece::Team::White;
 
-    std::vector<std::pair<std::string, int>> messages;
+    static constexpr std::size_t kMaxMessages = 5;
+
+    std::vector<std::pair<std::string, int>> messages;  //!< Shown at the bottom of the window, with the frames left.
+
+    std::unique_ptr<Net::GameClient> client;    //!< Null for a game between players at this machine.
+
+    u32         clientGame   = 0;
+    Piece::Team clientTeam   = Piece::Team::White;
+    bool        clientJoined = false;
+    bool        clientMoving = false;   //!< Sent a move the server hasn't sent back or rejected yet.
+    u16         clientPly    = 0;       //!< Of the game at the server, the board may have started from a snapshot.
 
 
     std::pair<Vec3, Vec3> CalculateMouseWorldLine(const Vec2i& screenPosition) const;
         
+    //! @brief Shows @p message for @p time frames, below any still shown, dropping the oldest past kMaxMessages.
     void AddMessage(const std::string& message, int time);
 
+    //! @brief Applies what has arrived from the game server, once per frame.
+    void ProcessNetwork();
+
+    //! @brief Whether the player at this machine can move, always true without a game server.
+    bool IsLocalTurn() const;
+
 };
\ No newline at end of file
@@ -0,0 +1,153 @@
+//! @file
+//! Annotates the games of an Engine::GameRecordWriter file with Engine::GameAnnotator and shows the annotations.
+//!
+//!     annotate run <games.scgr> <annotations.scga> [nodes=20000] [threads] [megabytes=256]    search every position of the games
+//!     annotate show <games.scgr> <annotations.scga> [game=0]                                   write a game with its annotations
+//!
+//! Games are numbered from zero in the order of the games file.
+
+#include "../engine/gameannotator.hpp"
+#include "../engine/gamerecord.hpp"
+#include "../engine/notation.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+    constexpr u64 kProgressGames = 100;   //!< Games between progress lines.
+
+    void Run(const char* gamesFilename, const char* filename, u64 nodes, int threads, int megabytes)
+    {
+        Engine::AnnotationSettings settings;
+
+        settings.nodes          = nodes;
+        settings.threads        = threads;
+        settings.tableMegabytes = megabytes;
+
+        settings.progress = [](const Engine::AnnotationStats& stats)
+        {
+            if(stats.games % kProgressGames == 0)
+            {
+                std::cout << stats.games << " games, " << std::fixed << std::setprecision(0) << stats.GetGamesPerHour() << " games/h" << std::endl;
+            }
+        };
+
+        const Engine::AnnotationStats stats = Engine::GameAnnotator::Annotate(gamesFilename, filename, settings);
+
+        const double seconds = double(std::max<u64>(stats.milliseconds, 1)) / 1000.0;
+
+        std::cout << stats.games << " games, " << stats.positions << " positions, " << stats.nodes << " nodes in " << stats.milliseconds << " ms\n"
+                  << stats.inaccuracies << " inaccuracies, " << stats.mistakes << " mistakes, " << stats.blunders << " blunders\n"
+                  << std::fixed << std::setprecision(0) << stats.GetGamesPerHour() << " games/h, "
+                  << double(stats.positions) / seconds << " positions/s, " << double(stats.nodes) / seconds << " nodes/s" << std::endl;
+    }
+
+    void Show(const char* gamesFilename, const char* filename, u64 number)
+    {
+        Engine::GameRecordReader reader(gamesFilename);
+        Engine::AnnotationReader annotations(filename);
+
+        if(annotations.GetGamesSize() != reader.GetSize())
+        {
+            throw std::runtime_error(std::string(filename) + " is not annotations of " + gamesFilename + ", rerun it");
+        }
+
+        Engine::AnnotatedGame annotated;
+
+        for(u64 i = 0; i <= number; ++i)
+        {
+            if(!annotations.Next(annotated))
+            {
+                throw std::runtime_error("There are only " + std::to_string(i) + " annotated games");
+            }
+        }
+
+        Engine::GameRecordView   game;
+        Engine::GameRecordReplay replay;
+
+        reader.Seek(std::size_t(annotated.offset));
+
+        if(!reader.Next(game) || game.numPlies != annotated.numPlies)
+        {
+            throw std::runtime_error("Annotations don't match the games");
+        }
+
+        std::cout << "game " << number << ", " << annotated.numPlies << " plies, " << annotations.GetNodes() << " nodes a position, "
+                  << annotated.inaccuracies << " inaccuracies, " << annotated.mistakes << " mistakes, " << annotated.blunders << " blunders\n\n";
+
+        // one line per move, the score is of the position before it for the team to move
+
+        u64 masks[Engine::kNumSquares];
+
+        replay.Start(game);
+
+        Engine::BitboardPosition position = replay.GetPosition();
+
+        for(int ply = 0; ply < annotated.numPlies; ++ply)
+        {
+            const Engine::AnnotationPly& annotation = annotated.plies[ply];
+
+            Engine::Move move;
+            replay.Next(move);
+
+            position.GenerateLegal(masks);
+
+            char played[Engine::kMaxMoveTextSize];
+            Engine::FormatMove(position, masks, move, played);
+
+            std::cout << std::right << std::setw(4) << ply / 2 + 1 << (ply % 2 == 0 ? ".    " : "... ")
+                      << std::left << std::setw(7) << (played + std::string(Engine::VariationTree::GlyphToString(Engine::VariationTree::Glyph(annotation.glyph))))
+                      << std::right << std::setw(7) << annotation.score;
+
+            if(annotation.glyph != Engine::VariationTree::Glyph_none && annotation.best != 0)
+            {
+                char best[Engine::kMaxMoveTextSize];
+                Engine::FormatMove(position, masks, annotation.GetBest(), best);
+
+                std::cout << "  -" << annotation.loss << ", best " << best;
+            }
+
+            std::cout << '\n';
+
+            position = replay.GetPosition();
+        }
+
+        std::cout << "\nfinal score " << annotated.plies[annotated.numPlies].score << ", " << Engine::ResultToString(game.result) << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    const std::string command = argc > 3 ? argv[1] : "";
+
+    if(command == "run")
+    {
+        const u64 nodes     = argc > 4 ? std::stoull(argv[4]) : 20000;
+        const int threads   = argc > 5 ? std::stoi(argv[5]) : std::max(int(std::thread::hardware_concurrency()), 1);
+        const int megabytes = argc > 6 ? std::stoi(argv[6]) : 256;
+
+        Run(argv[2], argv[3], nodes, threads, megabytes);
+    }
+    else if(command == "show")
+    {
+        Show(argv[2], argv[3], argc > 4 ? std::stoull(argv[4]) : 0);
+    }
+    else
+    {
+        std::cerr << "usage: annotate run <games.scgr> <annotations.scga> [nodes=20000] [threads] [megabytes=256]\n"
+                     "       annotate show <games.scgr> <annotations.scga> [game=0]" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
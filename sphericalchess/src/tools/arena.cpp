@@ -0,0 +1,171 @@
+//! @file
+//! Plays an Engine::Tournament between two engine settings and reports the Elo difference.
+//!
+//! Settings are given as key=value, player settings apply to both players unless prefixed
+//! with "a." or "b." for only the first or second player.
+//!
+//!     arena <games.scgr> [key=value ...]
+//!
+//! | Key          | Meaning                                                                   |
+//! |--------------|---------------------------------------------------------------------------|
+//! | openings     | Text file, one opening per line in Engine::Move coordinate notation.       |
+//! | games        | Number of games.                                                          |
+//! | concurrency  | Games played at once, all hardware threads by default.                    |
+//! | maxplies     | Games longer than this are drawn.                                         |
+//! | elo0, elo1   | Enables the SPRT with these hypotheses.                                   |
+//! | alpha, beta  | Error rates of the SPRT.                                                  |
+//! | depth, nodes, ms, threads, hash | Player SearchLimits and table size in megabytes.       |
+//! | nullmove, lmr, rfp, futility, checkext | Player SearchSelectivity, 0 turns one off.      |
+
+#include "../engine/tournament.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::vector<std::vector<Engine::Move>> ReadOpenings(const std::string& filename)
+    {
+        std::ifstream input(filename);
+
+        if(!input) throw std::runtime_error("Failed to open file: " + filename);
+
+        std::vector<std::vector<Engine::Move>> openings;
+        std::string line;
+
+        while(std::getline(input, line))
+        {
+            std::istringstream stream(line);
+            std::string token;
+            std::vector<Engine::Move> moves;
+
+            while(stream >> token)
+            {
+                Engine::Move move;
+
+                if(Engine::Move::Parse(token, move))
+                {
+                    moves.push_back(move);
+                }
+            }
+
+            if(!moves.empty())
+            {
+                openings.push_back(std::move(moves));
+            }
+        }
+
+        return openings;
+    }
+
+    void SetPlayer(Engine::TournamentPlayer& player, const std::string& key, const std::string& value)
+    {
+        if     (key == "depth")    player.limits.depth                          = std::stoi(value);
+        else if(key == "nodes")    player.limits.nodes                          = std::stoull(value);
+        else if(key == "ms")       player.limits.milliseconds                   = std::stoi(value);
+        else if(key == "threads")  player.limits.threads                        = std::stoi(value);
+        else if(key == "hash")     player.tableMegabytes                        = std::stoi(value);
+        else if(key == "nullmove") player.limits.selectivity.nullMove           = value != "0";
+        else if(key == "lmr")      player.limits.selectivity.lateMoveReductions = value != "0";
+        else if(key == "rfp")      player.limits.selectivity.reverseFutility    = value != "0";
+        else if(key == "futility") player.limits.selectivity.futility           = value != "0";
+        else if(key == "checkext") player.limits.selectivity.checkExtensions    = value != "0";
+        else throw std::runtime_error("Unknown setting: " + key);
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    if(argc < 2)
+    {
+        std::cerr << "usage: arena <games.scgr> [key=value ...]" << std::endl;
+        return 1;
+    }
+
+    Engine::TournamentSettings settings;
+    std::vector<std::vector<Engine::Move>> openings;
+
+    settings.players[0].name = "a";
+    settings.players[1].name = "b";
+    settings.concurrency     = std::max(int(std::thread::hardware_concurrency()), 1);
+
+    for(auto& player : settings.players)
+    {
+        player.limits.nodes = 20000;
+    }
+
+    for(int i = 2; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const std::size_t equals   = argument.find('=');
+
+        if(equals == std::string::npos) throw std::runtime_error("Expected key=value: " + argument);
+
+        const std::string key   = argument.substr(0, equals);
+        const std::string value = argument.substr(equals + 1);
+
+        if     (key == "openings")    openings             = ReadOpenings(value);
+        else if(key == "games")       settings.games       = std::stoi(value);
+        else if(key == "concurrency") settings.concurrency = std::stoi(value);
+        else if(key == "maxplies")    settings.maxPlies    = std::stoi(value);
+        else if(key == "elo0")        settings.elo0        = std::stod(value), settings.sprt = true;
+        else if(key == "elo1")        settings.elo1        = std::stod(value), settings.sprt = true;
+        else if(key == "alpha")       settings.alpha       = std::stod(value);
+        else if(key == "beta")        settings.beta        = std::stod(value);
+        else if(key.compare(0, 2, "a.") == 0) SetPlayer(settings.players[0], key.substr(2), value);
+        else if(key.compare(0, 2, "b.") == 0) SetPlayer(settings.players[1], key.substr(2), value);
+        else
+        {
+            SetPlayer(settings.players[0], key, value);
+            SetPlayer(settings.players[1], key, value);
+        }
+    }
+
+    auto Print = [&settings](const Engine::TournamentStats& stats)
+    {
+        std::cout << std::fixed << std::setprecision(1)
+                  << "games " << stats.GetGames() << ": +" << stats.wins << " =" << stats.draws << " -" << stats.losses
+                  << " score " << stats.GetScore() * 100.0 << "%"
+                  << " elo " << stats.GetElo() << " +- " << stats.GetEloError();
+
+        if(settings.sprt)
+        {
+            std::cout << std::setprecision(2) << " llr " << stats.llr;
+        }
+
+        std::cout << std::setprecision(0) << " " << stats.GetGamesPerHour() << " games/hour" << std::endl;
+    };
+
+    Engine::Tournament tournament(settings, openings);
+
+    const int interval = std::max(settings.concurrency, 10);
+
+    auto stats = tournament.Run(argv[1], [&](const Engine::TournamentStats& stats)
+    {
+        if(stats.GetGames() % interval == 0)
+        {
+            Print(stats);
+        }
+    });
+
+    Print(stats);
+
+    switch(stats.decision)
+    {
+    case Engine::TournamentStats::Decision::H0: std::cout << "H0 accepted" << std::endl; break;
+    case Engine::TournamentStats::Decision::H1: std::cout << "H1 accepted" << std::endl; break;
+    default: break;
+    }
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
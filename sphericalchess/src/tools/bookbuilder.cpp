@@ -0,0 +1,85 @@
+//! @file
+//! Builds an Engine::OpeningBook from a text file of games.
+//!
+//! Each line of the input is one game, moves in Engine::Move coordinate notation separated by
+//! spaces and followed by the result: "1-0", "0-1" or "1/2-1/2". Games without a result are skipped.
+//!
+//!     bookbuilder <games.txt> <book.bin> [max ply]
+
+#include "../engine/openingbook.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) try
+{
+    if(argc < 3)
+    {
+        std::cerr << "usage: bookbuilder <games.txt> <book.bin> [max ply]" << std::endl;
+        return 1;
+    }
+
+    const int maxPly = argc > 3 ? std::stoi(argv[3]) : 24;
+
+    std::ifstream input(argv[1]);
+
+    if(!input) throw std::runtime_error("Failed to open file: " + std::string(argv[1]));
+
+    Engine::OpeningBookBuilder builder;
+
+    std::string line;
+    std::vector<Engine::Move> moves;
+
+    int games   = 0;
+    int skipped = 0;
+
+    for(int lineNumber = 1; std::getline(input, line); ++lineNumber)
+    {
+        std::istringstream stream(line);
+        std::string token;
+
+        Board::Result result = Board::Result::Undecided;
+        bool valid = true;
+
+        moves.clear();
+
+        while(stream >> token)
+        {
+            Engine::Move move;
+
+            if     (token == "1-0")     result = Board::Result::WhiteWins;
+            else if(token == "0-1")     result = Board::Result::BlackWins;
+            else if(token == "1/2-1/2") result = Board::Result::Draw;
+            else if(Engine::Move::Parse(token, move)) moves.push_back(move);
+            else valid = false;
+        }
+
+        if(moves.empty() || result == Board::Result::Undecided || !valid)
+        {
+            ++skipped;
+            continue;
+        }
+
+        if(!builder.AddGame(moves, result, maxPly))
+        {
+            std::cerr << "line " << lineNumber << ": illegal move, game truncated" << std::endl;
+        }
+
+        ++games;
+    }
+
+    builder.Write(argv[2]);
+
+    std::cout << games << " games, " << skipped << " skipped, " << builder.GetNumEntries() << " entries" << std::endl;
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+
+    return 1;
+}
@@ -0,0 +1,234 @@
+//! @file
+//! Measures the cost of calling the engine through the C interface of the sphericalcapi shared library, against
+//! calling the engine directly, for legal moves and hashes of the positions of a game record file. Each is timed
+//! with one call per position and with batches of positions, and the results are checked to match.
+//!
+//!     capibench <games.scgr> [positions=200000] [passes=5] [batch=256]
+
+#include "../capi/sphericalcapi.h"
+
+#include "../engine/gamerecord.hpp"
+#include "../engine/zobrist.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    //! @brief Calls @p function @p passes times.
+    //! @returns Seconds of the fastest pass, as the differences measured are small next to other programs' noise.
+    template<typename Function>
+    double Time(int passes, Function function)
+    {
+        double fastest = 0.0;
+
+        for(int pass = 0; pass < passes; ++pass)
+        {
+            const Clock::time_point start = Clock::now();
+
+            function();
+
+            const double time = std::chrono::duration<double>(Clock::now() - start).count();
+
+            fastest = pass == 0 ? time : std::min(fastest, time);
+        }
+
+        return fastest;
+    }
+
+    //! @brief Hash of the first @p count of @p moves, in order.
+    u64 Checksum(const u16* moves, u32 count)
+    {
+        u64 sum = count;
+
+        for(u32 i = 0; i < count; ++i)
+        {
+            sum = (sum ^ moves[i]) * 0x100000001B3ull;
+        }
+
+        return sum;
+    }
+
+    void Report(const char* name, double direct, double single, double batch, std::size_t count)
+    {
+        const double scale = 1e9 / double(count);
+
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << direct * scale << std::setw(10) << single * scale << std::setw(10) << batch * scale
+                  << std::setw(12) << (single - direct) * scale << std::setw(12) << (batch - direct) * scale << '\n';
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    if(argc < 2)
+    {
+        std::cerr << "usage: capibench <games.scgr> [positions=200000] [passes=5] [batch=256]" << std::endl;
+        return 1;
+    }
+
+    const std::size_t limit  = argc > 2 ? std::stoul(argv[2]) : 200000;
+    const int         passes = argc > 3 ? std::stoi(argv[3]) : 5;
+    const std::size_t batch  = argc > 4 ? std::max<std::size_t>(std::stoul(argv[4]), 1) : 256;
+
+    if(sc_version() != SC_VERSION)
+    {
+        throw std::runtime_error("Library version " + std::to_string(sc_version()) + " doesn't match the header's " + std::to_string(SC_VERSION));
+    }
+
+    // every position of the games, kept as the library's positions so both sides read the same memory
+
+    std::vector<sc_position> positions;
+
+    Engine::GameRecordReader reader(argv[1]);
+    Engine::GameRecordReplay replay;
+    Engine::GameRecordView   game;
+
+    while(positions.size() < limit && reader.Next(game))
+    {
+        replay.Start(game);
+
+        for(Engine::Move move; positions.size() < limit && replay.Next(move);)
+        {
+            const Engine::BitboardPosition& position = replay.GetPosition();
+
+            sc_position copy = {};
+
+            std::copy(&position.pieces[0][0], &position.pieces[0][0] + 2 * Engine::kNumTypes, &copy.pieces[0][0]);
+            copy.unmoved    = position.unmoved;
+            copy.en_passant = position.enPassant;
+            copy.turn       = position.turn;
+
+            positions.push_back(copy);
+        }
+    }
+
+    const std::size_t count = positions.size();
+
+    if(count == 0)
+    {
+        throw std::runtime_error("No moves in " + std::string(argv[1]));
+    }
+
+    const auto Get = [&](std::size_t i) -> const Engine::BitboardPosition&
+    {
+        return *reinterpret_cast<const Engine::BitboardPosition*>(&positions[i]);
+    };
+
+    // legal moves, written to buffers reused from position to position and checked by a checksum of each list
+
+    std::vector<u16> moves(batch * SC_MAX_MOVES);
+    std::vector<u32> counts(batch);
+    std::vector<u64> directSums(count);
+    std::vector<u64> singleSums(count);
+    std::vector<u64> batchSums(count);
+
+    const double directLegal = Time(passes, [&]
+    {
+        u64 masks[Engine::kNumSquares];
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const Engine::BitboardPosition& position = Get(i);
+
+            u32 moved = 0;
+
+            position.GenerateLegal(masks);
+
+            for(int origin = 0; origin < Engine::kNumSquares; ++origin)
+            {
+                for(u64 bits = masks[origin]; bits != 0; bits &= bits - 1)
+                {
+                    moves[moved++] = position.ToMove(origin, Engine::LowestBit(bits)).GetData();
+                }
+            }
+
+            directSums[i] = Checksum(moves.data(), moved);
+        }
+    });
+
+    const double singleLegal = Time(passes, [&]
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const int moved = sc_legal_moves(&positions[i], moves.data(), SC_MAX_MOVES);
+
+            singleSums[i] = Checksum(moves.data(), u32(std::max(moved, 0)));
+        }
+    });
+
+    const double batchLegal = Time(passes, [&]
+    {
+        for(std::size_t i = 0; i < count; i += batch)
+        {
+            const std::size_t size = std::min(batch, count - i);
+
+            sc_legal_moves_batch(&positions[i], size, moves.data(), SC_MAX_MOVES, counts.data());
+
+            for(std::size_t j = 0; j < size; ++j)
+            {
+                batchSums[i + j] = Checksum(&moves[j * SC_MAX_MOVES], counts[j]);
+            }
+        }
+    });
+
+    // hashes
+
+    std::vector<u64> directHashes(count);
+    std::vector<u64> singleHashes(count);
+    std::vector<u64> batchHashes(count);
+
+    const double directHash = Time(passes, [&]
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            directHashes[i] = Engine::Zobrist::Hash(Get(i));
+        }
+    });
+
+    const double singleHash = Time(passes, [&]
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            sc_hash_batch(&positions[i], 1, &singleHashes[i]);
+        }
+    });
+
+    const double batchHash = Time(passes, [&]
+    {
+        for(std::size_t i = 0; i < count; i += batch)
+        {
+            sc_hash_batch(&positions[i], std::min(batch, count - i), &batchHashes[i]);
+        }
+    });
+
+    std::size_t mismatched = 0;
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        mismatched += directSums[i] != singleSums[i] || directSums[i] != batchSums[i]
+                   || directHashes[i] != singleHashes[i] || directHashes[i] != batchHashes[i];
+    }
+
+    std::cout << "positions   " << count << ", batches of " << batch << "\n\n"
+              << "ns/position     direct    single     batch single-over  batch-over\n";
+
+    Report("legal moves", directLegal, singleLegal, batchLegal, count);
+    Report("hash",        directHash,  singleHash,  batchHash,  count);
+
+    std::cout << "\nmismatched " << mismatched << std::endl;
+
+    return mismatched == 0 ? 0 : 1;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,58 @@
+//! @file
+//! Generates Engine::TrainingPosition records from self-play with Engine::DataGenerator, appending to the file.
+//!
+//!     datagen <positions.bin> [positions] [depth] [threads] [seed]
+
+#include "../engine/datagenerator.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char* argv[]) try
+{
+    if(argc < 2)
+    {
+        std::cerr << "usage: datagen <positions.bin> [positions] [depth] [threads] [seed]" << std::endl;
+        return 1;
+    }
+
+    Engine::DataGeneratorSettings settings;
+
+    settings.positions    = argc > 2 ? std::stoull(argv[2]) : 1000000;
+    settings.limits.depth = argc > 3 ? std::stoi(argv[3]) : 4;
+    settings.threads      = argc > 4 ? std::stoi(argv[4]) : std::max(int(std::thread::hardware_concurrency()), 1);
+    settings.seed         = argc > 5 ? u32(std::stoul(argv[5])) : 1;
+
+    auto Print = [&settings](const Engine::DataGeneratorStats& stats)
+    {
+        const double perSecond = stats.GetPositionsPerSecond();
+
+        std::cout << std::fixed << std::setprecision(0)
+                  << stats.positions << " positions, " << stats.games << " games, "
+                  << perSecond << " positions/s, " << perSecond / settings.threads << " positions/s/core" << std::endl;
+    };
+
+    Engine::DataGenerator generator(settings);
+
+    u64 reported = 0;
+
+    const auto stats = generator.Run(argv[1], [&](const Engine::DataGeneratorStats& stats)
+    {
+        if(stats.milliseconds >= reported + 10000)
+        {
+            reported = stats.milliseconds;
+            Print(stats);
+        }
+    });
+
+    Print(stats);
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
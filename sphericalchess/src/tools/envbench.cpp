@@ -0,0 +1,83 @@
+//! @file
+//! Measures Engine::BatchEnvironment steps per second, playing random legal moves on every board
+//! and resetting boards as their games end.
+//!
+//!     envbench [boards] [steps] [threads]
+
+#include "../engine/batchenvironment.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) try
+{
+    const int boards  = argc > 1 ? std::stoi(argv[1]) : 4096;
+    const int steps   = argc > 2 ? std::stoi(argv[2]) : 100;
+    const int threads = argc > 3 ? std::stoi(argv[3]) : std::max(int(std::thread::hardware_concurrency()), 1);
+
+    Engine::BatchEnvironment environment(boards, threads);
+
+    std::vector<u64>           masks(std::size_t(boards) * Engine::kNumSquares);
+    std::vector<u16>           counts(boards);
+    std::vector<Board::Result> results(boards);
+    std::vector<u16>           actions(boards);
+
+    std::mt19937 random(1);
+
+    u64 games = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for(int step = 0; step < steps; ++step)
+    {
+        environment.GenerateMasks(masks.data(), counts.data(), results.data());
+
+        for(int i = 0; i < boards; ++i)
+        {
+            if(results[i] != Board::Result::Undecided)
+            {
+                environment.Reset(i);
+                actions[i] = Engine::BatchEnvironment::kNoAction;
+                ++games;
+                continue;
+            }
+
+            // pick the nth legal move
+
+            int n = int(random() % counts[i]);
+
+            for(int origin = 0; origin < Engine::kNumSquares; ++origin)
+            {
+                for(u64 bits = masks[std::size_t(i) * Engine::kNumSquares + origin]; bits; bits &= bits - 1)
+                {
+                    if(n-- == 0)
+                    {
+                        int destination = 0;
+
+                        while(!(bits & (u64(1) << destination))) ++destination;
+
+                        actions[i] = Engine::BatchEnvironment::MakeAction(origin, destination);
+                    }
+                }
+            }
+        }
+
+        environment.Step(actions.data());
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << boards << " boards, " << steps << " steps, " << threads << " threads, " << games << " games finished: "
+              << u64(double(boards) * steps / seconds) << " steps/s" << std::endl;
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,202 @@
+//! @file
+//! Builds and browses an Engine::OpeningExplorer of the games in an Engine::GameRecordWriter file.
+//!
+//!     explorer build <games.scgr> <explorer.scox> [plies=40] [threads] [megabytes]    count the moves of the games
+//!     explorer show <explorer.scox> [position] [moves...]                             list the moves played in a position
+//!     explorer bench <explorer.scox> <games.scgr> [queries=100000]                    time lookups of positions from the games
+//!
+//! Positions are given as Engine::FormatPosition() writes them, in quotes as a single argument, or "startpos".
+//! Moves after the position are played before listing, in algebraic or coordinate notation.
+
+#include "../engine/gamerecord.hpp"
+#include "../engine/notation.hpp"
+#include "../engine/openingexplorer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t kMaxMoves = 256;
+
+    void Build(const char* gamesFilename, const char* filename, int plies, int threads, int megabytes)
+    {
+        Engine::OpeningExplorerSettings settings;
+
+        settings.maxPlies        = plies;
+        settings.threads         = threads;
+        settings.memoryMegabytes = megabytes;
+
+        const Engine::OpeningExplorerStats stats = Engine::OpeningExplorer::Build(gamesFilename, filename, settings);
+
+        std::cout << stats.games << " games, " << stats.moves << " moves, " << stats.entries << " entries from " << stats.runs << " runs in "
+                  << stats.milliseconds << " ms, " << std::fixed << std::setprecision(0) << stats.GetGamesPerSecond() << " games/s" << std::endl;
+    }
+
+    void Show(const char* filename, int argc, char* argv[])
+    {
+        Engine::OpeningExplorer explorer;
+        explorer.Open(filename);
+
+        Engine::BitboardPosition position;
+        position.SetStart();
+
+        const std::string text = argc > 0 ? argv[0] : "startpos";
+
+        if(text != "startpos" && !Engine::ParsePosition(text, position))
+        {
+            throw std::runtime_error("Invalid position: " + text);
+        }
+
+        u64 masks[Engine::kNumSquares];
+
+        for(int i = 1; i < argc; ++i)
+        {
+            position.GenerateLegal(masks);
+
+            Engine::Move move;
+
+            if(!Engine::ParseMove(position, masks, argv[i], std::strlen(argv[i]), move))
+            {
+                throw std::runtime_error("Illegal move: " + std::string(argv[i]));
+            }
+
+            position.Apply(move.GetData() & 63, (move.GetData() >> 6) & 63);
+        }
+
+        position.GenerateLegal(masks);
+
+        Engine::ExplorerMove moves[kMaxMoves];
+
+        const Clock::time_point start = Clock::now();
+        const std::size_t       count = std::min(explorer.Lookup(position, moves, kMaxMoves), kMaxMoves);
+        const double            time  = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        std::cout << Engine::FormatPosition(position) << "\n"
+                  << count << " moves in " << std::fixed << std::setprecision(1) << time << " us\n\n";
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            char notation[Engine::kMaxMoveTextSize];
+            Engine::FormatMove(position, masks, moves[i].move, notation);
+
+            const double games = moves[i].GetGames();
+
+            std::cout << std::left << std::setw(8) << notation << std::right << std::setw(10) << moves[i].GetGames()
+                      << std::setw(8) << 100.0 * moves[i].wins / games << "% +"
+                      << std::setw(6) << 100.0 * moves[i].draws / games << "% ="
+                      << std::setw(6) << 100.0 * moves[i].losses / games << "% -\n";
+        }
+    }
+
+    void Bench(const char* filename, const char* gamesFilename, int queries)
+    {
+        Engine::OpeningExplorer explorer;
+        explorer.Open(filename);
+
+        Engine::GameRecordReader reader(gamesFilename);
+        Engine::GameRecordReplay replay;
+        Engine::GameRecordView   game;
+
+        // positions from the plies the explorer counted, so most are found
+
+        std::vector<Engine::BitboardPosition> positions;
+        std::mt19937_64                       random(1);
+
+        while(int(positions.size()) < queries)
+        {
+            if(!reader.Next(game))
+            {
+                reader.Rewind();
+
+                if(!reader.Next(game))
+                {
+                    throw std::runtime_error("No games in " + std::string(gamesFilename));
+                }
+            }
+
+            const int plies = int(random() % u64(std::max(std::min<int>(explorer.GetMaxPlies(), game.numPlies), 1)));
+
+            replay.Start(game);
+
+            Engine::Move move;
+
+            for(int ply = 0; ply < plies && replay.Next(move); ++ply)
+            {
+            }
+
+            positions.push_back(replay.GetPosition());
+        }
+
+        Engine::ExplorerMove moves[kMaxMoves];
+
+        u64 found = 0;
+        u64 games = 0;
+
+        const Clock::time_point start = Clock::now();
+
+        for(auto& position : positions)
+        {
+            const std::size_t count = std::min(explorer.Lookup(position, moves, kMaxMoves), kMaxMoves);
+
+            found += count > 0;
+
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                games += moves[i].GetGames();
+            }
+        }
+
+        const double time = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        std::cout << explorer.GetNumEntries() << " entries of " << explorer.GetNumGames() << " games, " << positions.size() << " lookups, "
+                  << found << " found, " << games << " games\n" << std::fixed << std::setprecision(3)
+                  << time / double(positions.size()) << " us per lookup" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    const std::string command = argc > 2 ? argv[1] : "";
+
+    if(command == "build" && argc > 3)
+    {
+        const int plies     = argc > 4 ? std::stoi(argv[4]) : 40;
+        const int threads   = argc > 5 ? std::stoi(argv[5]) : std::max(int(std::thread::hardware_concurrency()), 1);
+        const int megabytes = argc > 6 ? std::stoi(argv[6]) : 1024;
+
+        Build(argv[2], argv[3], plies, threads, megabytes);
+    }
+    else if(command == "show")
+    {
+        Show(argv[2], argc - 3, argv + 3);
+    }
+    else if(command == "bench" && argc > 3)
+    {
+        Bench(argv[2], argv[3], argc > 4 ? std::stoi(argv[4]) : 100000);
+    }
+    else
+    {
+        std::cerr << "usage: explorer build <games.scgr> <explorer.scox> [plies=40] [threads] [megabytes]\n"
+                     "       explorer show <explorer.scox> [position] [moves...]\n"
+                     "       explorer bench <explorer.scox> <games.scgr> [queries=100000]" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,371 @@
+//! @file
+//! Measures how fast a Net::GameServer sends the moves of one game to its spectators. Two players make
+//! the moves of a random legal game one at a time, each waiting for its own move to come back, while a
+//! thread reads every spectator and checks the moves arrive complete and in order. Prints the messages
+//! delivered per second and the time from making a move to the last spectator having it. Linux only.
+//!
+//!     fanoutbench [spectators] [moves] [address]
+//!
+//! Without an address the server is started in this process on a UNIX socket, which needs an open file
+//! for both ends of every spectator, so large counts may need the address of a separate gameserver.
+
+#include "../engine/bitboard.hpp"
+#include "../net/gameserver.hpp"
+#include "../net/message.hpp"
+#include "../net/socket.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const char kLocalAddress[] = "unix:/tmp/fanoutbench.sock";
+
+    struct Spectator
+    {
+        Net::Socket socket;
+
+        u8          input[256];
+        std::size_t inputSize = 0;
+
+        u16 ply = 0;    //!< Of the last move received.
+    };
+
+    //! @brief Reads every spectator until stopped, counting the moves received by all of them.
+    class Reader
+    {
+    public:
+
+        explicit Reader(std::vector<Spectator>& spectators) : spectators(spectators)
+        {
+            epoll = epoll_create1(0);
+
+            if(epoll < 0)
+            {
+                throw std::runtime_error("Failed to create epoll");
+            }
+
+            for(Spectator& spectator : spectators)
+            {
+                epoll_event event;
+
+                event.events   = EPOLLIN;
+                event.data.ptr = &spectator;
+
+                epoll_ctl(epoll, EPOLL_CTL_ADD, spectator.socket.GetHandle(), &event);
+            }
+
+            thread = std::thread(&Reader::Run, this);
+        }
+
+        ~Reader()
+        {
+            stopped = true;
+            thread.join();
+            close(epoll);
+        }
+
+        std::atomic<u64> snapshots { 0 };
+        std::atomic<u64> moves     { 0 };
+        std::atomic<u64> bytes     { 0 };
+        std::atomic<u64> errors    { 0 };  //!< Moves out of order and lost connections.
+
+    private:
+
+        std::vector<Spectator>& spectators;
+
+        int               epoll = -1;
+        std::atomic<bool> stopped { false };
+        std::thread       thread;
+
+        void Run()
+        {
+            epoll_event events[256];
+
+            while(!stopped)
+            {
+                const int count = epoll_wait(epoll, events, 256, 10);
+
+                for(int i = 0; i < count; ++i)
+                {
+                    Read(*static_cast<Spectator*>(events[i].data.ptr));
+                }
+            }
+        }
+
+        void Read(Spectator& spectator)
+        {
+            const std::ptrdiff_t received = spectator.socket.Receive(spectator.input + spectator.inputSize, sizeof(spectator.input) - spectator.inputSize);
+
+            if(received <= 0)
+            {
+                if(received < 0)
+                {
+                    ++errors;
+                    epoll_ctl(epoll, EPOLL_CTL_DEL, spectator.socket.GetHandle(), nullptr);
+                }
+
+                return;
+            }
+
+            spectator.inputSize += std::size_t(received);
+            bytes += u64(received);
+
+            std::size_t  offset = 0;
+            Net::Message message;
+
+            while(std::size_t size = Net::Decode(spectator.input + offset, spectator.inputSize - offset, message))
+            {
+                offset += size;
+
+                if(message.type == Net::MessageType::Snapshot)
+                {
+                    spectator.ply = message.ply;
+                    ++snapshots;
+                }
+                else if(message.type == Net::MessageType::Moved)
+                {
+                    if(message.ply != spectator.ply + 1)
+                    {
+                        ++errors;
+                    }
+
+                    spectator.ply = message.ply;
+                    ++moves;
+                }
+            }
+
+            std::memmove(spectator.input, spectator.input + offset, spectator.inputSize - offset);
+            spectator.inputSize -= offset;
+        }
+    };
+
+    void SendMessage(Net::Socket& socket, const Net::Message& message)
+    {
+        u8 buffer[Net::kMaxMessageSize];
+        const std::size_t size = Net::Encode(message, buffer);
+
+        if(socket.Send(buffer, size) != size)
+        {
+            throw std::runtime_error("Failed to send a whole message");
+        }
+    }
+
+    //! @brief Waits for the next message of @p type on a blocking socket, skipping others.
+    Net::Message ReceiveMessage(Net::Socket& socket, Net::MessageType type)
+    {
+        u8          input[Net::kMaxMessageSize];
+        std::size_t size = 0;
+
+        while(true)
+        {
+            const std::ptrdiff_t received = socket.Receive(input + size, 1);
+
+            if(received < 0)
+            {
+                throw std::runtime_error("Connection closed by the server");
+            }
+
+            size += std::size_t(received);
+
+            Net::Message message;
+
+            if(Net::Decode(input, size, message))
+            {
+                if(message.type == Net::MessageType::Rejected)
+                {
+                    throw std::runtime_error("Rejected with reason " + std::to_string(int(message.reason)));
+                }
+
+                if(message.type == type)
+                {
+                    return message;
+                }
+
+                size = 0;
+            }
+        }
+    }
+
+    //! @returns Origin and destination of up to @p count moves of a random legal game, as Move message data.
+    std::vector<u16> MakeGame(int count)
+    {
+        std::mt19937_64 random(7531);
+
+        Engine::BitboardPosition position;
+        position.SetStart();
+
+        std::vector<u16> moves;
+        u64              masks[Engine::kNumSquares];
+
+        while(int(moves.size()) < count && position.GenerateLegal(masks) > 0)
+        {
+            std::vector<u16> legal;
+
+            for(int origin = 0; origin < Engine::kNumSquares; ++origin)
+            {
+                for(u64 bits = masks[origin]; bits; bits &= bits - 1)
+                {
+                    legal.push_back(u16(origin | (Engine::LowestBit(bits) << 6)));
+                }
+            }
+
+            const u16 move = legal[random() % legal.size()];
+
+            position.Apply(move & 63, move >> 6);
+            moves.push_back(move);
+        }
+
+        return moves;
+    }
+
+    //! @brief Lets the process open a file for each end of every spectator connection, as far as allowed.
+    void RaiseFileLimit()
+    {
+        rlimit limit;
+
+        if(getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    template<typename Condition>
+    void WaitFor(Condition condition, const char* what)
+    {
+        const Clock::time_point deadline = Clock::now() + std::chrono::seconds(30);
+
+        while(!condition())
+        {
+            if(Clock::now() > deadline)
+            {
+                throw std::runtime_error(std::string("Timed out waiting for ") + what);
+            }
+
+            std::this_thread::yield();
+        }
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    const int numSpectators = argc > 1 ? std::stoi(argv[1]) : 10000;
+    const int numMoves      = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    RaiseFileLimit();
+
+    std::unique_ptr<Net::GameServer> server;
+    std::string                      address = kLocalAddress;
+
+    if(argc > 3)
+    {
+        address = argv[3];
+    }
+    else
+    {
+        Net::GameServerSettings settings;
+
+        settings.address = address;
+        settings.threads = int(std::max(std::thread::hardware_concurrency(), 1u));
+
+        server.reset(new Net::GameServer(settings));
+        server->Start();
+    }
+
+    Net::Socket players[2] = { Net::Socket::Connect(address), Net::Socket::Connect(address) };
+
+    Net::Message request;
+
+    request.type = Net::MessageType::Create;
+    SendMessage(players[0], request);
+
+    const u32 game = ReceiveMessage(players[0], Net::MessageType::Joined).game;
+
+    request.type = Net::MessageType::Join;
+    request.game = game;
+    SendMessage(players[1], request);
+    ReceiveMessage(players[1], Net::MessageType::Joined);
+
+    std::vector<Spectator> spectators(numSpectators);
+
+    request.type = Net::MessageType::Watch;
+
+    for(Spectator& spectator : spectators)
+    {
+        spectator.socket = Net::Socket::Connect(address);
+        SendMessage(spectator.socket, request);
+        spectator.socket.SetNonBlocking();
+    }
+
+    Reader reader(spectators);
+
+    WaitFor([&] { return reader.snapshots >= u64(numSpectators); }, "the snapshots");
+
+    const std::vector<u16> moves = MakeGame(numMoves);
+
+    std::vector<double> fanOut;
+
+    const u64               startBytes = reader.bytes;
+    const Clock::time_point start      = Clock::now();
+
+    for(std::size_t i = 0; i < moves.size(); ++i)
+    {
+        Net::Socket& player = players[i % 2];
+
+        request.type = Net::MessageType::Move;
+        request.move = moves[i];
+
+        const Clock::time_point sent = Clock::now();
+
+        SendMessage(player, request);
+        ReceiveMessage(player, Net::MessageType::Moved);
+
+        const u64 delivered = u64(numSpectators) * (i + 1);
+
+        WaitFor([&] { return reader.moves >= delivered; }, "the spectators");
+
+        fanOut.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const u64 errors = reader.errors;
+    const u64 bytes  = reader.bytes - startBytes;
+
+    std::sort(fanOut.begin(), fanOut.end());
+
+    const double deliveries = double(numSpectators) * double(moves.size());
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "spectators     " << numSpectators << "\n"
+              << "moves          " << moves.size() << "\n"
+              << "deliveries/s   " << deliveries / seconds << "\n"
+              << "MB/s           " << double(bytes) / seconds / 1e6 << "\n"
+              << "fan-out p50 us " << fanOut[fanOut.size() / 2] << "\n"
+              << "fan-out p99 us " << fanOut[fanOut.size() * 99 / 100] << "\n"
+              << "errors         " << errors << std::endl;
+
+    return errors == 0 ? 0 : 1;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,209 @@
+//! @file
+//! Builds and queries an Engine::GameIndex of the games in an Engine::GameRecordWriter file.
+//!
+//!     gamedb index <games.scgr> <index.scgi> [threads] [megabytes]    index every position of the games
+//!     gamedb find <games.scgr> <index.scgi> <position> [limit=20]     list the games reaching a position
+//!     gamedb bench <games.scgr> <index.scgi> [queries=10000]          time queries of positions from the games
+//!
+//! Positions are given as Engine::FormatPosition() writes them, in quotes as a single argument.
+
+#include "../engine/gameindex.hpp"
+#include "../engine/gamerecord.hpp"
+#include "../engine/notation.hpp"
+#include "../engine/zobrist.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double Milliseconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void Open(const char* gamesFilename, const char* indexFilename, Engine::GameRecordReader& reader, Engine::GameIndex& index)
+    {
+        index.Open(indexFilename);
+
+        if(index.GetGamesSize() != reader.GetSize())
+        {
+            throw std::runtime_error(std::string(indexFilename) + " is not an index of " + gamesFilename + ", rebuild it");
+        }
+    }
+
+    void Index(const char* gamesFilename, const char* indexFilename, int threads, int megabytes)
+    {
+        Engine::GameIndexSettings settings;
+
+        settings.threads         = threads;
+        settings.memoryMegabytes = megabytes;
+
+        const Engine::GameIndexStats stats = Engine::GameIndex::Build(gamesFilename, indexFilename, settings);
+
+        std::cout << stats.games << " games, " << stats.positions << " positions from " << stats.runs << " runs in "
+                  << stats.milliseconds << " ms, " << std::fixed << std::setprecision(0) << stats.GetGamesPerSecond() << " games/s" << std::endl;
+    }
+
+    void Find(const char* gamesFilename, const char* indexFilename, const std::string& text, int limit)
+    {
+        Engine::BitboardPosition position;
+
+        if(!Engine::ParsePosition(text, position))
+        {
+            throw std::runtime_error("Invalid position: " + text);
+        }
+
+        Engine::GameRecordReader reader(gamesFilename);
+        Engine::GameIndex        index;
+
+        Open(gamesFilename, indexFilename, reader, index);
+
+        const Clock::time_point start = Clock::now();
+        const auto              range = index.Find(Engine::Zobrist::Hash(position));
+        const double            time  = Milliseconds(start);
+
+        std::cout << range.second - range.first << " games in " << std::fixed << std::setprecision(3) << time << " ms" << std::endl;
+
+        Engine::GameRecordView game;
+        Engine::GameRecordTag  tag;
+
+        for(auto entry = range.first; entry != range.second && entry - range.first < limit; ++entry)
+        {
+            reader.Seek(entry->GetOffset());
+
+            if(!reader.Next(game))
+            {
+                throw std::runtime_error("Index points past the end of the games");
+            }
+
+            std::cout << "offset " << entry->GetOffset() << " ply " << entry->GetPly() << ' ' << Engine::ResultToString(game.result);
+
+            for(const char* key : { "White", "Black", "Round" })
+            {
+                if(game.FindTag(key, tag))
+                {
+                    std::cout << ' ' << key << " \"" << std::string(tag.value, tag.valueSize) << '"';
+                }
+            }
+
+            std::cout << '\n';
+        }
+    }
+
+    void Bench(const char* gamesFilename, const char* indexFilename, int queries)
+    {
+        Engine::GameRecordReader reader(gamesFilename);
+        Engine::GameRecordReplay replay;
+        Engine::GameRecordView   game;
+        Engine::GameIndex        index;
+
+        Open(gamesFilename, indexFilename, reader, index);
+
+        // positions a random ply into random games, each is certain to be found at least once
+
+        const std::vector<std::size_t> offsets = reader.ReadOffsets();
+
+        std::mt19937_64 random(1);
+        std::vector<u64> keys;
+
+        while(int(keys.size()) < queries && !offsets.empty())
+        {
+            reader.Seek(offsets[random() % offsets.size()]);
+            reader.Next(game);
+
+            if(game.numPlies == 0)
+            {
+                continue;
+            }
+
+            const u64 plies = 1 + random() % game.numPlies;
+
+            replay.Start(game);
+
+            Engine::Move move;
+
+            for(u64 ply = 0; ply < plies; ++ply)
+            {
+                replay.Next(move);
+            }
+
+            keys.push_back(Engine::Zobrist::Hash(replay.GetPosition()));
+        }
+
+        double total   = 0.0;
+        double slowest = 0.0;
+        u64    found   = 0;
+        u64    missing = 0;
+
+        for(u64 key : keys)
+        {
+            const Clock::time_point start = Clock::now();
+
+            const auto range = index.Find(key);
+
+            // every game found is read, to include its page of the games file
+
+            for(auto entry = range.first; entry != range.second; ++entry)
+            {
+                reader.Seek(entry->GetOffset());
+                reader.Next(game);
+            }
+
+            const double time = Milliseconds(start);
+
+            total   += time;
+            slowest  = std::max(slowest, time);
+            found   += u64(range.second - range.first);
+            missing += range.first == range.second;
+        }
+
+        std::cout << index.GetNumEntries() << " entries, " << keys.size() << " queries, " << found << " games found, "
+                  << missing << " missing\n" << std::fixed << std::setprecision(4)
+                  << "mean " << total / double(std::max<std::size_t>(keys.size(), 1)) << " ms, slowest " << slowest << " ms" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    const std::string command = argc > 3 ? argv[1] : "";
+
+    if(command == "index")
+    {
+        const int threads   = argc > 4 ? std::stoi(argv[4]) : std::max(int(std::thread::hardware_concurrency()), 1);
+        const int megabytes = argc > 5 ? std::stoi(argv[5]) : 1024;
+
+        Index(argv[2], argv[3], threads, megabytes);
+    }
+    else if(command == "find" && argc > 4)
+    {
+        Find(argv[2], argv[3], argv[4], argc > 5 ? std::stoi(argv[5]) : 20);
+    }
+    else if(command == "bench")
+    {
+        Bench(argv[2], argv[3], argc > 4 ? std::stoi(argv[4]) : 10000);
+    }
+    else
+    {
+        std::cerr << "usage: gamedb index <games.scgr> <index.scgi> [threads] [megabytes]\n"
+                     "       gamedb find <games.scgr> <index.scgi> <position> [limit=20]\n"
+                     "       gamedb bench <games.scgr> <index.scgi> [queries=10000]" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,169 @@
+//! @file
+//! Works with Engine::GameRecordWriter files, such as the games arena plays.
+//!
+//!     gamerecord text <games.scgr>                write every game as text
+//!     gamerecord stats <games.scgr>               replay every move, reporting the size and speed
+//!     gamerecord random <games.scgr> <games>      write random legal games, for testing
+
+#include "../engine/gamerecord.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    void WriteText(const char* filename)
+    {
+        Engine::GameRecordReader reader(filename);
+        Engine::GameRecordReplay replay;
+        Engine::GameRecordView   game;
+
+        while(reader.Next(game))
+        {
+            Engine::WriteGameText(std::cout, game, replay);
+        }
+    }
+
+    void Stats(const char* filename)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        Engine::GameRecordReader reader(filename);
+        Engine::GameRecordReplay replay;
+        Engine::GameRecordView   game;
+
+        // once through the games alone, then again playing through every move
+
+        Clock::time_point start = Clock::now();
+
+        u64 games      = 0;
+        u64 moveBytes  = 0;
+        u64 results[4] = {};
+
+        while(reader.Next(game))
+        {
+            ++games;
+            ++results[int(game.result) & 3];
+
+            moveBytes += game.movesSize;
+        }
+
+        const double scanSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        reader.Rewind();
+        start = Clock::now();
+
+        u64 plies = 0;
+
+        while(reader.Next(game))
+        {
+            replay.Start(game);
+
+            for(Engine::Move move; replay.Next(move);)
+            {
+                ++plies;
+            }
+        }
+
+        const double replaySeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << "games          " << games << " (+" << results[int(Board::Result::WhiteWins)]
+                  << " -" << results[int(Board::Result::BlackWins)] << " =" << results[int(Board::Result::Draw)]
+                  << " *" << results[int(Board::Result::Undecided)] << ")\n"
+                  << "plies          " << plies << "\n"
+                  << "bytes/move     " << (plies > 0 ? double(moveBytes) / double(plies) : 0.0) << "\n"
+                  << "bytes/game     " << (games > 0 ? double(reader.GetSize()) / double(games) : 0.0) << "\n"
+                  << std::setprecision(0)
+                  << "games/s read   " << double(games) / scanSeconds << "\n"
+                  << "games/s replay " << double(games) / replaySeconds << "\n"
+                  << "moves/s replay " << double(plies) / replaySeconds << std::endl;
+    }
+
+    void WriteRandom(const char* filename, int numGames)
+    {
+        Engine::GameRecordWriter writer(filename);
+        Engine::BitboardPosition position;
+
+        std::mt19937_64 random(1);
+        u64             masks[Engine::kNumSquares];
+
+        for(int i = 0; i < numGames; ++i)
+        {
+            writer.Begin();
+            writer.AddTag("Round", std::to_string(i + 1));
+
+            position.SetStart();
+
+            Board::Result result = Board::Result::Draw;
+
+            for(int ply = 0; ply < 400; ++ply)
+            {
+                const int count = position.GenerateLegal(masks);
+
+                if(count == 0)
+                {
+                    if(position.IsInCheck(position.turn))
+                    {
+                        result = position.turn == u8(Piece::Team::White) ? Board::Result::BlackWins : Board::Result::WhiteWins;
+                    }
+
+                    break;
+                }
+
+                int choice = int(random() % u64(count));
+
+                for(int origin = 0; origin < Engine::kNumSquares && choice >= 0; ++origin)
+                {
+                    for(u64 bits = masks[origin]; bits && choice >= 0; bits &= bits - 1)
+                    {
+                        if(choice-- == 0)
+                        {
+                            const int destination = Engine::LowestBit(bits);
+
+                            writer.AddMove(position.ToMove(origin, destination));
+                            position.Apply(origin, destination);
+                        }
+                    }
+                }
+            }
+
+            writer.End(result);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    const std::string command = argc > 2 ? argv[1] : "";
+
+    if(command == "text")
+    {
+        WriteText(argv[2]);
+    }
+    else if(command == "stats")
+    {
+        Stats(argv[2]);
+    }
+    else if(command == "random" && argc > 3)
+    {
+        WriteRandom(argv[2], std::stoi(argv[3]));
+    }
+    else
+    {
+        std::cerr << "usage: gamerecord text|stats <games.scgr>\n"
+                     "       gamerecord random <games.scgr> <games>" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
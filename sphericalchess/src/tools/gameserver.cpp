@@ -0,0 +1,92 @@
+//! @file
+//! Hosts games for clients speaking the Net::Message protocol until interrupted, printing the number of
+//! connections, games, spectators and moves made each second. Linux only.
+//!
+//!     gameserver [address] [threads] [journal directory]
+//!
+//! The address is "host:port" or "unix:path", ":7531" by default. With a journal directory every move is
+//! on disk before it is sent, and the games in progress when the server last stopped are rebuilt from it.
+
+#include "../net/gameserver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+    volatile std::sig_atomic_t interrupted = 0;
+
+    void Interrupt(int)
+    {
+        interrupted = 1;
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    Net::GameServerSettings settings;
+
+    if(argc > 1) settings.address = argv[1];
+
+    settings.threads = argc > 2 ? std::stoi(argv[2]) : int(std::max(std::thread::hardware_concurrency(), 1u));
+
+    if(argc > 3) settings.journal = argv[3];
+
+    const auto start = std::chrono::steady_clock::now();
+
+    Net::GameServer server(settings);
+
+    if(!settings.journal.empty())
+    {
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "recovered " << server.GetStats().games << " games from " << settings.journal << " in " << milliseconds << " ms" << std::endl;
+    }
+
+    std::signal(SIGINT,  Interrupt);
+    std::signal(SIGTERM, Interrupt);
+
+    server.Start();
+
+    std::cout << "listening on " << settings.address << " with " << settings.threads << " threads" << std::endl;
+
+    u64 lastMoves   = 0;
+    u64 lastCommits = 0;
+
+    while(!interrupted)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        const Net::GameServerStats stats = server.GetStats();
+
+        std::cout << "connections " << stats.connections
+                  << " games "      << stats.games
+                  << " spectators " << stats.spectators
+                  << " moves/s "    << stats.moves - lastMoves
+                  << " rejected "   << stats.rejected;
+
+        if(!settings.journal.empty())
+        {
+            std::cout << " commits/s " << stats.commits - lastCommits;
+        }
+
+        std::cout << std::endl;
+
+        lastMoves   = stats.moves;
+        lastCommits = stats.commits;
+    }
+
+    server.Stop();
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,488 @@
+//! @file
+//! Puts a Net::GameServer under load to size hardware for it. Opens pairs of connections that each create
+//! and join a game, then play random legal moves either as fast as the server answers or at a fixed rate,
+//! starting a new game whenever one ends. Prints the moves made each second, then the round trip of a move
+//! from sending it to the server sending it back, as percentiles. Linux only.
+//!
+//!     loadgen [address] [connections] [seconds] [moves per second per game] [threads]
+//!
+//! The address is that of a running gameserver, ":7531" by default. A rate of 0, the default, makes the
+//! next move as soon as the last one comes back.
+
+#include "../engine/bitboard.hpp"
+#include "../net/message.hpp"
+#include "../net/socket.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    //! Games are left and a new one created after this many plies, so creating and joining is loaded too.
+    constexpr u16 kMaxPlies = 200;
+
+    struct Settings
+    {
+        std::string address     = ":7531";
+        int         connections = 2000;
+        int         seconds     = 10;
+        double      rate        = 0;    //!< Moves per second per game, 0 for as fast as possible.
+        int         threads     = 1;
+    };
+
+    struct Totals
+    {
+        std::atomic<u64> moves  { 0 };
+        std::atomic<u64> games  { 0 };  //!< Started.
+        std::atomic<u64> errors { 0 };  //!< Rejected requests.
+    };
+
+    struct Game;
+
+    struct Player
+    {
+        Net::Socket socket;
+        Game*       game = nullptr;
+        int         team = 0;
+
+        u8          input[256];
+        std::size_t inputSize = 0;
+    };
+
+    struct Game
+    {
+        enum class State
+        {
+            Creating,
+            Joining,
+            Playing,
+        };
+
+        Player players[2];
+        State  state = State::Creating;
+        u32    id    = 0;
+
+        Engine::BitboardPosition position;
+        u64                      masks[Engine::kNumSquares];
+        int                      numMoves = 0;  //!< Legal in the position.
+        u16                      ply      = 0;
+
+        bool              waiting = false;  //!< For the last move sent to come back.
+        Clock::time_point sent;
+        Clock::time_point due;              //!< Of the next move when playing at a fixed rate.
+    };
+
+    //! @brief Plays its share of the games on one thread with an epoll loop over their connections.
+    class Driver
+    {
+    public:
+
+        Driver(const Settings& settings, int numGames, Totals& totals, u64 seed)
+            : settings(settings)
+            , totals(totals)
+            , random(seed)
+        {
+            epoll = epoll_create1(0);
+
+            if(epoll < 0)
+            {
+                throw std::runtime_error("Failed to create epoll");
+            }
+
+            if(settings.rate > 0)
+            {
+                interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / settings.rate));
+            }
+
+            for(int i = 0; i < numGames; ++i)
+            {
+                games.emplace_back(new Game());
+
+                Game& game = *games.back();
+
+                for(int team = 0; team < 2; ++team)
+                {
+                    Player& player = game.players[team];
+
+                    player.socket = Net::Socket::Connect(settings.address);
+                    player.socket.SetNonBlocking();
+                    player.game   = &game;
+                    player.team   = team;
+
+                    epoll_event event;
+
+                    event.events   = EPOLLIN | EPOLLRDHUP;
+                    event.data.ptr = &player;
+
+                    epoll_ctl(epoll, EPOLL_CTL_ADD, player.socket.GetHandle(), &event);
+                }
+            }
+        }
+
+        ~Driver()
+        {
+            close(epoll);
+        }
+
+        //! @brief Runs until @p stopped, the round trips of the moves are in GetLatencies() after.
+        void Run(const std::atomic<bool>& stopped)
+        {
+            for(auto& game : games)
+            {
+                Restart(*game);
+            }
+
+            epoll_event events[256];
+
+            while(!stopped)
+            {
+                const int count = epoll_wait(epoll, events, 256, settings.rate > 0 ? 1 : 10);
+
+                for(int i = 0; i < count; ++i)
+                {
+                    Read(*static_cast<Player*>(events[i].data.ptr));
+                }
+
+                if(settings.rate > 0)
+                {
+                    const Clock::time_point now = Clock::now();
+
+                    for(auto& game : games)
+                    {
+                        if(game->state == Game::State::Playing && !game->waiting && now >= game->due)
+                        {
+                            SendMove(*game);
+                        }
+                    }
+                }
+            }
+        }
+
+        //! @returns Round trips in microseconds, in the order the moves were made.
+        const std::vector<float>& GetLatencies() const { return latencies; }
+
+    private:
+
+        const Settings& settings;
+        Totals&         totals;
+
+        int                                epoll = -1;
+        std::vector<std::unique_ptr<Game>> games;
+        std::mt19937_64                    random;
+        Clock::duration                    interval = Clock::duration::zero();
+        std::vector<float>                 latencies;
+
+        void Read(Player& player)
+        {
+            const std::ptrdiff_t received = player.socket.Receive(player.input + player.inputSize, sizeof(player.input) - player.inputSize);
+
+            if(received < 0)
+            {
+                throw std::runtime_error("Connection closed by the server");
+            }
+
+            player.inputSize += std::size_t(received);
+
+            std::size_t  offset = 0;
+            Net::Message message;
+
+            while(std::size_t size = Net::Decode(player.input + offset, player.inputSize - offset, message))
+            {
+                offset += size;
+                Handle(player, message);
+            }
+
+            std::memmove(player.input, player.input + offset, player.inputSize - offset);
+            player.inputSize -= offset;
+        }
+
+        void Handle(Player& player, const Net::Message& message)
+        {
+            Game& game = *player.game;
+
+            switch(message.type)
+            {
+            case Net::MessageType::Joined:
+                if(game.state == Game::State::Creating && player.team == 0)
+                {
+                    game.id    = message.game;
+                    game.state = Game::State::Joining;
+
+                    Net::Message join;
+
+                    join.type = Net::MessageType::Join;
+                    join.game = game.id;
+
+                    Send(game.players[1], join);
+                }
+                else if(game.state == Game::State::Joining && player.team == 1 && message.game == game.id)
+                {
+                    game.state = Game::State::Playing;
+
+                    // spread over the interval, games started together would otherwise move together
+
+                    game.due = Clock::now() + Clock::duration(Clock::rep(random() % u64(interval.count() + 1)));
+
+                    if(settings.rate <= 0)
+                    {
+                        SendMove(game);
+                    }
+                }
+                break;
+
+            case Net::MessageType::Moved:
+                // both players are sent every move, the one that made it times it, and the other
+                // player's copy can come after the next move is sent
+
+                if(message.game == game.id && game.waiting && player.team == game.position.turn && message.ply == game.ply + 1)
+                {
+                    const Clock::time_point now = Clock::now();
+
+                    latencies.push_back(std::chrono::duration<float, std::micro>(now - game.sent).count());
+                    ++totals.moves;
+
+                    game.waiting = false;
+                    game.position.Apply(message.move & 63, (message.move >> 6) & 63);
+                    game.ply     = message.ply;
+                    game.due     = game.sent + interval;
+
+                    game.numMoves = game.position.GenerateLegal(game.masks);
+
+                    if(message.end != Net::GameEnd::None || game.ply >= kMaxPlies || game.numMoves == 0)
+                    {
+                        Restart(game);
+                    }
+                    else if(settings.rate <= 0)
+                    {
+                        SendMove(game);
+                    }
+                }
+                break;
+
+            case Net::MessageType::Rejected:
+                ++totals.errors;
+
+                if(message.game == game.id)
+                {
+                    Restart(game);
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        //! @brief Leaves the current game if any and creates a new one.
+        void Restart(Game& game)
+        {
+            Net::Message message;
+
+            if(game.id != 0)
+            {
+                message.type = Net::MessageType::Leave;
+                message.game = game.id;
+
+                Send(game.players[0], message);
+                Send(game.players[1], message);
+            }
+
+            game.state   = Game::State::Creating;
+            game.id      = 0;
+            game.ply     = 0;
+            game.waiting = false;
+
+            game.position.SetStart();
+            game.numMoves = game.position.GenerateLegal(game.masks);
+
+            message.type = Net::MessageType::Create;
+            message.game = 0;
+
+            Send(game.players[0], message);
+
+            ++totals.games;
+        }
+
+        void SendMove(Game& game)
+        {
+            int choice = int(random() % u64(game.numMoves));
+
+            for(int origin = 0; origin < Engine::kNumSquares; ++origin)
+            {
+                for(u64 bits = game.masks[origin]; bits; bits &= bits - 1)
+                {
+                    if(choice-- > 0)
+                    {
+                        continue;
+                    }
+
+                    Net::Message move;
+
+                    move.type = Net::MessageType::Move;
+                    move.game = game.id;
+                    move.move = u16(origin | (Engine::LowestBit(bits) << 6));
+
+                    game.waiting = true;
+                    game.sent    = Clock::now();
+
+                    Send(game.players[game.position.turn], move);
+                    return;
+                }
+            }
+        }
+
+        void Send(Player& player, const Net::Message& message)
+        {
+            u8 buffer[Net::kMaxMessageSize];
+            const std::size_t size = Net::Encode(message, buffer);
+
+            // the socket is only full if the server stopped reading, which is worth stopping for
+
+            if(player.socket.Send(buffer, size) != size)
+            {
+                throw std::runtime_error("Server is not reading its connections");
+            }
+        }
+    };
+
+    void RaiseFileLimit()
+    {
+        rlimit limit;
+
+        if(getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    float Percentile(const std::vector<float>& sorted, double fraction)
+    {
+        return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, std::size_t(double(sorted.size()) * fraction))];
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    Settings settings;
+
+    if(argc > 1) settings.address     = argv[1];
+    if(argc > 2) settings.connections = std::stoi(argv[2]);
+    if(argc > 3) settings.seconds     = std::stoi(argv[3]);
+    if(argc > 4) settings.rate        = std::stod(argv[4]);
+
+    settings.threads = argc > 5 ? std::stoi(argv[5]) : int(std::max(std::thread::hardware_concurrency(), 1u));
+
+    RaiseFileLimit();
+
+    const int numGames = std::max(settings.connections / 2, 1);
+
+    Totals totals;
+
+    std::vector<std::unique_ptr<Driver>> drivers;
+
+    for(int i = 0; i < settings.threads; ++i)
+    {
+        const int share = numGames / settings.threads + (i < numGames % settings.threads ? 1 : 0);
+
+        drivers.emplace_back(new Driver(settings, share, totals, u64(i) + 1));
+    }
+
+    std::cout << "playing " << numGames << " games on " << settings.address << " with " << settings.threads << " threads" << std::endl;
+
+    std::atomic<bool>        stopped { false };
+    std::vector<std::thread> threads;
+    std::exception_ptr       failure;
+    std::mutex               failureMutex;
+
+    for(auto& driver : drivers)
+    {
+        threads.emplace_back([&, d = driver.get()]
+        {
+            try
+            {
+                d->Run(stopped);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                failure = std::current_exception();
+                stopped = true;
+            }
+        });
+    }
+
+    const Clock::time_point start = Clock::now();
+
+    u64 lastMoves = 0;
+
+    for(int second = 0; second < settings.seconds && !stopped; ++second)
+    {
+        std::this_thread::sleep_until(start + std::chrono::seconds(second + 1));
+
+        const u64 moves = totals.moves;
+
+        std::cout << "moves/s " << moves - lastMoves << " games " << totals.games << " rejected " << totals.errors << std::endl;
+
+        lastMoves = moves;
+    }
+
+    stopped = true;
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    if(failure)
+    {
+        std::rethrow_exception(failure);
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<float> latencies;
+
+    for(auto& driver : drivers)
+    {
+        latencies.insert(latencies.end(), driver->GetLatencies().begin(), driver->GetLatencies().end());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "connections    " << numGames * 2 << "\n"
+              << "moves          " << latencies.size() << "\n"
+              << "moves/s        " << double(latencies.size()) / seconds << "\n"
+              << "games started  " << totals.games << "\n"
+              << "rejected       " << totals.errors << "\n"
+              << "round trip us  p50 " << Percentile(latencies, 0.5)
+              << " p99 "  << Percentile(latencies, 0.99)
+              << " p999 " << Percentile(latencies, 0.999)
+              << " max "  << (latencies.empty() ? 0.0f : latencies.back()) << std::endl;
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
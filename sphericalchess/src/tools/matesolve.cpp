@@ -0,0 +1,92 @@
+//! @file
+//! Searches Engine::TrainingPosition records for forced mates with Engine::SolveMates, writing a line
+//! per solved position: its index in the file, the number of moves and the mating line.
+//!
+//!     matesolve <positions.bin> <mates.txt> [moves] [nodes] [threads] [hash]
+
+#include "../engine/matesolver.hpp"
+#include "../engine/trainingposition.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) try
+{
+    if(argc < 3)
+    {
+        std::cerr << "usage: matesolve <positions.bin> <mates.txt> [moves] [nodes] [threads] [hash]" << std::endl;
+        return 1;
+    }
+
+    Engine::MateBatchSettings settings;
+
+    settings.maxMoves       = argc > 3 ? std::stoi(argv[3]) : 3;
+    settings.nodes          = argc > 4 ? std::stoull(argv[4]) : 1000000;
+    settings.threads        = argc > 5 ? std::stoi(argv[5]) : std::max(int(std::thread::hardware_concurrency()), 1);
+    settings.tableMegabytes = argc > 6 ? std::stoul(argv[6]) : 64;
+
+    std::ifstream input(argv[1], std::ios::binary);
+
+    if(!input) throw std::runtime_error("Failed to open file: " + std::string(argv[1]));
+
+    std::vector<Engine::BitboardPosition> positions;
+
+    Engine::TrainingPosition record;
+    Board board;
+
+    while(input.read(reinterpret_cast<char*>(&record), sizeof(record)))
+    {
+        record.Unpack(board);
+
+        positions.emplace_back();
+        positions.back().FromBoard(board);
+    }
+
+    u64 reported = 0;
+
+    std::vector<Engine::MateSolution> solutions;
+
+    const auto stats = Engine::SolveMates(positions, settings, solutions, [&](const Engine::MateBatchStats& stats)
+    {
+        if(stats.milliseconds >= reported + 10000)
+        {
+            reported = stats.milliseconds;
+            std::cout << stats.positions << " positions, " << stats.solved << " mates, " << stats.GetPositionsPerMinute() << " positions/min" << std::endl;
+        }
+    });
+
+    std::ofstream output(argv[2]);
+
+    if(!output) throw std::runtime_error("Failed to open file: " + std::string(argv[2]));
+
+    for(std::size_t i = 0; i < solutions.size(); ++i)
+    {
+        if(solutions[i].moves == 0)
+        {
+            continue;
+        }
+
+        output << i << ' ' << solutions[i].moves;
+
+        for(auto& move : solutions[i].line)
+        {
+            output << ' ' << move.ToString();
+        }
+
+        output << '\n';
+    }
+
+    std::cout << stats.positions << " positions, " << stats.solved << " mates, " << stats.nodes << " nodes, "
+              << stats.GetPositionsPerMinute() << " positions/min" << std::endl;
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,107 @@
+//! @file
+//! Measures Engine::Mcts playouts per second from the starting position for 1, 2, 4 ... threads,
+//! then plays a few moves to show how much of the tree is kept between searches.
+//!
+//!     mctsbench [milliseconds] [max threads] [playout|evaluate] [uct|puct] [max nodes]
+
+#include "../engine/mcts.hpp"
+#include "../engine/movegen.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char* argv[]) try
+{
+    const int milliseconds = argc > 1 ? std::stoi(argv[1]) : 2000;
+    const int maxThreads   = argc > 2 ? std::stoi(argv[2]) : 16;
+
+    Engine::MctsSettings settings;
+
+    if(argc > 3)
+    {
+        const std::string leaf = argv[3];
+
+        if     (leaf == "playout")  settings.leaf = Engine::MctsSettings::Leaf::Playout;
+        else if(leaf == "evaluate") settings.leaf = Engine::MctsSettings::Leaf::Evaluate;
+        else throw std::runtime_error("Unknown leaf: " + leaf);
+    }
+
+    if(argc > 4)
+    {
+        const std::string selection = argv[4];
+
+        if     (selection == "uct")  settings.selection = Engine::MctsSettings::Selection::Uct;
+        else if(selection == "puct") settings.selection = Engine::MctsSettings::Selection::Puct;
+        else throw std::runtime_error("Unknown selection: " + selection);
+    }
+
+    if(argc > 5)
+    {
+        settings.maxNodes = u32(std::stoul(argv[5]));
+    }
+
+    Engine::Mcts mcts(settings);
+
+    Engine::MctsLimits limits;
+    limits.milliseconds = milliseconds;
+
+    u64 single = 0;
+
+    for(int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        limits.threads = threads;
+
+        mcts.Clear();
+
+        const Engine::MctsInfo info = mcts.Run(Board(), limits);
+
+        if(threads == 1)
+        {
+            single = std::max<u64>(info.PlayoutsPerSecond(), 1);
+        }
+
+        std::cout << std::setw(2) << threads << " threads: " << std::setw(9) << info.PlayoutsPerSecond() << " playouts/s, "
+                  << std::fixed << std::setprecision(2) << double(info.PlayoutsPerSecond()) / single << "x, "
+                  << info.nodes << " nodes, best " << info.moves.front().ToString() << " value " << info.value << std::endl;
+    }
+
+    // tree reuse, each search starts from the position after its best move and the expected reply
+
+    Board board;
+    limits.threads = 1;
+
+    mcts.Clear();
+
+    for(int i = 0; i < 4; ++i)
+    {
+        const Engine::MctsInfo info = mcts.Run(board, limits);
+
+        std::cout << "ply " << 2 * i << ": reused " << info.reusedNodes << " of " << info.nodes << " nodes, line";
+
+        for(std::size_t j = 0; j < info.moves.size() && j < 6; ++j)
+        {
+            std::cout << ' ' << info.moves[j].ToString();
+        }
+
+        std::cout << std::endl;
+
+        Piece::ActionCollection actions;
+
+        for(std::size_t j = 0; j < 2 && j < info.moves.size(); ++j)
+        {
+            actions.clear();
+            Engine::GenerateLegalActions(board, actions);
+
+            board.DoAction(*Engine::Move::FindAction(info.moves[j], actions));
+        }
+    }
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
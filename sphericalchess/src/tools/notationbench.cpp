@@ -0,0 +1,170 @@
+//! @file
+//! Measures how fast positions and moves are written and read back as text with Engine::FormatPosition,
+//! Engine::ParsePosition, Engine::FormatMove and Engine::ParseMove, over the positions of a game record
+//! file, checking every one reads back as it was written.
+//!
+//!     notationbench <games.scgr> [positions=200000] [passes=5]
+
+#include "../engine/gamerecord.hpp"
+#include "../engine/notation.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    //! @brief Calls @p function @p passes times.
+    //! @returns Seconds per pass.
+    template<typename Function>
+    double Time(int passes, Function function)
+    {
+        const Clock::time_point start = Clock::now();
+
+        for(int pass = 0; pass < passes; ++pass)
+        {
+            function();
+        }
+
+        return std::chrono::duration<double>(Clock::now() - start).count() / passes;
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    if(argc < 2)
+    {
+        std::cerr << "usage: notationbench <games.scgr> [positions=200000] [passes=5]" << std::endl;
+        return 1;
+    }
+
+    const std::size_t limit  = argc > 2 ? std::stoul(argv[2]) : 200000;
+    const int         passes = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    // every position of the games before each move, up to the limit
+
+    std::vector<Engine::BitboardPosition> positions;
+    std::vector<Engine::Move>             moves;
+
+    Engine::GameRecordReader reader(argv[1]);
+    Engine::GameRecordReplay replay;
+    Engine::GameRecordView   game;
+
+    while(positions.size() < limit && reader.Next(game))
+    {
+        replay.Start(game);
+
+        Engine::BitboardPosition before = replay.GetPosition();
+
+        for(Engine::Move move; positions.size() < limit && replay.Next(move);)
+        {
+            positions.push_back(before);
+            moves.push_back(move);
+
+            before = replay.GetPosition();
+        }
+    }
+
+    const std::size_t count = positions.size();
+
+    if(count == 0)
+    {
+        throw std::runtime_error("No moves in " + std::string(argv[1]));
+    }
+
+    std::vector<u64> masks(count * Engine::kNumSquares);
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        positions[i].GenerateLegal(&masks[i * Engine::kNumSquares]);
+    }
+
+    // written to fixed size slots, so nothing is allocated while timing
+
+    std::vector<char>        positionText(count * Engine::kMaxPositionTextSize);
+    std::vector<std::size_t> positionSizes(count);
+    std::vector<char>        moveText(count * Engine::kMaxMoveTextSize);
+    std::vector<std::size_t> moveSizes(count);
+
+    std::vector<Engine::BitboardPosition> parsedPositions(count);
+    std::vector<Engine::Move>             parsedMoves(count);
+
+    std::size_t failedPositions = 0;
+    std::size_t failedMoves     = 0;
+
+    const double formatPositions = Time(passes, [&]
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            positionSizes[i] = Engine::FormatPosition(positions[i], &positionText[i * Engine::kMaxPositionTextSize]);
+        }
+    });
+
+    const double parsePositions = Time(passes, [&]
+    {
+        failedPositions = 0;
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            failedPositions += !Engine::ParsePosition(&positionText[i * Engine::kMaxPositionTextSize], positionSizes[i], parsedPositions[i]);
+        }
+    });
+
+    const double formatMoves = Time(passes, [&]
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            moveSizes[i] = Engine::FormatMove(positions[i], &masks[i * Engine::kNumSquares], moves[i], &moveText[i * Engine::kMaxMoveTextSize]);
+        }
+    });
+
+    const double parseMoves = Time(passes, [&]
+    {
+        failedMoves = 0;
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            failedMoves += !Engine::ParseMove(positions[i], &masks[i * Engine::kNumSquares], &moveText[i * Engine::kMaxMoveTextSize], moveSizes[i], parsedMoves[i]);
+        }
+    });
+
+    const std::size_t failed = failedPositions + failedMoves;
+
+    std::size_t mismatched = 0;
+    std::size_t textSize   = 0;
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        if(parsedPositions[i] != positions[i] || parsedMoves[i] != moves[i])
+        {
+            if(mismatched++ == 0)
+            {
+                std::cerr << "first mismatch: " << &positionText[i * Engine::kMaxPositionTextSize]
+                          << " " << &moveText[i * Engine::kMaxMoveTextSize] << " (" << moves[i].ToString() << ")" << std::endl;
+            }
+        }
+
+        textSize += positionSizes[i];
+    }
+
+    std::cout << std::fixed << std::setprecision(0)
+              << "positions        " << count << ", " << double(textSize) / double(count) << " characters each\n"
+              << "format positions " << double(count) / formatPositions << "/s\n"
+              << "parse positions  " << double(count) / parsePositions << "/s, "
+              << double(textSize) / parsePositions / 1e6 << " MB/s\n"
+              << "format moves     " << double(count) / formatMoves << "/s\n"
+              << "parse moves      " << double(count) / parseMoves << "/s\n"
+              << "failed           " << failed << ", mismatched " << mismatched << std::endl;
+
+    return failed == 0 && mismatched == 0 ? 0 : 1;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
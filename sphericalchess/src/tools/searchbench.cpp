@@ -0,0 +1,136 @@
+//! @file
+//! Measures the depth Engine::Search reaches in a fixed time on a fixed suite of positions, with all of
+//! SearchSelectivity, none of it, and each part turned off in turn.
+//!
+//!     searchbench [milliseconds per position] [threads]
+
+#include "../engine/movegen.hpp"
+#include "../engine/search.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    //! Openings followed by shallow searches, from the start of the middle game into it.
+    const char* const kSuite[] =
+    {
+        "b2b4 c7c6 c1f6 a7a6 f6d4 g8a7 b1a3 e7e5",
+        "a2a4 c7c6 g1a2 g8f6 b1a3 b8a6 a2g3 f8f4 f1f5 a6h4 f5d3 a7a5",
+        "b2b4 b8c6 c1g5 e7e5 g5d8 e8d8 b4b5 c6b4 c2c3 b4d5 c3c4 d5f4 d1f7 g8f6 f7a4 h7h5",
+        "g2g3 a7a6 f1a4 h7h5 a4b3 b8c6 b1a3 c6a5 g1f3 g8f6 c2c4 a5b3 d1b3 f8h6 c4c5 b7b6 b3c4 b6c5 c4c5 d7d6",
+        "c2c3 d7d6 e2e3 c7c5 f1b5 b8c6 b1a3 g8h6 b5h3 a7a5 g1f3 a5a4 h3c8 a8c8 d2d4 b7b5 d4d5 b5b4 a3c2 b4c3 d5c6 c3b2 c1b2 d8a5",
+        "f2f4 b8c6 b1a3 g8f6 g1f3 d7d5 c1c5 e7e5 c5e3 d5d4 f4e5 d4e3 e5f6 d8f6 d1c1 f6b6 h2h4 f8b4 c2c3 b4d6 g2g3 a7a5 d2e3 d6e3 h4a5 a8a5 h1h8 b6h8",
+        "g2g3 b7b6 e2e4 b8a6 b1a3 a6g5 g1e2 c8f3 f1g2 f3g2 a3g2 g5e4 f2f3 e4c5 b2b4 c5a4 h2h3 a4h6 c1d4 g8f6 e2f4 c7c5 b4c5 b6c5 d4c5 f8f4 g2f4 d8g3 c5f2 g3f4 f2h8 a8h8",
+        "c2c4 d7d5 g2g4 c8d7 f1d7 d8d7 c4d5 g8f6 b1a3 b8a6 g1f3 d7d5 d1a4 c7c6 b2b4 f8d6 e1g1h b7b5 a4a5 a6b4 a5d5 f6d5 e2e4 d5f4 e4e5 d6c5 d2d4 c5d4 c1f4 d4a1 f1a1 a7a5 g4g5 a5a4 a3g4 c6c5",
+    };
+
+    Board MakePosition(const std::string& line)
+    {
+        Board board;
+
+        std::istringstream stream(line);
+        std::string token;
+
+        while(stream >> token)
+        {
+            Engine::Move move;
+            Piece::ActionCollection actions;
+
+            Engine::GenerateLegalActions(board, actions);
+
+            const Piece::Action* action = Engine::Move::Parse(token, move) ? Engine::Move::FindAction(move, actions) : nullptr;
+
+            if(!action) throw std::runtime_error("Illegal move in bench suite: " + token);
+
+            board.DoAction(*action);
+        }
+
+        return board;
+    }
+
+    void Run(const std::string& name, const Engine::SearchLimits& limits)
+    {
+        Engine::TranspositionTable table(16);
+        Engine::Search search(table);
+
+        int depths = 0;
+        u64 nodes  = 0;
+        u64 milliseconds = 0;
+
+        for(const char* line : kSuite)
+        {
+            const Board board = MakePosition(line);
+
+            table.Clear();
+
+            const Engine::SearchInfo info = search.Run(board, limits);
+
+            depths       += info.depth;
+            nodes        += info.nodes;
+            milliseconds += u64(info.milliseconds);
+        }
+
+        const double count = double(sizeof(kSuite) / sizeof(kSuite[0]));
+
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(7) << depths / count << " depth "
+                  << std::setw(10) << nodes * 1000 / std::max<u64>(milliseconds, 1) << " nodes/s" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    Engine::SearchLimits limits;
+
+    limits.milliseconds = argc > 1 ? std::stoi(argv[1]) : 2000;
+    limits.threads      = argc > 2 ? std::stoi(argv[2]) : 1;
+
+    Engine::SearchSelectivity none;
+
+    none.nullMove           = false;
+    none.lateMoveReductions = false;
+    none.reverseFutility    = false;
+    none.futility           = false;
+    none.checkExtensions    = false;
+
+    const Engine::SearchSelectivity all;
+
+    struct
+    {
+        const char* name;
+        bool Engine::SearchSelectivity::* feature;
+    }
+    const features[] =
+    {
+        { "no null move",   &Engine::SearchSelectivity::nullMove           },
+        { "no lmr",         &Engine::SearchSelectivity::lateMoveReductions },
+        { "no rfp",         &Engine::SearchSelectivity::reverseFutility    },
+        { "no futility",    &Engine::SearchSelectivity::futility           },
+        { "no check ext",   &Engine::SearchSelectivity::checkExtensions    },
+    };
+
+    limits.selectivity = none;
+    Run("none", limits);
+
+    limits.selectivity = all;
+    Run("all", limits);
+
+    for(auto& feature : features)
+    {
+        limits.selectivity = all;
+        limits.selectivity.*feature.feature = false;
+
+        Run(feature.name, limits);
+    }
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
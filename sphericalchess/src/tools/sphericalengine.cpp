@@ -0,0 +1,25 @@
+//! @file
+//! Runs the engine without a window, reading Engine::Protocol commands from standard input and writing
+//! the replies to standard output, for GUIs, tournament managers and scripts.
+//!
+//!     sphericalengine
+
+#include "../engine/protocol.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+int main() try
+{
+    std::ios::sync_with_stdio(false);
+
+    Engine::Protocol protocol(std::cin, std::cout);
+    protocol.Run();
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
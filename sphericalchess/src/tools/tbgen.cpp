@@ -0,0 +1,69 @@
+//! @file
+//! Generates every Engine::Tablebases table into a directory, three piece tables first
+//! as the four piece tables need them for captures. Existing tables are kept.
+//!
+//!     tbgen <directory> [threads]
+
+#include "../engine/tablebase.hpp"
+#include "../engine/tablebasegenerator.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char* argv[]) try
+{
+    if(argc < 2)
+    {
+        std::cerr << "usage: tbgen <directory> [threads]" << std::endl;
+        return 1;
+    }
+
+    const std::string directory = argv[1];
+    const int threads = argc > 2 ? std::stoi(argv[2]) : int(std::thread::hardware_concurrency());
+
+    Engine::Tablebases tablebases;
+
+    int numPieces = Engine::Tablebases::kMinPieces;
+
+    for(auto& pieces : Engine::Tablebases::AllTables())
+    {
+        const std::string name     = Engine::Tablebases::TableName(pieces);
+        const std::string filename = directory + "/" + name + ".sctb";
+
+        if(std::ifstream(filename))
+        {
+            std::cout << name << ": exists" << std::endl;
+            continue;
+        }
+
+        // reopen so the tables just written are used for captures
+
+        if(int(pieces.size()) + 2 != numPieces)
+        {
+            numPieces = int(pieces.size()) + 2;
+            tablebases.Open(directory);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        Engine::TablebaseGenerator generator(pieces, tablebases, threads);
+
+        generator.Generate();
+        generator.Write(filename.c_str());
+
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << name << ": " << generator.GetNumWins() << " wins, longest mate " << generator.GetMaxDistance()
+                  << " plies, " << seconds << " s" << std::endl;
+    }
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,197 @@
+//! @file
+//! Measures an Engine::VariationTree holding the games of a game record file as variations of one another,
+//! annotated with glyphs and comments: its size, how fast moves are added, stepped through and jumped to,
+//! checking every position jumped to matches the game it came from.
+//!
+//!     treebench <games.scgr> [games=10000] [jumps=100000]
+
+#include "../engine/gamerecord.hpp"
+#include "../engine/variationtree.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double Seconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    if(argc < 2)
+    {
+        std::cerr << "usage: treebench <games.scgr> [games=10000] [jumps=100000]" << std::endl;
+        return 1;
+    }
+
+    const std::size_t limit = argc > 2 ? std::stoul(argv[2]) : 10000;
+    const std::size_t jumps = argc > 3 ? std::stoul(argv[3]) : 100000;
+
+    // the moves of every game up front, so only the tree is timed
+
+    std::vector<std::vector<Engine::Move>> games;
+
+    Engine::GameRecordReader reader(argv[1]);
+    Engine::GameRecordReplay replay;
+    Engine::GameRecordView   game;
+
+    while(games.size() < limit && reader.Next(game))
+    {
+        games.emplace_back();
+        replay.Start(game);
+
+        for(Engine::Move move; replay.Next(move);)
+        {
+            games.back().push_back(move);
+        }
+    }
+
+    if(games.empty())
+    {
+        throw std::runtime_error("No games in " + std::string(argv[1]));
+    }
+
+    // every game is a variation from the root, one in eight moves gets a glyph and one in thirty two a comment
+
+    std::mt19937_64       random(1);
+    Engine::VariationTree tree;
+
+    std::size_t moves = 0;
+
+    Clock::time_point start = Clock::now();
+
+    for(const auto& line : games)
+    {
+        tree.Jump(Engine::VariationTree::kRoot);
+
+        for(Engine::Move move : line)
+        {
+            const u32 node = tree.AddMove(move);
+            const u64 roll = random();
+
+            if(roll % 8 == 0)
+            {
+                tree.SetGlyph(node, Engine::VariationTree::Glyph(1 + (roll >> 8) % (Engine::VariationTree::Glyph_count - 1)));
+            }
+
+            if(roll % 32 == 1)
+            {
+                tree.SetComment(node, "Better was " + move.ToString() + " with the idea of opening the column.");
+            }
+        }
+
+        moves += line.size();
+    }
+
+    const double build = Seconds(start);
+
+    // every node visited depth first, stepping forward into each child and back out of it
+
+    std::size_t steps = 0;
+
+    tree.Jump(Engine::VariationTree::kRoot);
+    start = Clock::now();
+
+    for(u32 node = tree.GetNode(Engine::VariationTree::kRoot).child; node != Engine::VariationTree::kNone;)
+    {
+        tree.Forward(tree.GetNode(node).GetMove());
+        ++steps;
+
+        if(tree.GetNode(node).child != Engine::VariationTree::kNone)
+        {
+            node = tree.GetNode(node).child;
+            continue;
+        }
+
+        // back up to the first node with a sibling left to visit
+
+        while(node != Engine::VariationTree::kRoot && tree.GetNode(node).sibling == Engine::VariationTree::kNone)
+        {
+            tree.Back();
+            ++steps;
+
+            node = tree.GetNode(node).parent;
+        }
+
+        if(node == Engine::VariationTree::kRoot)
+        {
+            break;
+        }
+
+        tree.Back();
+        ++steps;
+
+        node = tree.GetNode(node).sibling;
+    }
+
+    const double walk = Seconds(start);
+
+    // random plies of random games, checked against the positions of the game records
+
+    std::vector<std::pair<u32, Engine::BitboardPosition>> targets;
+
+    while(targets.size() < jumps)
+    {
+        const auto& line = games[random() % games.size()];
+
+        if(line.empty())
+        {
+            continue;
+        }
+
+        const std::size_t plies = 1 + random() % line.size();
+
+        tree.Jump(Engine::VariationTree::kRoot);
+
+        Engine::BitboardPosition position;
+        position.SetStart();
+
+        for(std::size_t ply = 0; ply < plies; ++ply)
+        {
+            tree.Forward(line[ply]);
+            position.Apply(line[ply].GetData() & 63, (line[ply].GetData() >> 6) & 63);
+        }
+
+        targets.emplace_back(tree.GetCurrent(), position);
+    }
+
+    std::size_t mismatched = 0;
+
+    start = Clock::now();
+
+    for(const auto& target : targets)
+    {
+        tree.Jump(target.first);
+        mismatched += tree.GetPosition() != target.second;
+    }
+
+    const double jump = Seconds(start);
+
+    const std::size_t bytes = tree.GetMemoryUsage();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "games      " << games.size() << ", " << moves << " moves\n"
+              << "nodes      " << tree.GetNumNodes() << ", " << double(bytes) / double(1 << 20) << " MB, "
+              << double(bytes) / double(tree.GetNumNodes()) << " bytes each\n"
+              << "add        " << build * 1e9 / double(moves) << " ns per move\n"
+              << "step       " << walk * 1e9 / double(steps) << " ns per step, " << steps << " steps\n"
+              << "jump       " << jump * 1e9 / double(targets.size()) << " ns per jump, " << mismatched << " mismatched" << std::endl;
+
+    return mismatched == 0 ? 0 : 1;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,70 @@
+//! @file
+//! Tunes the evaluation weights with Engine::Tuner and writes a new evaluationparameters.hpp.
+//!
+//! The positions are a file of Engine::TrainingPosition records, such as the output of datagen.
+//!
+//!     tune <positions.bin> <evaluationparameters.hpp> [epochs] [learning rate] [threads] [max positions]
+
+#include "../engine/tuner.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char* argv[]) try
+{
+    if(argc < 3)
+    {
+        std::cerr << "usage: tune <positions.bin> <evaluationparameters.hpp> [epochs] [learning rate] [threads] [max positions]" << std::endl;
+        return 1;
+    }
+
+    const int    epochs       = argc > 3 ? std::stoi(argv[3]) : 200;
+    const double learningRate = argc > 4 ? std::stod(argv[4]) : 1.0;
+    const int    threads      = argc > 5 ? std::stoi(argv[5]) : int(std::thread::hardware_concurrency());
+    const u64    maxPositions = argc > 6 ? std::stoull(argv[6]) : 0;
+
+    using Clock = std::chrono::steady_clock;
+
+    auto Seconds = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    Engine::Tuner tuner(threads);
+
+    auto start = Clock::now();
+
+    const u64 count = tuner.Load(argv[1], maxPositions);
+
+    std::cout << count << " positions resolved in " << Seconds(start) << " s" << std::endl;
+
+    start = Clock::now();
+
+    const double scale = tuner.FitScale();
+
+    std::cout << "scale " << scale << " error " << tuner.CalculateError() << " (" << Seconds(start) << " s)" << std::endl;
+
+    for(int epoch = 1; epoch <= epochs; ++epoch)
+    {
+        start = Clock::now();
+
+        const double error   = tuner.Epoch(learningRate);
+        const double seconds = Seconds(start);
+
+        std::cout << "epoch " << epoch << " error " << error << " time " << seconds * 1000.0 << " ms ("
+                  << (seconds > 0.0 ? count / seconds : 0.0) << " positions/s)" << std::endl;
+    }
+
+    tuner.WriteHeader(argv[2]);
+
+    std::cout << "final error " << tuner.CalculateError() << std::endl;
+
+    return 0;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}